@@ -0,0 +1,176 @@
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "alerts/config.h"
+#include "alerts/dns_cache.h"
+#include "alerts/engine.h"
+#include "alerts/http_client.h"
+#include "alerts/leader.h"
+#include "alerts/monitor.h"
+#include "alerts/multicast.h"
+#include "alerts/queued_notifier.h"
+#include "alerts/seat.h"
+#include "alerts/shutdown.h"
+#include "alerts/watchdog.h"
+
+/**
+* @brief The entry point of the headless monitor, for machines without a desktop.
+* It reads the same configuration file as alert_system, plays the alert sounds and writes one line per
+* transition to stdout instead of showing dialogs. It only depends on the engine, libcurl and mpg123.
+* SIGTERM and SIGINT shut it down cleanly (see GracefulShutdown); SIGHUP restarts it with a fresh configuration.
+* A Watchdog reports stale data on stdout and aborts the process if its event loop hangs.
+* With "multicast" set, it either broadcasts the transitions it detects to the LAN, or listens to another
+* instance's broadcast instead of polling the data source ("multicast_role": "listen"), or does either as the
+* instances elect ("multicast_role": "elect"), another instance taking over when the leader dies.
+* With "seat_socket" set, typically as a system service on a shared terminal, it also feeds the alert_system agent of
+* every logged-in session through that socket, so one fetch notifies all the seats.
+* @param argc An integer argument count of the command line arguments.
+* @param argv An argument vector of the command line arguments: the configuration file path, and
+* optionally "--once" to check the data source a single time and exit (0 if the response was decoded).
+* @return An integer value indicating the exit status of the program (0 for success, non-zero for failure).
+*/
+int main(int argc, char** argv) {
+    if (argc < 2 || (argc == 3 && std::string(argv[2]) != "--once") || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <config_file_path> [--once]\n";
+        return 1;
+    }
+    bool once = argc == 3;
+    alerts::EventLoop loop;
+    alerts::GracefulShutdown shutdown(loop); // before any thread is started
+    alerts::Config config;
+    std::string error;
+    if (!alerts::load_config(argv[1], config, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    auto sounds = std::make_shared<alerts::SoundNotifier>(config.alert_on, config.alert_off);
+    alerts::Engine engine;
+    engine.watch(config.region);
+    // Starting a player takes a process spawn; a notifier thread does it so the engine is not held up.
+    engine.add_notifier(std::make_shared<alerts::QueuedNotifier>(sounds));
+    engine.add_notifier(std::make_shared<alerts::LogNotifier>(std::cout));
+    if (!config.state_file.empty() && !engine.load_state(config.state_file, error)) {
+        std::cerr << error << "\n";
+    }
+
+    if (config.max_requests_per_minute > 0) {
+        alerts::RateLimiter::process().set_rate(config.max_requests_per_minute / 60.0, 1);
+    }
+    alerts::HttpFeedSource source(config.data_url);
+    if (once) {
+        return engine.poll(source) ? 0 : 1;
+    }
+    // On a LAN one instance polls and broadcasts; the others listen and only check that it is alive.
+    alerts::MulticastOptions lan;
+    lan.key = config.multicast_key;
+    if (!config.multicast.empty() && !alerts::parse_multicast_address(config.multicast, lan, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::unique_ptr<alerts::MulticastPublisher> publisher;
+    std::unique_ptr<alerts::MulticastListener> listener;
+    std::unique_ptr<alerts::LeaderElection> election;
+    if (!config.multicast.empty() && config.multicast_role != "publish") {
+        listener.reset(new alerts::MulticastListener(loop, engine, lan));
+        if (!listener->start(error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    if (!config.multicast.empty() && config.multicast_role != "listen") {
+        publisher.reset(new alerts::MulticastPublisher(lan));
+        if (!publisher->open(error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    if (!config.multicast.empty() && config.multicast_role == "elect") {
+        if (config.leader_lease.empty()) {
+            election.reset(new alerts::HeartbeatElection(loop, *publisher));
+        } else {
+            election.reset(new alerts::FileLease(loop, config.leader_lease));
+        }
+    }
+    std::unique_ptr<alerts::SeatServer> seats;
+    if (!config.seat_socket.empty()) {
+        seats.reset(new alerts::SeatServer(loop, engine, config.seat_socket));
+        if (!seats->start(error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    std::thread sound_loader([sounds] { sounds->preload(); });
+    alerts::Monitor monitor(loop, engine, source, std::chrono::seconds(config.update_interval));
+    monitor.align_to_upstream(std::chrono::seconds(config.upstream_period ? config.upstream_period
+                                                                          : config.update_interval));
+    alerts::Watchdog watchdog(loop, std::chrono::seconds(config.watchdog_timeout),
+                              std::chrono::seconds(config.stale_after));
+    watchdog.set_stale_callback([&engine](bool stale, alerts::Watchdog::Clock::duration age) {
+        engine.report_stale(stale, std::chrono::duration_cast<std::chrono::seconds>(age));
+    });
+    if (listener) {
+        listener->set_packet_callback([&](const alerts::Packet& packet) {
+            if (packet.type == alerts::PacketType::Heartbeat) {
+                watchdog.data_received();
+            }
+            if (election) {
+                election->receive(packet);
+            }
+            if (seats && packet.type != alerts::PacketType::Leader) {
+                alerts::Packet relayed = packet; // the sessions take the LAN's transitions too
+                seats->send(relayed);
+            }
+        });
+    }
+    if (election) {
+        election->set_callback([&](bool leader) {
+            if (leader) {
+                std::cout << "Elected to poll the data source" << std::endl;
+                publisher->publish_state(engine); // for listeners that lost packets while nobody led
+                monitor.start();
+            } else {
+                std::cout << "Another instance polls the data source" << std::endl;
+                monitor.stop();
+            }
+        });
+    }
+    monitor.set_poll_callback([&](bool decoded) {
+        if (decoded) {
+            watchdog.data_received();
+            if (publisher) {
+                publisher->publish(engine, std::time(nullptr));
+            }
+            if (seats) {
+                seats->publish(engine, std::time(nullptr));
+            }
+            if (!config.snapshot_file.empty() && !engine.save_binary_snapshot(config.snapshot_file, error)) {
+                std::cerr << error << "\n";
+            }
+        }
+    });
+    shutdown.attach(monitor, engine, config.state_file, std::chrono::seconds(config.drain_timeout), &watchdog);
+    watchdog.start();
+    if (election && !election->start(error)) {
+        std::cerr << error << ", polling instead\n";
+        election.reset();
+        monitor.start();
+    } else if (!listener) {
+        monitor.start();
+    }
+    loop.run();
+    if (election) {
+        election->set_callback(nullptr); // the monitor goes first
+    }
+    sound_loader.join();
+    std::cerr << "HTTP: " << alerts::HttpClient::shared().stats().summary() << "\n"
+              << "DNS: " << alerts::DnsCache::shared().stats().summary() << std::endl;
+    if (shutdown.restart_requested()) {
+        alerts::GracefulShutdown::reexec(argv);
+        return 1;
+    }
+    return 0;
+}
@@ -1,153 +1,194 @@
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <future>
 #include <iostream>
-#include <fstream>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <chrono>
-#include <curl/curl.h>
-#include <json/json.h>
+#include <vector>
 #include <gtkmm.h>
-#include <gstreamermm.h>
-
-std::string region;
-std::string alert_on;
-std::string alert_off;
-std::string data_url;
-int update_interval;
-
-// alert_active - set true if warning activate
-bool alert_active = false;
+#include "alerts/ack_tracker.h"
+#include "alerts/config.h"
+#include "alerts/dbus_notifier.h"
+#include "alerts/dns_cache.h"
+#include "alerts/engine.h"
+#include "alerts/http_client.h"
+#include "alerts/monitor.h"
+#include "alerts/leader.h"
+#include "alerts/multicast.h"
+#include "alerts/queued_notifier.h"
+#include "alerts/seat.h"
+#include "alerts/shutdown.h"
+#include "alerts/startup_profile.h"
+#include "alerts/watchdog.h"
 
 /**
- * @brief WriteCallback function to handle writing data from a callback function.
- * @param contents void pointer to the data contents
- * @param size size of each element to be written
- * @param nmemb number of elements to be written
- * @param userp void pointer to user data
- * @return the total size of the data written
+ * @brief Shows a GTK message dialog for every transition of the monitored region.
+ * GTK runs on the main thread with a single application for the lifetime of the process, while the event loop
+ * runs on a worker. It is initialised in parallel with the first fetch, and dialogs requested before it is ready
+ * are queued. The OK button of a raised alert's dialog acknowledges the alert. Stale data, and its return, get
+ * dialogs of their own.
  */
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
+class DialogNotifier : public alerts::Notifier {
+public:
+    explicit DialogNotifier(alerts::StartupProfile& profile) : profile_(profile), finished_(done_.get_future()) {}
 
-/**
- * @brief Fetches JSON data from a given URL using libcurl library and returns it as a JSON object.
- * @param data_url The URL to fetch JSON data from.
- * @return A JSON object containing the fetched data. If the function fails to fetch data, an empty JSON object is returned.
- * @note This function requires the libcurl library to be installed.
- * @note The returned JSON object must be deallocated manually.
- * @note This function throws an exception if there is an error parsing the fetched JSON data.
- */
-Json::Value fetch_data(const std::string& data_url) {
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
-
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if(curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, data_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
-    }
-    curl_global_cleanup();
-
-    if (readBuffer.empty()) {
-        std::cerr << "Failed to fetch data from " << data_url << std::endl;
-        return Json::Value();
-    }
-
-    Json::Value jsonData;
-    std::istringstream readStream(readBuffer);
-    readStream >> jsonData;
-    return jsonData;
-}
+    /**
+     * @brief Called on the GTK thread when the OK button of a raised alert's dialog is pressed, with the
+     * transition that raised it. Set before run().
+     */
+    void set_ack_callback(std::function<void(const alerts::Transition&)> callback) { on_ack_ = std::move(callback); }
 
-/**
- * @brief Plays an alert sound from a given sound file path using the 'mpg123' command-line tool.
- * This function executes a system command to play the sound file in the background
- * and returns immediately, without waiting for the playback to complete.
- * @param sound_file The path of the sound file to be played.
- * @return None.
- * @throw None.
- *
- * @note This function requires the 'mpg123' command-line tool to be installed on the system.
- */
-void play_alert_sound(const std::string& sound_file) {
-    std::string cmd = "mpg123 -q " + sound_file + " &";
-    std::system(cmd.c_str());
-}
+    /**
+     * @brief Initialises GTK and runs its main loop on the calling thread, which must be the main one, until
+     * quit() or drain().
+     */
+    void run() {
+        app_ = Gtk::Application::create("com.example.alert", Gio::APPLICATION_NON_UNIQUE);
+        Glib::Dispatcher dispatcher;
+        dispatcher.connect(sigc::mem_fun(*this, &DialogNotifier::show_pending));
+        app_->signal_activate().connect([this, &dispatcher] {
+            app_->hold(); // keep running while no dialog is open
+            profile_.mark("GTK ready");
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                dispatcher_ = &dispatcher;
+            }
+            show_pending();
+        });
+        app_->run();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dispatcher_ = nullptr;
+        }
+        done_.set_value();
+    }
 
-/**
- * @brief a GTK message dialog box with the specified title, message, and button options.
- * @param title: The title of the message dialog box.
- * @param message: The main message displayed in the message dialog box.
- * @param message_type: The type of message dialog box (error, warning, info, etc.).
- * @param buttons_type: The type of buttons to display in the message dialog box (ok, cancel, yes-no, etc.).
- * @note: The function creates a GTK message dialog box with the specified parameters and displays it to the user.
- * @note: The dialog box will have a main message and a title displayed at the top, and will include buttons based on the specified button type.
- * @note: The function will wait for the user to interact with the dialog box before returning.
- * @note: This function requires a running GTK event loop. You should call it from a GTK application context.
- */
-void show_dialog(const std::string& title, const std::string& message, Gtk::MessageType message_type, Gtk::ButtonsType buttons_type) {
-    auto app = Gtk::Application::create("com.example.alert");
-    Gtk::MessageDialog dialog(title, false, message_type, buttons_type, true);
-    dialog.set_secondary_text(message);
-    dialog.signal_response().connect([&](int response_id){
-        dialog.close();
-    });
-    app->run(dialog);
-}
+    /**
+     * @brief Asks the GTK main loop to quit once the queued dialogs have been shown. Thread-safe.
+     */
+    void quit() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+        if (dispatcher_) {
+            dispatcher_->emit();
+        }
+    }
 
-/**
- * @brief Continuously checks data from a specified URL for updates and triggers alert events based on changes.
- * This function continuously fetches data from a specified URL and checks it for changes at a specified interval.
- * If the data indicates a change that warrants an alert, an alert sound and a GTK message dialog box will be triggered.
- * The alert sound is played using the 'mpg123' command-line tool and runs in the background without blocking other actions.
- * The GTK message dialog box displays a warning message with the region and status information.
- * @param alert_on The path of the alert sound file to be played when an alert is triggered.
- * @param alert_off The path of the alert sound file to be played when an alert is deactivated.
- * @param data_url The URL of the data source to fetch the data from.
- * @param update_interval The time interval (in seconds) to check for updates from the data source.
- * @return None.
- * @note This function requires a running GTK event loop. You should call it from a GTK application context.
- */
-void check_alerts(const std::string& alert_on, const std::string& alert_off, const std::string& data_url, int update_interval) {
-    while (true) {
-        Json::Value data = fetch_data(data_url);
-        if (data.empty()) {
-            std::cerr << "Failed to fetch data from " << data_url << std::endl;
-            continue; // continue the cycle without performing other actions
+    /**
+     * @brief Quits the GTK main loop, and waits for it.
+     */
+    bool drain(std::chrono::steady_clock::time_point deadline) override {
+        quit();
+        return finished_.wait_until(deadline) == std::future_status::ready;
+    }
+
+    void notify(const alerts::Transition& transition, const std::string& region) override {
+        Dialog dialog;
+        dialog.transition = transition;
+        alerts::format_alert_text(transition.kind, region, dialog.title, dialog.message);
+        dialog.message_type = transition.kind == alerts::TransitionKind::AlertOn ? Gtk::MESSAGE_WARNING
+                                                                                 : Gtk::MESSAGE_INFO;
+        queue(std::move(dialog));
+    }
+
+    /**
+     * @brief Shows a dialog when the data becomes stale, and another when it is fresh again.
+     */
+    void data_stale(bool stale, std::chrono::seconds age) override {
+        Dialog dialog;
+        dialog.stale = true;
+        alerts::format_stale_text(stale, age, dialog.title, dialog.message);
+        dialog.message_type = stale ? Gtk::MESSAGE_ERROR : Gtk::MESSAGE_INFO;
+        queue(std::move(dialog));
+    }
+
+private:
+    struct Dialog {
+        alerts::Transition transition;
+        bool stale = false; // about the data rather than a transition
+        std::string title;
+        std::string message;
+        Gtk::MessageType message_type;
+    };
+
+    /**
+     * @brief Queues a dialog, to be shown on the GTK thread once GTK is ready. Thread-safe.
+     */
+    void queue(Dialog dialog) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(dialog));
+        if (dispatcher_) {
+            dispatcher_->emit();
+        }
+    }
+
+    /**
+     * @brief Shows the queued dialogs, then quits if a shutdown was requested. Runs on the GTK thread.
+     */
+    void show_pending() {
+        std::vector<Dialog> dialogs;
+        bool quit;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dialogs.swap(pending_);
+            quit = quit_;
         }
-        std::string status = data[region].asString();
-
-        if (!alert_active && status == "full") {
-            alert_active = true;
-            std::thread sound_thread( play_alert_sound, alert_on );
-            sound_thread.detach();
-            std::thread dialog_thread(show_dialog, "ВСІ В УКРИТТЯ!!!",
-                                    "Увага! Повітряна тривога в регіоні: " + region + "!",
-                                    Gtk::MESSAGE_WARNING, Gtk::BUTTONS_OK);
-            dialog_thread.detach();
-        } else if (alert_active && (status == "null" || status == "no_data")) {
-            alert_active = false;
-            std::thread sound_thread( play_alert_sound, alert_off );
-            sound_thread.detach();
-            std::thread dialog_thread(show_dialog, "МОЖНА ПОВЕРТАТИСЬ НА РОБОЧІ МІСЦЯ!",
-                                    "Відбій повітряної тривоги в регіоні: " + region + "!",
-                                    Gtk::MESSAGE_INFO, Gtk::BUTTONS_OK);
-            dialog_thread.detach();
+        for (const Dialog& dialog : dialogs) {
+            show_dialog(dialog);
+        }
+        if (quit) {
+            app_->release();
+            app_->quit();
         }
-        
-        std::this_thread::sleep_for(std::chrono::seconds(update_interval));
     }
-}
+
+    /**
+     * @brief a GTK message dialog box with the title, message and type of a queued dialog, and an OK button.
+     * @param queued: The dialog to show, with the transition it tells about.
+     * @note: The dialog is not modal: the function returns immediately and the dialog is destroyed when closed.
+     * Pressing OK on a raised alert's dialog acknowledges the alert; closing it otherwise does not.
+     * @note: This function must run on the GTK thread.
+     */
+    void show_dialog(const Dialog& queued) {
+        auto dialog = new Gtk::MessageDialog(queued.title, false, queued.message_type, Gtk::BUTTONS_OK, false);
+        dialog->set_secondary_text(queued.message);
+        dialog->set_keep_above(true);
+        alerts::Transition transition = queued.transition;
+        bool acknowledges = !queued.stale && transition.kind == alerts::TransitionKind::AlertOn;
+        dialog->signal_response().connect([this, dialog, transition, acknowledges](int response) {
+            if (response == Gtk::RESPONSE_OK && acknowledges && on_ack_) {
+                on_ack_(transition);
+            }
+            dialog->hide();
+            Glib::signal_idle().connect_once([dialog] { delete dialog; });
+        });
+        app_->add_window(*dialog);
+        dialog->show();
+    }
+
+    alerts::StartupProfile& profile_;
+    std::function<void(const alerts::Transition&)> on_ack_;
+    Glib::RefPtr<Gtk::Application> app_;
+    std::mutex mutex_;
+    std::vector<Dialog> pending_;
+    Glib::Dispatcher* dispatcher_ = nullptr; // set while GTK is ready
+    bool quit_ = false;
+    std::promise<void> done_;
+    std::future<void> finished_;
+};
 
 /**
 * @brief The main entry point for the application.
 * This function reads a configuration file specified as a command line argument and extracts the necessary parameters.
-* Then it calls the 'check_alerts' function to monitor the alert status and play alert sounds and display dialogs if needed.
+* Then it runs the alerts engine, which polls the data source, plays alert sounds and shows desktop notifications
+* over D-Bus, or GTK dialogs when there is no session bus. A raised alert sounds again until it is acknowledged on
+* the desktop, and the acknowledgement latency is logged.
+* The first fetch starts right away. When dialogs are shown, GTK is initialised on the main thread in parallel with
+* it, and the event loop runs on a worker. The alert sounds are decoded on another thread, and every startup phase
+* is reported on stderr.
+* SIGTERM and SIGINT shut it down cleanly; SIGHUP restarts it.
 * @param argc An integer argument count of the command line arguments.
 * @param argv An argument vector of the command line arguments.
 * @return An integer value indicating the exit status of the program (0 for success, non-zero for failure).
@@ -157,27 +198,223 @@ void check_alerts(const std::string& alert_on, const std::string& alert_off, con
 * "alert_off": the path to the sound file to play when the alert status changes from "full" to "null" or "no_data"
 * "data_url": the URL of the data source to fetch the alert status from
 * "update_interval": the interval in seconds between the status checks
+* "state_file" (optional): where to keep the alert state across restarts
+* "snapshot_file" (optional): where to write a binary snapshot of every region after each poll
+* "drain_timeout" (optional): how many seconds pending notifications may take at shutdown (5 by default)
+* "stale_after" (optional): after how many seconds without fresh data to warn (3 update intervals by default)
+* "watchdog_timeout" (optional): after how many seconds a hung program aborts (60 by default)
+* "max_requests_per_minute" (optional): a limit on requests to the data source (none by default)
+* "upstream_period" (optional): how often the data source updates, in seconds (update_interval by default)
+* "repeat_after" (optional): seconds before an unacknowledged alert sounds again (60 by default, 0 to sound it once)
+* "multicast" (optional): "group:port" where instances on the LAN exchange transitions, signed with "multicast_key"
+* "multicast_role" (optional): "publish" to poll and broadcast (the default), "listen" to take the broadcast instead,
+*   "elect" to poll and broadcast only while elected leader among the instances
+* "leader_lease" (optional): with "elect", a lock file for the instances on one host to elect by; they elect over the
+*   LAN if it is not set
+* "seat_socket" (optional): the socket of an alert_headless service that polls for every session of the host; this
+*   instance then takes its transitions instead of polling, and the multicast settings are left to the service
  */
 int main(int argc, char** argv) {
+    alerts::StartupProfile profile(std::cerr);
+    alerts::EventLoop loop;
+    alerts::GracefulShutdown shutdown(loop); // before any thread is started
     if (argc < 2) {
         std::cerr << "Usage: " << argv[0] << " <config_file_path>\n";
         return 1;
     }
-    std::ifstream config_file(argv[1]);
-    if (!config_file) {
-        std::cerr << "Failed to open config file: " << argv[1] << "\n";
+    alerts::Config config;
+    std::string error;
+    if (!alerts::load_config(argv[1], config, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    alerts::MulticastOptions lan;
+    lan.key = config.multicast_key;
+    if (!config.multicast.empty() && !alerts::parse_multicast_address(config.multicast, lan, error)) {
+        std::cerr << error << "\n";
         return 1;
     }
-    Json::Value config;
-    config_file >> config;
+    profile.mark("config loaded");
+
+    auto sounds = std::make_shared<alerts::SoundNotifier>(config.alert_on, config.alert_off);
+    std::thread sound_loader([sounds, &profile] {
+        profile.mark(sounds->preload() ? "sounds loaded" : "sounds not loaded, playing from disk");
+    });
+    // Players are started on a notifier thread of their own. A raised alert sounds again, on the loop's timers,
+    // until it is acknowledged on the desktop.
+    std::shared_ptr<alerts::Notifier> siren = std::make_shared<alerts::QueuedNotifier>(sounds);
+    std::shared_ptr<alerts::AckTracker> acks;
+    if (config.repeat_after > 0) {
+        alerts::AckTracker::Options options;
+        options.repeat_after = std::chrono::seconds(config.repeat_after);
+        options.shortest_repeat = options.repeat_after / 4;
+        acks = std::make_shared<alerts::AckTracker>(loop, siren, options);
+        acks->set_ack_callback([](const alerts::Transition&, alerts::AckTracker::Clock::duration latency,
+                                  unsigned repeats) {
+            std::cerr << "Alert acknowledged after " << std::chrono::duration<double>(latency).count() << " s, "
+                      << repeats << " repeats" << std::endl;
+        });
+        siren = acks;
+    }
+    auto acknowledge = [acks](const alerts::Transition& transition) {
+        if (acks) {
+            acks->acknowledge(transition);
+        }
+    };
+
+    // Desktop notifications go to the notification daemon over D-Bus; without a session bus, GTK shows dialogs.
+    auto bus = std::make_shared<alerts::DBusNotifier>("alert_system");
+    bus->set_ack_callback(acknowledge);
+    bus->attach(loop);
+    std::shared_ptr<alerts::Notifier> desktop = bus;
+    std::shared_ptr<DialogNotifier> dialogs;
+    if (bus->connect(error)) {
+        profile.mark("session bus connected");
+    } else {
+        std::cerr << error << ", showing dialogs instead\n";
+        dialogs = std::make_shared<DialogNotifier>(profile);
+        dialogs->set_ack_callback(acknowledge);
+        desktop = dialogs;
+    }
 
-    region = config["region"].asString();
-    alert_on = config["alert_on"].asString();
-    alert_off = config["alert_off"].asString();
-    data_url = config["data_url"].asString();
-    update_interval = config["update_interval"].asInt();
+    alerts::Engine engine;
+    engine.watch(config.region);
+    engine.add_notifier(siren);
+    engine.add_notifier(desktop);
+    if (!config.state_file.empty() && !engine.load_state(config.state_file, error)) {
+        std::cerr << error << "\n";
+    }
+
+    if (config.max_requests_per_minute > 0) {
+        alerts::RateLimiter::process().set_rate(config.max_requests_per_minute / 60.0, 1);
+    }
+    // On a shared terminal the service polls for every session, and this instance only notifies its user.
+    std::unique_ptr<alerts::SeatAgent> agent;
+    if (!config.seat_socket.empty()) {
+        agent.reset(new alerts::SeatAgent(loop, engine, config.seat_socket));
+        if (!agent->start(error)) {
+            std::cerr << error << ", retrying\n";
+        }
+        config.multicast.clear();
+    }
+    // On a LAN one instance polls and broadcasts; the others take its broadcast instead of polling.
+    std::unique_ptr<alerts::MulticastPublisher> publisher;
+    std::unique_ptr<alerts::MulticastListener> listener;
+    std::unique_ptr<alerts::LeaderElection> election;
+    if (!config.multicast.empty() && config.multicast_role != "publish") {
+        listener.reset(new alerts::MulticastListener(loop, engine, lan));
+        if (!listener->start(error)) {
+            std::cerr << error << ", polling instead\n";
+            listener.reset();
+        }
+    }
+    if (!config.multicast.empty() && config.multicast_role != "listen") {
+        publisher.reset(new alerts::MulticastPublisher(lan));
+        if (!publisher->open(error)) {
+            std::cerr << error << ", not broadcasting\n";
+            publisher.reset();
+        }
+    }
+    if (config.multicast_role == "elect" && listener && publisher) {
+        if (config.leader_lease.empty()) {
+            election.reset(new alerts::HeartbeatElection(loop, *publisher));
+        } else {
+            election.reset(new alerts::FileLease(loop, config.leader_lease));
+        }
+    } else if (config.multicast_role == "elect") {
+        listener.reset(); // an election needs both; poll without one
+    }
 
-    check_alerts(alert_on, alert_off, data_url, update_interval);
+    alerts::HttpFeedSource source(config.data_url);
+    alerts::Monitor monitor(loop, engine, source, std::chrono::seconds(config.update_interval));
+    monitor.align_to_upstream(std::chrono::seconds(config.upstream_period ? config.upstream_period
+                                                                          : config.update_interval));
+    alerts::Watchdog watchdog(loop, std::chrono::seconds(config.watchdog_timeout),
+                              std::chrono::seconds(config.stale_after));
+    watchdog.set_stale_callback([&engine](bool stale, alerts::Watchdog::Clock::duration age) {
+        engine.report_stale(stale, std::chrono::duration_cast<std::chrono::seconds>(age));
+    });
+    if (listener) {
+        listener->set_packet_callback([&](const alerts::Packet& packet) {
+            if (packet.type == alerts::PacketType::Heartbeat) {
+                watchdog.data_received();
+            }
+            if (election) {
+                election->receive(packet);
+            }
+        });
+    }
+    if (agent) {
+        agent->set_packet_callback([&watchdog](const alerts::Packet& packet) {
+            if (packet.type == alerts::PacketType::Heartbeat) {
+                watchdog.data_received();
+            }
+        });
+    }
+    if (election) {
+        election->set_callback([&](bool leader) {
+            std::cerr << (leader ? "Elected to poll the data source" : "Another instance polls the data source")
+                      << std::endl;
+            if (leader) {
+                publisher->publish_state(engine); // for listeners that lost packets while nobody led
+                monitor.start();
+            } else {
+                monitor.stop();
+            }
+        });
+    }
+    bool first_poll = true;
+    monitor.set_poll_callback([&](bool decoded) {
+        if (decoded) {
+            watchdog.data_received();
+            if (publisher) {
+                publisher->publish(engine, std::time(nullptr));
+            }
+            if (!config.snapshot_file.empty() && !engine.save_binary_snapshot(config.snapshot_file, error)) {
+                std::cerr << error << "\n";
+            }
+        }
+        if (first_poll) {
+            first_poll = false;
+            profile.mark(decoded ? "first decision" : "first poll failed");
+        }
+    });
+    shutdown.attach(monitor, engine, config.state_file, std::chrono::seconds(config.drain_timeout), &watchdog);
+    watchdog.start();
+    if (election && !election->start(error)) {
+        std::cerr << error << ", polling instead\n";
+        election.reset();
+        monitor.start();
+    } else if (!listener && !agent) {
+        monitor.start();
+    }
+    auto run_loop = [&] {
+        loop.run();
+        if (election) {
+            election->set_callback(nullptr); // the monitor goes first
+        }
+        if (dialogs) {
+            dialogs->quit(); // also when the loop stopped without draining the notifiers
+        }
+    };
+    if (dialogs) {
+        // GTK wants the main thread; the loop, and so the first fetch, runs beside it.
+        std::thread worker(run_loop);
+        dialogs->run();
+        worker.join();
+    } else {
+        run_loop();
+    }
 
+    sound_loader.join();
+    std::cerr << "HTTP: " << alerts::HttpClient::shared().stats().summary() << "\n"
+              << "DNS: " << alerts::DnsCache::shared().stats().summary() << std::endl;
+    if (acks) {
+        std::cerr << "Alerts: " << acks->stats().summary() << std::endl;
+    }
+    if (shutdown.restart_requested()) {
+        alerts::GracefulShutdown::reexec(argv);
+        return 1;
+    }
     return 0;
 }
@@ -0,0 +1,51 @@
+#ifndef ALERTS_BENCH_BENCH_H
+#define ALERTS_BENCH_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+/*
+ * Minimal helpers shared by the benchmark programs: each benchmark runs a
+ * workload several times and reports the fastest round, which is the least
+ * disturbed by other activity on the machine.
+ */
+
+namespace alerts {
+namespace bench {
+
+/// Keeps the compiler from optimising away a computed value.
+template <class T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Runs a workload several times and returns the fastest round in seconds.
+ * @param rounds How many times to run the workload.
+ * @param workload The code to time.
+ */
+inline double best_of(int rounds, const std::function<void()>& workload) {
+    double best = 1e300;
+    for (int i = 0; i < rounds; ++i) {
+        auto started = std::chrono::steady_clock::now();
+        workload();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    }
+    return best;
+}
+
+/**
+ * @brief Prints one result line: the name, the time per operation and the operation rate.
+ */
+inline void report(const std::string& name, double seconds, double operations) {
+    std::printf("%-40s %12.1f ns/op %14.0f op/s\n", name.c_str(),
+                seconds * 1e9 / operations, operations / seconds);
+}
+
+} // namespace bench
+} // namespace alerts
+
+#endif // ALERTS_BENCH_BENCH_H
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alerts/ack_tracker.h"
+#include "alerts/dbus_notifier.h"
+#include "alerts/event_loop.h"
+#include "alerts/process_stats.h"
+#include "session_bus_stub.h"
+
+/*
+ * An acknowledgement drill, sped up. A hundred regions raise an alert at
+ * once; most are acknowledged after staggered delays and the rest are
+ * lifted first. Every event must have been repeated exactly as often as
+ * its escalating schedule allows before it was closed, with its latency
+ * recorded, and no thread may be started for the repeats. Then the time
+ * from a click on a desktop notification to the recorded acknowledgement is
+ * measured through a stand-in session bus. Exits non-zero on a mismatch.
+ */
+
+namespace {
+
+using Clock = alerts::AckTracker::Clock;
+using std::chrono::milliseconds;
+
+const int kRegions = 100;
+const milliseconds kRepeatAfter(40);
+const milliseconds kShortest(10);
+const milliseconds kLifted(55);
+const milliseconds kSlack(15); // timer and scheduling delay allowed
+
+double ms(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// Counts the notifications of every region; called on the loop thread only.
+class CountingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition& transition, const std::string&) override {
+        if (transition.kind == alerts::TransitionKind::AlertOn) {
+            ++counts[transition.region];
+        }
+    }
+    std::vector<int> counts = std::vector<int>(kRegions);
+};
+
+alerts::Transition transition(int region, alerts::TransitionKind kind, std::int64_t time) {
+    alerts::Transition result;
+    result.region = alerts::RegionId(region);
+    result.kind = kind;
+    result.status = kind == alerts::TransitionKind::AlertOn ? alerts::Status::Full : alerts::Status::Null;
+    result.time = time;
+    return result;
+}
+
+/// The repeats due strictly before a delay, on the tracker's schedule.
+int repeats_before(Clock::duration delay) {
+    int repeats = 0;
+    Clock::duration at = kRepeatAfter;
+    Clock::duration step = kRepeatAfter;
+    while (at < delay) {
+        ++repeats;
+        step = std::max(step / 2, Clock::duration(kShortest));
+        at += step;
+    }
+    return repeats;
+}
+
+/// Whether a delay falls too close to a repeat for the count to be certain.
+bool near_repeat(Clock::duration delay) {
+    Clock::duration at = kRepeatAfter;
+    Clock::duration step = kRepeatAfter;
+    while (at < delay + kSlack) {
+        if (delay - at < kSlack && at - delay < kSlack) {
+            return true;
+        }
+        step = std::max(step / 2, Clock::duration(kShortest));
+        at += step;
+    }
+    return false;
+}
+
+bool drill() {
+    alerts::EventLoop loop;
+    auto counter = std::make_shared<CountingNotifier>();
+    alerts::AckTracker::Options options;
+    options.repeat_after = kRepeatAfter;
+    options.shortest_repeat = kShortest;
+    alerts::AckTracker tracker(loop, counter, options);
+    std::vector<Clock::duration> latencies(kRegions);
+    std::vector<int> repeats(kRegions, -1);
+    tracker.set_ack_callback([&](const alerts::Transition& raised, Clock::duration latency, unsigned count) {
+        latencies[raised.region] = latency;
+        repeats[raised.region] = int(count);
+    });
+
+    int threads = alerts::read_process_stats().threads;
+    std::vector<Clock::time_point> raised(kRegions);
+    std::vector<Clock::time_point> clicked(kRegions);
+    for (int i = 0; i < kRegions; ++i) {
+        tracker.notify(transition(i, alerts::TransitionKind::AlertOn, 1000 + i), "region " + std::to_string(i));
+        raised[i] = Clock::now();
+        milliseconds delay(15 + i * 37 % 120);
+        if (i % 4 == 3) {
+            loop.add_timer(kLifted, [&tracker, i] {
+                tracker.notify(transition(i, alerts::TransitionKind::AlertOff, 2000 + i), "");
+            });
+        } else {
+            // Acknowledged from another thread, as a UI would; a stale acknowledgement is ignored.
+            loop.add_timer(delay, [&tracker, &clicked, i] {
+                std::thread([&tracker, &clicked, i] {
+                    clicked[i] = Clock::now();
+                    tracker.acknowledge(transition(i, alerts::TransitionKind::AlertOn, 1));
+                    tracker.acknowledge(transition(i, alerts::TransitionKind::AlertOn, 1000 + i));
+                }).join();
+            });
+        }
+    }
+    int threads_during = 0;
+    loop.add_timer(milliseconds(100), [&] { threads_during = alerts::read_process_stats().threads; });
+    loop.add_timer(milliseconds(200), [&] { loop.stop(); });
+    loop.run();
+
+    bool ok = tracker.open() == 0 && threads_during == threads;
+    double worst_error = 0;
+    for (int i = 0; i < kRegions; ++i) {
+        if (i % 4 == 3) {
+            ok = ok && repeats[i] == -1 && counter->counts[i] == 1 + repeats_before(kLifted);
+            continue;
+        }
+        // Against the time the acknowledgement was actually given, however late its timer fired.
+        Clock::duration delay = clicked[i] - raised[i];
+        double error = ms(latencies[i] - delay);
+        worst_error = std::max(worst_error, error);
+        bool count_ok = near_repeat(delay) ? std::abs(repeats[i] - repeats_before(delay)) <= 1
+                                           : repeats[i] == repeats_before(delay);
+        ok = ok && error >= 0 && error < ms(kSlack) && count_ok && counter->counts[i] == 1 + repeats[i];
+    }
+    alerts::AckTracker::Stats stats = tracker.stats();
+    ok = ok && stats.acknowledged == kRegions - kRegions / 4 && stats.lifted == kRegions / 4;
+    std::printf("drill: %s\n", stats.summary().c_str());
+    std::printf("drill: latency recorded at most %.2f ms after the acknowledgement, %d threads throughout\n",
+                worst_error, threads_during);
+    return ok;
+}
+
+bool desktop() {
+    alerts::tools::SessionBusStub bus;
+    alerts::EventLoop loop;
+    auto counter = std::make_shared<CountingNotifier>();
+    alerts::AckTracker tracker(loop, counter);
+    std::atomic<int> acknowledged{0};
+    tracker.set_ack_callback([&](const alerts::Transition&, Clock::duration, unsigned) { ++acknowledged; });
+    alerts::DBusNotifier notifier("alerts", bus.address());
+    notifier.set_ack_callback([&tracker](const alerts::Transition& raised) { tracker.acknowledge(raised); });
+    notifier.attach(loop);
+    std::string error;
+    if (!notifier.connect(error)) {
+        std::printf("%s\n", error.c_str());
+        return false;
+    }
+    std::thread runner([&loop] { loop.run(); });
+
+    const int rounds = 200;
+    Clock::duration total{};
+    Clock::duration worst{};
+    bool ok = true;
+    for (int i = 0; i < rounds && ok; ++i) {
+        std::size_t shown = bus.notifications().size();
+        loop.post([&, i] {
+            alerts::Transition raised = transition(0, alerts::TransitionKind::AlertOn, i);
+            tracker.notify(raised, "Київська область");
+            notifier.notify(raised, "Київська область");
+        });
+        auto deadline = Clock::now() + std::chrono::seconds(2);
+        while (bus.notifications().size() == shown || notifier.last_id() == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            ok = ok && Clock::now() < deadline;
+            if (!ok) {
+                break;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        auto shown_notification = bus.notifications().back();
+        ok = shown_notification.actions.size() == 2 && shown_notification.actions[0] == "default";
+        // Odd rounds are dismissed rather than clicked.
+        auto clicked = Clock::now();
+        if (i % 2 == 0) {
+            bus.invoke_action(notifier.last_id(), "default");
+        } else {
+            bus.close_notification(notifier.last_id(), 2);
+        }
+        while (acknowledged.load() == i && ok) {
+            std::this_thread::yield();
+            ok = Clock::now() < deadline;
+        }
+        Clock::duration latency = Clock::now() - clicked;
+        total += latency;
+        worst = std::max(worst, latency);
+    }
+    loop.stop();
+    runner.join();
+    ok = ok && acknowledged.load() == rounds && tracker.open() == 0;
+    std::printf("desktop: click to recorded acknowledgement mean %.1f us, max %.1f us over %d alerts\n",
+                ms(total) * 1e3 / rounds, ms(worst) * 1e3, rounds);
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = drill();
+    ok = desktop() && ok;
+    if (!ok) {
+        std::printf("acknowledgements were lost or repeats did not follow the schedule\n");
+    }
+    return ok ? 0 : 1;
+}
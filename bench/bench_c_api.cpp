@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include "alerts/alerts.h"
+#include "alerts/engine.h"
+#include "bench.h"
+#include "synthetic_feed.h"
+
+/*
+ * Per-feed cost of the C API compared with the C++ engine it wraps, over a
+ * synthetic week of full-region snapshots taken every 15 seconds. The two
+ * are timed in alternate rounds, so that the machine speeding up or slowing
+ * down during the run affects both alike; separate runs of either differ by
+ * several percent on a busy machine.
+ */
+
+namespace {
+
+class CountingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition&, const std::string&) override { ++count; }
+    long count = 0;
+};
+
+void count_transition(const alerts_transition*, void* user_data) {
+    ++*static_cast<long*>(user_data);
+}
+
+} // namespace
+
+int main() {
+    using namespace alerts;
+    const std::vector<FetchResult> feed = tools::synthesize_feed(7 * 86400, 15, 1);
+    const int rounds = 9;
+
+    long cpp_transitions = 0;
+    auto cpp_feed = [&] {
+        Engine engine;
+        auto counter = std::make_shared<CountingNotifier>();
+        engine.add_notifier(counter);
+        for (const auto& snapshot : feed) {
+            engine.feed(snapshot.body.data(), snapshot.body.size(), snapshot.time);
+        }
+        cpp_transitions = counter->count;
+    };
+
+    long c_transitions = 0;
+    auto c_feed = [&] {
+        long count = 0;
+        alerts_engine* engine = alerts_engine_create();
+        alerts_engine_set_callback(engine, count_transition, &count);
+        for (const auto& snapshot : feed) {
+            alerts_engine_feed(engine, snapshot.body.data(), snapshot.body.size(), snapshot.time);
+        }
+        alerts_engine_destroy(engine);
+        c_transitions = count;
+    };
+
+    double cpp = 1e300;
+    double c = 1e300;
+    for (int i = 0; i < rounds; ++i) {
+        cpp = std::min(cpp, bench::best_of(1, cpp_feed));
+        c = std::min(c, bench::best_of(1, c_feed));
+    }
+
+    bench::report("feed via alerts::Engine", cpp, double(feed.size()));
+    bench::report("feed via C API", c, double(feed.size()));
+    std::printf("C API overhead: %+.2f%% (%ld / %ld transitions)\n", (c / cpp - 1) * 100,
+                c_transitions, cpp_transitions);
+    return c_transitions == cpp_transitions ? 0 : 1;
+}
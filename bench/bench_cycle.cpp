@@ -0,0 +1,226 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "alerts/delta_feed.h"
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/known_regions.h"
+#include "alerts/monitor.h"
+#include "bench.h"
+#include "synthetic_feed.h"
+
+/*
+ * Heap allocations and time per poll cycle of a monitor: fetching a body
+ * from a source, handing it to the loop thread, decoding it, applying it and
+ * formatting the transitions. The source serves a synthetic day of snapshots
+ * from memory, appending each body in 16 KiB pieces as libcurl does: as
+ * JSON, as JSON with the Ukrainian names in \u escapes, or as delta feed
+ * bodies, for 27 regions and for 100 copies of each. Every operator new in
+ * the process is counted.
+ */
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_allocated_bytes{0};
+
+/// Serves prepared bodies in turn, in pieces.
+class MemorySource : public alerts::FeedSource {
+public:
+    explicit MemorySource(const std::vector<std::string>& bodies) : bodies_(bodies) {}
+
+    bool fetch(alerts::FetchResult& result) override {
+        const std::string& body = bodies_[next_++ % bodies_.size()];
+        result.body.clear();
+        for (size_t at = 0; at < body.size(); at += 16384) {
+            result.body.append(body, at, 16384);
+        }
+        result.time = std::int64_t(next_);
+        return true;
+    }
+
+    std::string describe() const override { return "memory"; }
+
+private:
+    const std::vector<std::string>& bodies_;
+    size_t next_ = 0;
+};
+
+enum class Format { Json, EscapedJson, Delta };
+
+/// A body with its keys replaced by the Ukrainian names, written as \u escapes as many JSON encoders do.
+std::string escape_keys(const std::string& body) {
+    std::string out;
+    size_t at = 0;
+    for (size_t open; (open = body.find('"', at)) != std::string::npos;) {
+        size_t close = body.find('"', open + 1);
+        out.append(body, at, open + 1 - at);
+        at = close + 1;
+        if (body.compare(close, 2, "\":") != 0) {
+            out.append(body, open + 1, at - open - 1); // a status
+            continue;
+        }
+        std::string key = body.substr(open + 1, close - open - 1);
+        std::string suffix;
+        int region = alerts::find_known_region(key.data(), key.size());
+        if (region < 0) {
+            suffix = key.substr(key.rfind(' '));
+            key.resize(key.size() - suffix.size());
+            region = alerts::find_known_region(key.data(), key.size());
+        }
+        std::string name = std::string(alerts::known_region_name(region, true)) + suffix;
+        for (size_t i = 0; i < name.size();) {
+            unsigned char c = static_cast<unsigned char>(name[i]);
+            unsigned code = c;
+            size_t length = 1;
+            if (c >= 0xc0) { // the names only have two-byte sequences
+                code = (c & 0x1f) << 6 | (static_cast<unsigned char>(name[i + 1]) & 0x3f);
+                length = 2;
+            }
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", code);
+            out += code < 0x80 ? std::string(1, char(code)) : std::string(escaped);
+            i += length;
+        }
+        out += '"';
+    }
+    out.append(body, at, std::string::npos);
+    return out;
+}
+
+/// The synthetic feed with `copies` copies of every region, in a given format.
+std::vector<std::string> prepare(int copies, Format format) {
+    std::vector<std::string> bodies;
+    alerts::RegionRegistry regions;
+    alerts::FeedDecoder decoder;
+    alerts::Snapshot snapshot;
+    alerts::DeltaPublisher publisher;
+    alerts::DeltaDecoder client;
+    alerts::RegionRegistry client_regions;
+    alerts::Snapshot client_snapshot;
+    for (const auto& fetched : alerts::tools::synthesize_feed(86400, 60, 1)) {
+        std::string body = fetched.body;
+        for (int copy = 1; copy < copies; ++copy) {
+            std::string renamed = fetched.body.substr(1, fetched.body.size() - 2);
+            for (size_t at = 0; (at = renamed.find("\":", at)) != std::string::npos; at += 2) {
+                std::string suffix = " " + std::to_string(copy);
+                renamed.insert(at, suffix);
+                at += suffix.size();
+            }
+            body.insert(body.size() - 1, "," + renamed);
+        }
+        if (format == Format::EscapedJson) {
+            body = escape_keys(body);
+        } else if (format == Format::Delta) {
+            decoder.decode(body.data(), body.size(), regions, snapshot);
+            publisher.publish(snapshot, regions);
+            publisher.encode(client.cursor(), body);
+            client.decode(body.data(), body.size(), client_regions, client_snapshot);
+        }
+        bodies.push_back(std::move(body));
+    }
+    return bodies;
+}
+
+struct Measured {
+    double seconds = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+/// Runs a monitor over the bodies; counts what the cycles after the first pass allocate.
+Measured run_monitor(const std::vector<std::string>& bodies) {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    std::ofstream null("/dev/null");
+    engine.add_notifier(std::make_shared<alerts::LogNotifier>(null));
+    MemorySource source(bodies);
+    alerts::Monitor monitor(loop, engine, source, std::chrono::seconds(0));
+    size_t polls = 0;
+    Measured measured;
+    std::chrono::steady_clock::time_point started;
+    monitor.set_poll_callback([&](bool) {
+        if (++polls == bodies.size()) {
+            // Every body has been seen once: buffers have grown to their working size.
+            started = std::chrono::steady_clock::now();
+            measured.allocations = g_allocations;
+            measured.bytes = g_allocated_bytes;
+        } else if (polls == 2 * bodies.size()) {
+            measured.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            measured.allocations = g_allocations - measured.allocations;
+            measured.bytes = g_allocated_bytes - measured.bytes;
+            monitor.stop();
+            loop.stop();
+        }
+    });
+    monitor.start();
+    loop.run();
+    return measured;
+}
+
+/// Feeds the bodies to an engine directly, without the monitor's threads.
+Measured run_engine(const std::vector<std::string>& bodies) {
+    alerts::Engine engine;
+    std::ofstream null("/dev/null");
+    engine.add_notifier(std::make_shared<alerts::LogNotifier>(null));
+    MemorySource source(bodies);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        engine.poll(source);
+    }
+    Measured measured;
+    size_t allocations = g_allocations;
+    size_t bytes = g_allocated_bytes;
+    measured.seconds = alerts::bench::best_of(3, [&] {
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            engine.poll(source);
+        }
+    });
+    measured.allocations = (g_allocations - allocations) / 3;
+    measured.bytes = (g_allocated_bytes - bytes) / 3;
+    return measured;
+}
+
+void print(const char* name, const Measured& measured, size_t cycles) {
+    std::printf("%-40s %10.1f us/cycle %8.2f allocations/cycle %10.0f bytes/cycle\n", name,
+                measured.seconds * 1e6 / cycles, double(measured.allocations) / cycles,
+                double(measured.bytes) / cycles);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    g_allocated_bytes += size;
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+int main() {
+    for (int copies : {1, 100}) {
+        for (Format format : {Format::Json, Format::EscapedJson, Format::Delta}) {
+            std::vector<std::string> bodies = prepare(copies, format);
+            std::printf("%zu regions, %s bodies\n", size_t(27) * copies,
+                        format == Format::Json ? "JSON" : format == Format::EscapedJson ? "escaped JSON" : "delta feed");
+            print("engine (poll)", run_engine(bodies), bodies.size());
+            print("monitor (fetch thread and event loop)", run_monitor(bodies), bodies.size());
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
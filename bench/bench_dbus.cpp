@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "alerts/dbus_notifier.h"
+#include "bench.h"
+#include "session_bus_stub.h"
+
+/*
+ * The cost of a desktop notification over D-Bus, against a stand-in session
+ * bus with a notification daemon on it: DBusNotifier on its one connection,
+ * and a new connection for every notification (authentication, Hello, then
+ * Notify), as a client that does not keep its connection would do. Then a
+ * raised alert is lifted a few times at a human pace, and every notification
+ * must replace the one before it and carry the right urgency. Last, alerts in
+ * two regions must keep a notification each, and dismissing the older one
+ * must acknowledge its own region's alert, and stale data must be announced
+ * by a notification of its own, which its return replaces.
+ */
+
+namespace {
+
+const int kEvents = 20000;
+
+alerts::Transition transition(int i, alerts::RegionId region = 0) {
+    alerts::Transition result;
+    result.region = region;
+    result.kind = i % 2 == 0 ? alerts::TransitionKind::AlertOn : alerts::TransitionKind::AlertOff;
+    result.status = i % 2 == 0 ? alerts::Status::Full : alerts::Status::Null;
+    result.time = 1700000000 + i;
+    return result;
+}
+
+/**
+ * @brief Raises alerts in two regions, lifts the first, then dismisses the second's notification.
+ * @return false if a region's notification was replaced by the other's, or the wrong alert was acknowledged.
+ */
+bool two_regions(alerts::tools::SessionBusStub& bus) {
+    alerts::Transition acknowledged{};
+    int acks = 0;
+    alerts::DBusNotifier notifier("alerts", bus.address());
+    notifier.set_ack_callback([&](const alerts::Transition& transition) {
+        acknowledged = transition;
+        ++acks;
+    });
+    size_t first = bus.notifications().size();
+    for (alerts::Transition transition : {transition(0, 1), transition(0, 2), transition(1, 1)}) {
+        notifier.notify(transition, transition.region == 1 ? "Київська область" : "Львівська область");
+        notifier.drain(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    }
+    auto received = bus.notifications();
+    if (received.size() != first + 3) {
+        std::printf("two regions: %zu of 3 notifications received\n", received.size() - first);
+        return false;
+    }
+    const auto& raised_a = received[first];
+    const auto& raised_b = received[first + 1];
+    const auto& lifted_a = received[first + 2];
+    bool separate = raised_b.replaces_id == 0 && raised_b.id != raised_a.id && lifted_a.replaces_id == raised_a.id;
+    bus.close_notification(raised_b.id, 2);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (acks == 0 && std::chrono::steady_clock::now() < deadline) {
+        notifier.drain(std::chrono::steady_clock::now());
+    }
+    bool acked = acks == 1 && acknowledged.region == 2 && acknowledged.kind == alerts::TransitionKind::AlertOn;
+    std::printf("two regions: a notification each: %s, dismissing the older acknowledges its region: %s\n",
+                separate ? "yes" : "no", acked ? "yes" : "no");
+
+    for (bool stale : {true, false}) {
+        notifier.data_stale(stale, std::chrono::seconds(stale ? 180 : 240));
+        notifier.drain(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    }
+    notifier.notify(transition(2, 1), "Київська область");
+    notifier.drain(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    received = bus.notifications();
+    bool own = received.size() == first + 6;
+    if (own) {
+        const auto& stale = received[first + 3];
+        const auto& fresh = received[first + 4];
+        const auto& raised = received[first + 5];
+        own = stale.replaces_id == 0 && stale.urgency == 2 && stale.id != raised_a.id && stale.id != raised_b.id &&
+              fresh.replaces_id == stale.id && raised.replaces_id == raised_a.id;
+    }
+    std::printf("stale data: a notification of its own, replaced when fresh: %s\n", own ? "yes" : "no");
+    return separate && acked && own;
+}
+
+} // namespace
+
+int main() {
+    alerts::tools::SessionBusStub bus;
+    const std::string region = "Київська область";
+    bool ok = true;
+
+    alerts::DBusNotifier shared("alerts", bus.address());
+    std::string error;
+    if (!shared.connect(error)) {
+        std::printf("%s\n", error.c_str());
+        return 1;
+    }
+    size_t messages = bus.messages();
+    double seconds = alerts::bench::best_of(1, [&] {
+        for (int i = 0; i < kEvents; ++i) {
+            shared.notify(transition(i), region);
+        }
+        shared.drain(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+    });
+    alerts::bench::report("one connection", seconds, kEvents);
+    std::printf("%-40s %12.2f messages/notification\n", "", double(bus.messages() - messages) / kEvents);
+    ok = ok && shared.sent() == size_t(kEvents) && bus.notifications().size() == size_t(kEvents);
+
+    messages = bus.messages();
+    size_t connections = bus.connections();
+    const int fresh_events = kEvents / 10;
+    seconds = alerts::bench::best_of(1, [&] {
+        for (int i = 0; i < fresh_events; ++i) {
+            alerts::DBusNotifier fresh("alerts", bus.address());
+            fresh.notify(transition(i), region);
+            fresh.drain(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+        }
+    });
+    alerts::bench::report("a connection per notification", seconds, fresh_events);
+    std::printf("%-40s %12.2f messages/notification, %zu connections\n", "",
+                double(bus.messages() - messages) / fresh_events, bus.connections() - connections);
+
+    // At a human pace every reply is in before the next notification, which then replaces it.
+    alerts::DBusNotifier paced("alerts", bus.address());
+    size_t first = bus.notifications().size();
+    for (int i = 0; i < 10; ++i) {
+        paced.notify(transition(i), region);
+        paced.drain(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    }
+    auto received = bus.notifications();
+    bool replaced = received.size() == first + 10;
+    for (size_t i = first; replaced && i < received.size(); ++i) {
+        replaced = received[i].id == received[first].id &&
+                   (i == first || received[i].replaces_id == received[first].id) &&
+                   received[i].urgency == ((i - first) % 2 == 0 ? 2 : 1);
+    }
+    std::printf("paced notifications replace each other: %s\n", replaced ? "yes" : "no");
+    ok = two_regions(bus) && ok && replaced;
+    if (!ok) {
+        std::printf("notifications were lost or not replaced\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "alerts/delta_feed.h"
+#include "alerts/engine.h"
+#include "alerts/feed_source.h"
+#include "bench.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * Bytes per update and client CPU of the delta feed compared with the full
+ * JSON, over a synthetic week of full-region snapshots taken every 15
+ * seconds. A proxy decodes every snapshot and publishes it; clients poll it
+ * after every snapshot, or after every tenth, and must end up with the same
+ * alerts as a client fed the JSON.
+ *
+ * Last, a client polls the proxy over HTTP for a day, and the proxy answers
+ * one request from a stale cursor, as a mirror lagging behind would. The
+ * client must reject that body, ask again from its own cursor and still end
+ * up with the alerts of the JSON.
+ */
+
+namespace {
+
+class CountingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition&, const std::string&) override { ++count; }
+    long count = 0;
+};
+
+struct Traffic {
+    std::vector<std::string> bodies; // what the client receives, one per poll
+    size_t bytes = 0;
+    size_t unchanged = 0;            // bodies that carry no region entry
+};
+
+/// Runs the proxy over the feed and records the answers to a client polling after every `every` snapshots.
+Traffic serve(const std::vector<alerts::FetchResult>& feed, size_t every) {
+    alerts::RegionRegistry regions;
+    alerts::FeedDecoder decoder;
+    alerts::Snapshot snapshot;
+    alerts::DeltaPublisher publisher;
+    alerts::DeltaDecoder client; // only follows the cursor
+    alerts::RegionRegistry client_regions;
+    alerts::Snapshot client_snapshot;
+    Traffic traffic;
+    for (size_t i = 0; i < feed.size(); ++i) {
+        decoder.decode(feed[i].body.data(), feed[i].body.size(), regions, snapshot);
+        publisher.publish(snapshot, regions);
+        if ((i + 1) % every != 0) {
+            continue;
+        }
+        std::string body;
+        publisher.encode(client.cursor(), body);
+        client.decode(body.data(), body.size(), client_regions, client_snapshot);
+        traffic.bytes += body.size();
+        traffic.unchanged += client_snapshot.readings.empty();
+        traffic.bodies.push_back(std::move(body));
+    }
+    return traffic;
+}
+
+/// The state of every region by name, sorted, since clients of the proxy register regions in its order.
+std::vector<std::string> state_of(const alerts::Engine& engine) {
+    std::vector<std::string> state;
+    for (size_t id = 0; id < engine.regions().size(); ++id) {
+        alerts::RegionId region = alerts::RegionId(id);
+        state.push_back(engine.regions().name(region) + "=" + alerts::status_name(engine.state().status(region)) +
+                        (engine.state().alert_active(region) ? "!" : ""));
+    }
+    std::sort(state.begin(), state.end());
+    return state;
+}
+
+/// Feeds every body to a fresh engine; returns the transitions, and the final state by region name.
+long replay(const std::vector<std::string>& bodies, std::vector<std::string>& state) {
+    alerts::Engine engine;
+    auto counter = std::make_shared<CountingNotifier>();
+    engine.add_notifier(counter);
+    for (const auto& body : bodies) {
+        engine.feed(body.data(), body.size(), 0);
+    }
+    state = state_of(engine);
+    return counter->count;
+}
+
+/**
+ * @brief Serves the feed from a proxy on a stub server and polls it through an HttpFeedSource after every snapshot.
+ * The proxy answers one request from the first cursor it was sent, rather than from the client's.
+ * @param state Receives the client's final state by region name.
+ * @return the polls that failed.
+ */
+size_t poll_over_http(const std::vector<alerts::FetchResult>& feed, std::vector<std::string>& state) {
+    alerts::RegionRegistry regions;
+    alerts::FeedDecoder decoder;
+    alerts::Snapshot snapshot;
+    alerts::DeltaPublisher publisher;
+    std::mutex mutex; // the server thread encodes while the main thread publishes
+    alerts::DeltaCursor first;
+    bool stale = false;
+    alerts::tools::StubServer server("");
+    server.set_handler([&](const std::string& head) {
+        const std::string header = "\r\nAlerts-Since: ";
+        alerts::DeltaCursor since;
+        size_t at = head.find(header);
+        if (at != std::string::npos) {
+            at += header.size();
+            since.parse(head.substr(at, head.find("\r\n", at) - at));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first.version == 0) {
+            first = since;
+        } else if (!stale && since.version > first.version) {
+            stale = true;
+            since = first;
+        }
+        std::string body;
+        publisher.encode(since, body);
+        return body;
+    });
+    alerts::RateLimiter unlimited;
+    alerts::HttpFeedSource source(server.url(), unlimited);
+    alerts::Engine engine;
+    size_t failed = 0;
+    for (const auto& response : feed) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoder.decode(response.body.data(), response.body.size(), regions, snapshot);
+            publisher.publish(snapshot, regions);
+        }
+        failed += !engine.poll(source);
+    }
+    state = state_of(engine);
+    return stale ? failed : 0;
+}
+
+} // namespace
+
+int main() {
+    using namespace alerts;
+    const std::vector<FetchResult> feed = tools::synthesize_feed(7 * 86400, 15, 1);
+    const int rounds = 5;
+    bool ok = true;
+
+    for (size_t every : {size_t(1), size_t(10)}) {
+        std::vector<std::string> json;
+        size_t json_bytes = 0;
+        for (size_t i = every - 1; i < feed.size(); i += every) {
+            json.push_back(feed[i].body);
+            json_bytes += feed[i].body.size();
+        }
+        Traffic delta = serve(feed, every);
+        size_t polls = json.size();
+        std::printf("client polling every %zu snapshot(s): %zu polls, %zu without changes\n", every, polls,
+                    delta.unchanged);
+        std::printf("%-40s %12.1f bytes/update\n", "full JSON", double(json_bytes) / polls);
+        std::printf("%-40s %12.1f bytes/update (%.1f%% of JSON)\n", "delta feed", double(delta.bytes) / polls,
+                    100.0 * delta.bytes / json_bytes);
+
+        std::vector<std::string> json_state;
+        std::vector<std::string> delta_state;
+        long json_transitions = 0;
+        long delta_transitions = 0;
+        double json_time = bench::best_of(rounds, [&] { json_transitions = replay(json, json_state); });
+        double delta_time = bench::best_of(rounds, [&] { delta_transitions = replay(delta.bodies, delta_state); });
+        bench::report("client feed, full JSON", json_time, double(polls));
+        bench::report("client feed, delta feed", delta_time, double(polls));
+
+        bool same = json_transitions == delta_transitions && json_state == delta_state;
+        std::printf("client CPU: %.1fx less; %ld / %ld transitions, final state %s\n\n", json_time / delta_time,
+                    delta_transitions, json_transitions, same ? "identical" : "DIFFERENT");
+        ok = ok && same;
+    }
+
+    const std::vector<FetchResult> day(feed.begin(), feed.begin() + std::min(feed.size(), size_t(86400 / 15)));
+    std::vector<std::string> json;
+    for (const auto& response : day) {
+        json.push_back(response.body);
+    }
+    std::vector<std::string> json_state;
+    std::vector<std::string> http_state;
+    replay(json, json_state);
+    size_t failed = poll_over_http(day, http_state);
+    bool same = json_state == http_state;
+    std::printf("client over HTTP, one stale answer: %zu polls, %zu rejected (1 expected), final state %s\n",
+                day.size(), failed, same ? "identical" : "DIFFERENT");
+    ok = ok && failed == 1 && same;
+    return ok ? 0 : 1;
+}
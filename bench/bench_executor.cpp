@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/executor.h"
+#include "alerts/feed_source.h"
+#include "alerts/monitor.h"
+#include "alerts/multi_monitor.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * Polling many sources in one process, as an aggregation node does: 200
+ * HttpFeedSources, each with its own engine, poll a local stub server back to
+ * back. The server answers with one snapshot of 100 copies of every region
+ * after 1 ms, so decoding outweighs the transfer. A MultiMonitor runs the
+ * fetches from one event loop and decodes on an Executor of 1, 2, 4, ... up
+ * to one worker per core (or up to `bench_executor <workers>`); the same
+ * sources on one Monitor each (a fetch thread per source, decoding on the
+ * loop thread) are the baseline. Every configuration must decode every
+ * response it fetches.
+ */
+
+namespace {
+
+const size_t kSources = 200;
+const std::chrono::seconds kDuration(2);
+
+struct Run {
+    size_t polls = 0;
+    size_t decoded = 0;
+    double seconds = 0;
+    alerts::Executor::Stats executor;
+};
+
+/// Polls every source through a MultiMonitor on `threads` workers for kDuration.
+Run run_multi(const std::string& url, size_t threads) {
+    std::vector<std::unique_ptr<alerts::HttpFeedSource>> sources;
+    std::vector<std::unique_ptr<alerts::Engine>> engines;
+    alerts::EventLoop loop;
+    alerts::Executor executor(threads);
+    alerts::MultiMonitor monitor(loop, executor);
+    for (size_t i = 0; i < kSources; ++i) {
+        sources.emplace_back(new alerts::HttpFeedSource(url));
+        engines.emplace_back(new alerts::Engine);
+        monitor.add(*sources.back(), *engines.back(), std::chrono::milliseconds(0));
+    }
+    Run run;
+    monitor.set_poll_callback([&run](size_t, bool decoded) {
+        ++run.polls;
+        run.decoded += decoded;
+    });
+    auto started = std::chrono::steady_clock::now();
+    loop.add_timer(kDuration, [&] {
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        monitor.stop();
+        loop.stop();
+    });
+    monitor.start();
+    loop.run();
+    run.executor = executor.stats();
+    return run;
+}
+
+/// Polls every source through a Monitor of its own, all on one loop, for kDuration.
+Run run_monitors(const std::string& url) {
+    std::vector<std::unique_ptr<alerts::HttpFeedSource>> sources;
+    std::vector<std::unique_ptr<alerts::Engine>> engines;
+    std::vector<std::unique_ptr<alerts::Monitor>> monitors;
+    alerts::EventLoop loop;
+    Run run;
+    for (size_t i = 0; i < kSources; ++i) {
+        sources.emplace_back(new alerts::HttpFeedSource(url));
+        engines.emplace_back(new alerts::Engine);
+        monitors.emplace_back(new alerts::Monitor(loop, *engines.back(), *sources.back(), std::chrono::seconds(0)));
+        monitors.back()->set_poll_callback([&run](bool decoded) {
+            ++run.polls;
+            run.decoded += decoded;
+        });
+    }
+    auto started = std::chrono::steady_clock::now();
+    loop.add_timer(kDuration, [&] {
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        for (auto& monitor : monitors) {
+            monitor->stop();
+        }
+        loop.stop();
+    });
+    for (auto& monitor : monitors) {
+        monitor->start();
+    }
+    loop.run();
+    return run;
+}
+
+/// Prints the poll rate, and for an executor its speed-up over one worker and the tasks stolen.
+void print(const char* name, const Run& run, double one_worker) {
+    std::printf("%-36s %8.0f polls/s", name, run.polls / run.seconds);
+    if (one_worker > 0) {
+        std::printf(" %7.2fx %9zu stolen", run.polls / run.seconds / one_worker, size_t(run.executor.stolen));
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    alerts::FetchResult snapshot;
+    alerts::tools::SyntheticFeed(60, 1).next(snapshot);
+    std::string body = snapshot.body;
+    for (int copy = 1; copy < 100; ++copy) {
+        std::string renamed = snapshot.body.substr(1, snapshot.body.size() - 2);
+        for (size_t at = 0; (at = renamed.find("\":", at)) != std::string::npos; at += 2) {
+            std::string suffix = " " + std::to_string(copy);
+            renamed.insert(at, suffix);
+            at += suffix.size();
+        }
+        body.insert(body.size() - 1, "," + renamed);
+    }
+    alerts::tools::StubServer server(body, std::chrono::milliseconds(1));
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_workers = argc > 1 ? std::max(1, std::atoi(argv[1])) : cores;
+    std::printf("%zu sources, %zu byte responses, %u core%s\n", kSources, body.size(), cores, cores > 1 ? "s" : "");
+
+    bool ok = true;
+    Run monitors = run_monitors(server.url());
+    print("Monitor per source", monitors, 0);
+    ok = ok && monitors.decoded == monitors.polls;
+    double one_worker = 0;
+    for (size_t threads = 1;; threads = std::min(threads * 2, max_workers)) {
+        Run run = run_multi(server.url(), threads);
+        char name[64];
+        std::snprintf(name, sizeof(name), "MultiMonitor, %zu worker%s", threads, threads > 1 ? "s" : "");
+        if (one_worker == 0) {
+            one_worker = run.polls / run.seconds;
+        }
+        print(name, run, one_worker);
+        ok = ok && run.decoded == run.polls && run.polls > 0;
+        if (threads == max_workers) {
+            break;
+        }
+    }
+    if (!ok) {
+        std::printf("some responses were not decoded\n");
+    }
+    return ok ? 0 : 1;
+}
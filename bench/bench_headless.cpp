@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "synthetic_feed.h"
+
+/*
+ * Footprint of the headless monitor: binary size, peak RSS and cold start
+ * time (exec to the first decision, then exit) over a local file:// feed, so
+ * no network latency is included.
+ */
+
+extern char** environ;
+
+namespace {
+
+struct Run {
+    double seconds;
+    long max_rss_kib;
+    int status;
+};
+
+Run run_once(const std::string& binary, const std::string& config) {
+    std::string path = binary;
+    std::string config_path = config;
+    char once[] = "--once";
+    char* argv[] = { &path[0], &config_path[0], once, nullptr };
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    auto started = std::chrono::steady_clock::now();
+    pid_t pid = -1;
+    Run run = { 0, 0, -1 };
+    if (posix_spawn(&pid, path.c_str(), &actions, nullptr, argv, environ) == 0) {
+        int status = 0;
+        struct rusage usage = {};
+        wait4(pid, &status, 0, &usage);
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        run.max_rss_kib = usage.ru_maxrss;
+        run.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string binary = argc > 1 ? argv[1] : ALERTS_HEADLESS_PATH;
+    const int runs = 20;
+
+    char dir_template[] = "/tmp/alerts-bench-XXXXXX";
+    const char* dir = mkdtemp(dir_template);
+    if (!dir) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::string feed_path = std::string(dir) + "/feed.json";
+    std::string config_path = std::string(dir) + "/config.json";
+    {
+        std::ofstream feed(feed_path);
+        feed << alerts::tools::synthesize_feed(60, 60, 1).front().body;
+        std::ofstream config(config_path);
+        config << "{\"region\": \"Lviv\", \"alert_on\": \"\", \"alert_off\": \"\",\n"
+               << " \"data_url\": \"file://" << feed_path << "\", \"update_interval\": 60}\n";
+    }
+
+    struct stat st = {};
+    if (stat(binary.c_str(), &st) != 0) {
+        std::perror(binary.c_str());
+        return 1;
+    }
+
+    std::vector<double> times;
+    long max_rss = 0;
+    int failures = 0;
+    run_once(binary, config_path); // warm the page cache
+    for (int i = 0; i < runs; ++i) {
+        Run run = run_once(binary, config_path);
+        failures += run.status != 0;
+        times.push_back(run.seconds);
+        max_rss = std::max(max_rss, run.max_rss_kib);
+    }
+    std::sort(times.begin(), times.end());
+    std::remove(feed_path.c_str());
+    std::remove(config_path.c_str());
+    rmdir(dir);
+
+    std::printf("binary:        %s\n", binary.c_str());
+    std::printf("size:          %lld KiB\n", (long long)st.st_size / 1024);
+    std::printf("peak RSS:      %ld KiB\n", max_rss);
+    std::printf("cold start:    %.2f ms median, %.2f ms min (%d runs)\n",
+                times[times.size() / 2] * 1e3, times.front() * 1e3, runs);
+    if (failures) {
+        std::printf("%d runs failed\n", failures);
+    }
+    return failures ? 1 : 0;
+}
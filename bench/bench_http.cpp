@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include "alerts/dns_cache.h"
+#include "alerts/feed_source.h"
+#include "alerts/http_client.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * Connection reuse and per-request latency of the HTTP sources against a
+ * local stub server that answers after a short delay, as a remote upstream
+ * would:
+ *
+ *   - a new easy handle per request, as the monitor originally fetched;
+ *   - one HttpFeedSource polling alone;
+ *   - several HttpFeedSources polling concurrently (sources and mirrors),
+ *     all sharing the process-wide HttpClient.
+ *
+ * The stub server speaks HTTP/1.1, so concurrent requests need one
+ * connection each; against an HTTP/2 upstream they are multiplexed over one.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kRequests = 200;
+const int kSources = 4;
+const std::chrono::milliseconds kServerDelay(2);
+
+size_t write_nothing(void*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+struct Result {
+    size_t requests = 0;
+    size_t connections = 0;
+    std::vector<double> latencies;
+};
+
+void print(const char* name, Result& result) {
+    std::sort(result.latencies.begin(), result.latencies.end());
+    double mean = 0;
+    for (double latency : result.latencies) {
+        mean += latency;
+    }
+    mean /= result.latencies.size();
+    std::printf("%-38s %6zu req %5zu conn %7.1f%% reuse %8.3f ms mean %8.3f ms p99\n", name, result.requests,
+                result.connections, 100.0 * (1.0 - double(result.connections) / result.requests), mean * 1e3,
+                result.latencies[result.latencies.size() * 99 / 100] * 1e3);
+}
+
+Result fresh_handles(const std::string& url) {
+    Result result;
+    for (int i = 0; i < kRequests; ++i) {
+        auto started = Clock::now();
+        CURL* curl = curl_easy_init();
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_nothing);
+        curl_easy_perform(curl);
+        long connects = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_cleanup(curl);
+        result.latencies.push_back(std::chrono::duration<double>(Clock::now() - started).count());
+        result.connections += connects;
+        ++result.requests;
+    }
+    return result;
+}
+
+Result shared_client(const std::string& url, int sources) {
+    alerts::HttpClient::Stats before = alerts::HttpClient::shared().stats();
+    std::vector<std::unique_ptr<alerts::HttpFeedSource>> feeds;
+    std::vector<std::vector<double>> latencies(sources);
+    for (int i = 0; i < sources; ++i) {
+        feeds.emplace_back(new alerts::HttpFeedSource(url));
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < sources; ++i) {
+        threads.emplace_back([&, i] {
+            alerts::FetchResult response;
+            for (int n = 0; n < kRequests / sources; ++n) {
+                auto started = Clock::now();
+                feeds[i]->fetch(response);
+                latencies[i].push_back(std::chrono::duration<double>(Clock::now() - started).count());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    alerts::HttpClient::Stats after = alerts::HttpClient::shared().stats();
+    Result result;
+    result.requests = after.requests - before.requests;
+    result.connections = after.new_connections - before.new_connections;
+    for (const auto& source : latencies) {
+        result.latencies.insert(result.latencies.end(), source.begin(), source.end());
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    alerts::FetchResult snapshot;
+    alerts::tools::SyntheticFeed(60, 1).next(snapshot);
+    alerts::tools::StubServer server(snapshot.body, kServerDelay);
+    std::string url = server.url();
+    std::printf("%d requests, server delay %lld ms\n", kRequests, (long long)kServerDelay.count());
+
+    Result fresh = fresh_handles(url);
+    print("new easy handle per request", fresh);
+    // The sources use a host name, which the DNS cache resolves in the background.
+    std::string named_url = "http://localhost:" + url.substr(url.rfind(':') + 1);
+    Result alone = shared_client(named_url, 1);
+    print("HttpFeedSource, 1 source", alone);
+    Result concurrent = shared_client(named_url, kSources);
+    std::string name = "HttpFeedSource, " + std::to_string(kSources) + " concurrent sources";
+    print(name.c_str(), concurrent);
+
+    alerts::HttpClient::Stats stats = alerts::HttpClient::shared().stats();
+    std::printf("shared client: %s\n", stats.summary().c_str());
+    std::printf("background DNS: %s\n", alerts::DnsCache::shared().stats().summary().c_str());
+    std::printf("server: %zu connections, %zu requests\n", server.connections(), server.requests());
+    bool ok = alone.requests == size_t(kRequests) && alone.connections <= 1 &&
+              concurrent.connections <= size_t(kSources);
+    return ok ? 0 : 1;
+}
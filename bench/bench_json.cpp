@@ -0,0 +1,126 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "alerts/engine.h"
+#include "alerts/json_scanner.h"
+#include "bench.h"
+#include "synthetic_feed.h"
+
+/*
+ * Decoding the upstream's JSON with the structural scanner at every
+ * instruction set level the CPU supports, over a recording (the first
+ * argument, or a synthetic day of snapshots taken every minute) and over the
+ * same recording with 100 copies of every region. Every level must decode the
+ * same readings.
+ */
+
+namespace {
+
+/// The snapshots of a recording with `copies` copies of every region, renamed "<name> <copy>".
+std::vector<std::string> inflate(const std::vector<alerts::FetchResult>& feed, int copies) {
+    std::vector<std::string> bodies;
+    for (const auto& snapshot : feed) {
+        std::string body = snapshot.body;
+        for (int copy = 1; copy < copies; ++copy) {
+            std::string renamed = snapshot.body.substr(1, snapshot.body.size() - 2);
+            for (size_t at = 0; (at = renamed.find("\":", at)) != std::string::npos; at += 2) {
+                std::string suffix = " " + std::to_string(copy);
+                renamed.insert(at, suffix);
+                at += suffix.size();
+            }
+            body.insert(body.size() - 1, "," + renamed);
+        }
+        bodies.push_back(std::move(body));
+    }
+    return bodies;
+}
+
+/// Decodes every body; returns the readings of all of them, as "<region id>=<status>" codes.
+std::vector<int> decode_all(const std::vector<std::string>& bodies, alerts::RegionRegistry& regions) {
+    alerts::FeedDecoder decoder;
+    alerts::Snapshot snapshot;
+    std::vector<int> readings;
+    for (const auto& body : bodies) {
+        if (!decoder.decode(body.data(), body.size(), regions, snapshot)) {
+            readings.push_back(-1);
+        }
+        for (const auto& reading : snapshot.readings) {
+            readings.push_back(int(reading.region) * 8 + int(reading.status));
+        }
+    }
+    return readings;
+}
+
+/// Walks the members of every body without decoding them; returns the bytes of keys and values seen.
+size_t scan_all(const std::vector<std::string>& bodies) {
+    size_t seen = 0;
+    for (const auto& body : bodies) {
+        alerts::JsonObjectScanner scanner(body.data(), body.size());
+        alerts::JsonMember member;
+        while (scanner.next(member)) {
+            seen += member.key_size + member.value_size;
+        }
+    }
+    return seen;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace alerts;
+    std::vector<FetchResult> feed;
+    if (argc > 1) {
+        if (!tools::read_recording(argv[1], feed) || feed.empty()) {
+            std::fprintf(stderr, "Cannot read recording %s\n", argv[1]);
+            return 2;
+        }
+    } else {
+        feed = tools::synthesize_feed(86400, 60, 1);
+    }
+    const int rounds = 5;
+    const SimdLevel best = best_json_simd_level();
+    bool ok = true;
+
+    for (int copies : {1, 100}) {
+        std::vector<std::string> bodies = inflate(feed, copies);
+        size_t bytes = 0;
+        for (const auto& body : bodies) {
+            bytes += body.size();
+        }
+        std::printf("%zu snapshots of %.0f bytes on average\n", bodies.size(), double(bytes) / bodies.size());
+
+        std::vector<int> expected;
+        double scalar_time = 0;
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2}) {
+            if (level > best) {
+                std::printf("%-40s not supported by this CPU\n", simd_level_name(level));
+                continue;
+            }
+            set_json_simd_level(level);
+            size_t seen = 0;
+            double scan_time = bench::best_of(rounds, [&] { seen = scan_all(bodies); });
+            std::string label = std::string("scan, ") + simd_level_name(level);
+            bench::report(label, scan_time, double(bodies.size()));
+            std::vector<int> readings;
+            double time = bench::best_of(rounds, [&] {
+                RegionRegistry regions;
+                readings = decode_all(bodies, regions);
+            });
+            label = std::string("decode (FeedDecoder), ") + simd_level_name(level);
+            bench::report(label, time, double(bodies.size()));
+            std::printf("%-40s %12.0f MB/s", "", bytes / time / 1e6);
+            if (level == SimdLevel::Scalar) {
+                expected = readings;
+                scalar_time = time;
+                std::printf("\n");
+            } else {
+                bool same = readings == expected;
+                std::printf(" (%.2fx scalar), readings %s\n", scalar_time / time, same ? "identical" : "DIFFERENT");
+                ok = ok && same;
+            }
+        }
+        std::printf("\n");
+    }
+    set_json_simd_level(best);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/feed_source.h"
+#include "alerts/leader.h"
+#include "alerts/monitor.h"
+#include "alerts/multicast.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * Several instances on one host polling a local data source: first all of
+ * them, as before leader election, then only an elected leader, by a file
+ * lease and by heartbeats on loopback multicast, while the others take its
+ * broadcast. Counts the requests the data source receives in each case, then
+ * kills the leader and measures how long the others take to elect a new one
+ * and to fetch again. Last, a leader steps down and rejoins, the others are
+ * killed, and the former leader must be elected again and decode its polls.
+ * Exits non-zero if more than one instance polls while elected, if nobody
+ * takes over, or if a re-elected leader cannot poll.
+ *
+ * Usage: bench_leader [instances]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char kKey[] = "bench_leader";
+const auto kSettle = std::chrono::milliseconds(1500);
+const auto kWindow = std::chrono::seconds(3);
+const auto kFailoverTimeout = std::chrono::seconds(5);
+const auto kHeartbeatPeriod = std::chrono::milliseconds(100);
+const int kMissedHeartbeats = 3;
+
+enum class Mode { Everyone, Lease, Heartbeat };
+
+/// What a child reports to the parent, through a pipe shared by all of them.
+struct Event {
+    enum Type : int { Leader, Follower, Polled, Failed, Rejoined }; // Polled: fetched and decoded
+    int instance;
+    Type type;
+    Clock::rep time;
+};
+
+alerts::MulticastOptions options(Mode mode) {
+    alerts::MulticastOptions result;
+    result.port = std::uint16_t(5100 + int(mode));
+    result.interface = "127.0.0.1";
+    result.key = kKey;
+    return result;
+}
+
+void report(int fd, int instance, Event::Type type) {
+    Event event{instance, type, Clock::now().time_since_epoch().count()};
+    (void)!write(fd, &event, sizeof(event));
+}
+
+/**
+ * @brief An instance: polls the URL read from url_fd, always or while elected, until it is killed. SIGUSR1 makes it
+ * leave the election, and SIGUSR2 rejoin it.
+ */
+int instance_child(int instance, Mode mode, const std::string& lease, int url_fd, int event_fd) {
+    char url[256] = {};
+    if (read(url_fd, url, sizeof(url) - 1) <= 0) {
+        return 1;
+    }
+    alerts::EventLoop loop;
+    std::unique_ptr<alerts::LeaderElection> election;
+    loop.watch_signals({SIGUSR1, SIGUSR2}, [&](int signal_number) {
+        std::string error;
+        if (!election) {
+            return;
+        } else if (signal_number == SIGUSR1) {
+            election->stop();
+        } else if (election->start(error)) {
+            report(event_fd, instance, Event::Rejoined);
+        }
+    });
+    alerts::Engine engine;
+    alerts::HttpFeedSource source(url);
+    alerts::Monitor monitor(loop, engine, source, std::chrono::seconds(1));
+    alerts::MulticastPublisher publisher(options(mode));
+    alerts::MulticastListener listener(loop, engine, options(mode));
+    if (mode == Mode::Lease) {
+        election.reset(new alerts::FileLease(loop, lease));
+    } else if (mode == Mode::Heartbeat) {
+        election.reset(new alerts::HeartbeatElection(loop, publisher, kHeartbeatPeriod, kMissedHeartbeats));
+    }
+    std::string error;
+    if (!publisher.open(error) || !listener.start(error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    monitor.set_poll_callback([&](bool decoded) {
+        report(event_fd, instance, decoded ? Event::Polled : Event::Failed);
+        if (decoded) {
+            publisher.publish(engine, std::time(nullptr));
+        }
+    });
+    if (!election) {
+        monitor.start();
+        loop.run();
+        return 0;
+    }
+    listener.set_packet_callback([&](const alerts::Packet& packet) { election->receive(packet); });
+    election->set_callback([&](bool leader) {
+        report(event_fd, instance, leader ? Event::Leader : Event::Follower);
+        if (leader) {
+            publisher.publish_state(engine);
+            monitor.start();
+        } else {
+            monitor.stop();
+        }
+    });
+    if (!election->start(error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    loop.run();
+    return 0;
+}
+
+/// Reads the next event before the deadline. @return false on timeout.
+bool next_event(int fd, Event& event, Clock::time_point deadline) {
+    for (;;) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        pollfd ready{fd, POLLIN, 0};
+        if (left <= 0 || poll(&ready, 1, int(left) + 1) <= 0) {
+            return false;
+        }
+        if (read(fd, &event, sizeof(event)) == ssize_t(sizeof(event))) {
+            return true;
+        }
+    }
+}
+
+double milliseconds(Clock::rep from, Clock::rep to) {
+    return std::chrono::duration<double, std::milli>(Clock::duration(to - from)).count();
+}
+
+/**
+ * @brief Makes the leader step down and rejoin, kills every other instance, and checks that the former leader is
+ * elected again and decodes a poll.
+ */
+bool reelect(int events, std::vector<pid_t>& children, int leader) {
+    kill(children[leader], SIGUSR1);
+    bool replaced = false;
+    bool rejoined = false;
+    Event event;
+    Clock::time_point deadline = Clock::now() + kFailoverTimeout;
+    while (!replaced && next_event(events, event, deadline)) {
+        replaced = event.type == Event::Leader && event.instance != leader;
+    }
+    kill(children[leader], SIGUSR2);
+    while (replaced && !rejoined && next_event(events, event, deadline)) {
+        rejoined = event.type == Event::Rejoined && event.instance == leader;
+    }
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        if (int(i) != leader && children[i] > 0) {
+            kill(children[i], SIGKILL);
+        }
+    }
+    bool elected = false;
+    bool decoded = false;
+    bool failed = false;
+    deadline = Clock::now() + kFailoverTimeout;
+    while (!decoded && !failed && next_event(events, event, deadline)) {
+        if (event.instance != leader) {
+            continue;
+        }
+        elected = elected || event.type == Event::Leader;
+        decoded = elected && event.type == Event::Polled;
+        failed = elected && event.type == Event::Failed;
+    }
+    std::printf("%-34s %s\n", "  re-elected former leader:",
+                !replaced || !rejoined ? "did not step down and rejoin"
+                : !elected             ? "not elected again"
+                : decoded              ? "polls again"
+                                       : "cannot poll");
+    return decoded;
+}
+
+/// Runs one configuration. @return false if it misbehaved.
+bool run(const char* name, Mode mode, int instances, double& requests_per_second) {
+    std::string lease = "/tmp/bench_leader." + std::to_string(getpid()) + ".lock";
+    int events[2];
+    if (pipe(events) != 0) {
+        return false;
+    }
+    // The children are forked before the server starts its thread, and wait for its URL.
+    std::vector<pid_t> children;
+    std::vector<int> urls;
+    for (int i = 0; i < instances; ++i) {
+        int url[2];
+        if (pipe(url) != 0) {
+            return false;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(events[0]);
+            close(url[1]);
+            _exit(instance_child(i, mode, lease, url[0], events[1]));
+        }
+        close(url[0]);
+        children.push_back(pid);
+        urls.push_back(url[1]);
+    }
+    close(events[1]);
+    alerts::FetchResult snapshot;
+    alerts::tools::SyntheticFeed(60, 1).next(snapshot);
+    alerts::tools::StubServer server(snapshot.body);
+    std::string url = server.url();
+    for (int fd : urls) {
+        (void)!write(fd, url.c_str(), url.size());
+        close(fd);
+    }
+
+    // Let the instances elect a leader, then count what the data source receives.
+    int leader = -1;
+    Event event;
+    Clock::time_point settled = Clock::now() + kSettle;
+    while (next_event(events[0], event, settled)) {
+        if (event.type == Event::Leader) {
+            leader = event.instance;
+        } else if (event.type == Event::Follower && event.instance == leader) {
+            leader = -1;
+        }
+    }
+    std::size_t before = server.requests();
+    std::set<int> polling;
+    Clock::time_point window_end = Clock::now() + kWindow;
+    while (next_event(events[0], event, window_end)) {
+        if (event.type == Event::Polled || event.type == Event::Failed) {
+            polling.insert(event.instance);
+        } else if (event.type == Event::Leader) {
+            leader = event.instance;
+        }
+    }
+    std::size_t requests = server.requests() - before;
+    requests_per_second = double(requests) / std::chrono::duration<double>(kWindow).count();
+    std::printf("%-34s %zu requests in %lld s (%.1f/s) from %zu instance%s\n", name, requests,
+                (long long)std::chrono::duration_cast<std::chrono::seconds>(kWindow).count(), requests_per_second,
+                polling.size(), polling.size() == 1 ? "" : "s");
+    bool ok = mode == Mode::Everyone ? int(polling.size()) == instances : polling.size() == 1 && leader >= 0;
+
+    // Kill the leader and wait for another instance to lead and fetch.
+    if (mode != Mode::Everyone && leader >= 0) {
+        Clock::rep killed = Clock::now().time_since_epoch().count();
+        kill(children[leader], SIGKILL);
+        Clock::rep elected = 0;
+        Clock::rep fetched = 0;
+        int successor = -1;
+        Clock::time_point deadline = Clock::now() + kFailoverTimeout;
+        while (fetched == 0 && next_event(events[0], event, deadline)) {
+            if (event.instance == leader) {
+                continue; // written before it died
+            }
+            if (event.type == Event::Leader && successor < 0) {
+                successor = event.instance;
+                elected = event.time;
+            } else if (event.type == Event::Polled && event.instance == successor) {
+                fetched = event.time;
+            }
+        }
+        if (fetched != 0) {
+            std::printf("%-34s new leader %.2f ms after the kill, first fetch after %.2f ms\n", "  failover:",
+                        milliseconds(killed, elected), milliseconds(killed, fetched));
+        } else {
+            std::printf("  no instance took over within %lld s\n",
+                        (long long)std::chrono::duration_cast<std::chrono::seconds>(kFailoverTimeout).count());
+            ok = false;
+        }
+        ok = ok && successor >= 0 && reelect(events[0], children, successor);
+    }
+
+    for (pid_t child : children) {
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+    }
+    close(events[0]);
+    unlink(lease.c_str());
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int instances = argc > 1 ? std::max(2, std::atoi(argv[1])) : 4;
+    std::printf("%d instances polling every second\n", instances);
+    double everyone = 0;
+    double lease = 0;
+    double heartbeat = 0;
+    bool ok = run("no election:", Mode::Everyone, instances, everyone);
+    ok = run("file lease:", Mode::Lease, instances, lease) && ok;
+    std::string name = "heartbeats (" + std::to_string(kHeartbeatPeriod.count()) + " ms, " +
+                       std::to_string(kMissedHeartbeats) + " missed):";
+    ok = run(name.c_str(), Mode::Heartbeat, instances, heartbeat) && ok;
+    if (everyone > 0) {
+        std::printf("upstream requests: %.0f%% fewer with a file lease, %.0f%% fewer with heartbeats\n",
+                    100 * (1 - lease / everyone), 100 * (1 - heartbeat / everyone));
+    }
+    if (!ok) {
+        std::printf("more than one instance polled while elected, nobody took over, or a re-elected leader could not "
+                    "poll\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/multicast.h"
+
+/*
+ * Transitions broadcast over loopback multicast to many listener processes,
+ * as to the workstations of an office floor. The publisher raises and lifts
+ * an alert in turn; every listener applies the packets to an engine of its
+ * own and reports when each transition reached its notifier. Forged packets
+ * (another key), replayed packets and duplicates must not reach a notifier,
+ * nor must a packet recorded long ago reach a listener that has just started.
+ * A listener must also forget the senders of publishers that restarted.
+ * Reports the delivery latency from the send to the notifier of every
+ * listener, and exits non-zero if a transition was lost, a bad packet got
+ * through, or a silent sender was not forgotten.
+ *
+ * Usage: bench_multicast [listeners]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kTransitions = 200;
+const char kKey[] = "office floor 3";
+
+/// Records when each transition reached the listener's notifiers.
+class TimingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition& transition, const std::string&) override {
+        if (transition.time >= 0 && transition.time < kTransitions) {
+            arrived[transition.time] = Clock::now().time_since_epoch().count();
+        }
+        ++notified;
+    }
+    std::vector<Clock::rep> arrived = std::vector<Clock::rep>(kTransitions, 0);
+    int notified = 0;
+};
+
+alerts::MulticastOptions options() {
+    alerts::MulticastOptions result;
+    result.group = "239.255.42.99";
+    result.port = 5099;
+    result.interface = "127.0.0.1";
+    result.key = kKey;
+    return result;
+}
+
+/**
+ * @brief A listener process: joins the group, tells the parent it is ready, and after the last transition
+ * (or after five seconds) writes its arrival times and counts to the pipe.
+ */
+int listen_child(int ready_fd, int result_fd) {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    auto timing = std::make_shared<TimingNotifier>();
+    engine.add_notifier(timing);
+    alerts::MulticastListener listener(loop, engine, options());
+    std::string error;
+    if (!listener.start(error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    alerts::EventLoop::TimerId timeout = loop.add_timer(std::chrono::seconds(5), [&loop] { loop.stop(); });
+    listener.set_packet_callback([&](const alerts::Packet& packet) {
+        if (packet.type == alerts::PacketType::Heartbeat && packet.time == kTransitions) {
+            // The end marker; give stragglers nothing more to wait for.
+            loop.cancel_timer(timeout);
+            loop.stop();
+        }
+    });
+    char ready = 1;
+    (void)!write(ready_fd, &ready, 1);
+    loop.run();
+    const alerts::MulticastListener::Stats& stats = listener.stats();
+    std::vector<Clock::rep> result(timing->arrived);
+    result.push_back(timing->notified);
+    result.push_back(Clock::rep(stats.rejected));
+    result.push_back(Clock::rep(stats.replayed));
+    (void)!write(result_fd, result.data(), result.size() * sizeof(Clock::rep));
+    return 0;
+}
+
+/// Sends an encoded packet to the group from a socket of its own, as an attacker on the LAN would.
+void send_raw(const char* data, std::size_t size) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in group{};
+    group.sin_family = AF_INET;
+    group.sin_port = htons(5099);
+    inet_pton(AF_INET, "239.255.42.99", &group.sin_addr);
+    in_addr interface;
+    inet_pton(AF_INET, "127.0.0.1", &interface);
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface));
+    sendto(fd, data, size, 0, reinterpret_cast<sockaddr*>(&group), sizeof(group));
+    close(fd);
+}
+
+/**
+ * @brief A listener that has just started, and so knows no sender's sequence numbers, is sent a raise recorded
+ * longer ago than it accepts, then the same raise sent now. @return whether only the second was applied.
+ */
+bool fresh_listener_drops_old_packet() {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    auto timing = std::make_shared<TimingNotifier>();
+    engine.add_notifier(timing);
+    alerts::MulticastListener listener(loop, engine, options());
+    std::string error;
+    if (!listener.start(error)) {
+        std::printf("%s\n", error.c_str());
+        return false;
+    }
+    std::int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    alerts::Packet packet;
+    packet.type = alerts::PacketType::Transition;
+    packet.kind = alerts::TransitionKind::AlertOn;
+    packet.status = alerts::Status::Full;
+    packet.region = "Київська область";
+    packet.sender = 42;
+    packet.sequence = 1;
+    packet.sent = now - std::chrono::duration_cast<std::chrono::milliseconds>(options().max_age).count() - 5000;
+    char buffer[alerts::kMaxPacketSize];
+    send_raw(buffer, alerts::encode_packet(packet, kKey, buffer));
+    packet.sequence = 2;
+    packet.sent = now;
+    send_raw(buffer, alerts::encode_packet(packet, kKey, buffer));
+    loop.add_timer(std::chrono::milliseconds(100), [&loop] { loop.stop(); });
+    loop.run();
+    std::printf("listener just started: %llu packet recorded %lld s ago dropped, %llu sent now applied\n",
+                (unsigned long long)listener.stats().stale, (long long)options().max_age.count() + 5,
+                (unsigned long long)listener.stats().accepted);
+    return listener.stats().stale == 1 && listener.stats().accepted == 1 && timing->notified == 1;
+}
+
+/**
+ * @brief Publishers that restarted, each under a new sender ID, then fell silent: the listener must forget them
+ * once they have been silent for twice max_age. @return whether only the last sender is remembered.
+ */
+bool listener_forgets_old_senders() {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    alerts::MulticastOptions short_lived = options();
+    short_lived.max_age = std::chrono::seconds(1);
+    alerts::MulticastListener listener(loop, engine, short_lived);
+    std::string error;
+    if (!listener.start(error)) {
+        std::printf("%s\n", error.c_str());
+        return false;
+    }
+    alerts::Packet packet;
+    packet.type = alerts::PacketType::Heartbeat;
+    packet.sequence = 1;
+    char buffer[alerts::kMaxPacketSize];
+    const std::uint32_t restarts = 100;
+    for (std::uint32_t sender = 1; sender <= restarts + 1; ++sender) {
+        if (sender == restarts + 1) {
+            // Silent for longer than twice max_age before the last restart.
+            loop.add_timer(std::chrono::milliseconds(2500), [&loop] { loop.stop(); });
+            loop.run();
+        }
+        packet.sender = sender;
+        packet.sent = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch()).count();
+        send_raw(buffer, alerts::encode_packet(packet, kKey, buffer));
+        poll(nullptr, 0, 1);
+    }
+    loop.add_timer(std::chrono::milliseconds(100), [&loop] { loop.stop(); });
+    loop.run();
+    std::printf("listener after %u publisher restarts: %llu packets accepted, %zu senders remembered\n",
+                restarts, (unsigned long long)listener.stats().accepted, listener.senders());
+    return listener.stats().accepted == restarts + 1 && listener.senders() == 1;
+}
+
+bool read_all(int fd, void* data, std::size_t size) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = read(fd, out, size);
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= std::size_t(n);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int listeners = argc > 1 ? std::atoi(argv[1]) : 32;
+    std::vector<int> ready(2);
+    std::vector<pid_t> children;
+    std::vector<int> results;
+    if (pipe(ready.data()) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < listeners; ++i) {
+        int result[2];
+        if (pipe(result) != 0) {
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            close(result[0]);
+            _exit(listen_child(ready[1], result[1]));
+        }
+        close(result[1]);
+        children.push_back(pid);
+        results.push_back(result[0]);
+    }
+    close(ready[1]);
+    for (int i = 0; i < listeners; ++i) {
+        char byte;
+        if (read(ready[0], &byte, 1) != 1) {
+            std::printf("a listener failed to join the group\n");
+            return 1;
+        }
+    }
+
+    alerts::MulticastPublisher publisher(options());
+    alerts::MulticastOptions forged_options = options();
+    forged_options.key = "a guess";
+    alerts::MulticastPublisher forger(forged_options);
+    std::string error;
+    if (!publisher.open(error) || !forger.open(error)) {
+        std::printf("%s\n", error.c_str());
+        return 1;
+    }
+    std::vector<Clock::rep> sent(kTransitions);
+    char replay[alerts::kMaxPacketSize];
+    std::size_t replay_size = 0;
+    int bad_packets = 0;
+    for (int i = 0; i < kTransitions; ++i) {
+        alerts::Packet packet;
+        packet.type = alerts::PacketType::Transition;
+        packet.kind = i % 2 == 0 ? alerts::TransitionKind::AlertOn : alerts::TransitionKind::AlertOff;
+        packet.status = i % 2 == 0 ? alerts::Status::Full : alerts::Status::Null;
+        packet.time = i;
+        packet.region = "Київська область";
+        sent[i] = Clock::now().time_since_epoch().count();
+        publisher.send(packet);
+        if (i == 0) {
+            replay_size = alerts::encode_packet(packet, kKey, replay);
+        }
+        // A forged lift right after every raise, and the first raise replayed after every lift.
+        if (i % 2 == 0) {
+            alerts::Packet forged = packet;
+            forged.kind = alerts::TransitionKind::AlertOff;
+            forged.status = alerts::Status::Null;
+            forger.send(forged);
+        } else {
+            alerts::Packet duplicate = packet;
+            publisher.send(duplicate); // the same state again: applied, but nothing to notify
+            send_raw(replay, replay_size);
+        }
+        ++bad_packets;
+        // Spaced out as alerts are, so no socket buffer overflows.
+        poll(nullptr, 0, 1);
+    }
+    alerts::Packet end;
+    end.time = kTransitions;
+    publisher.send(end);
+
+    std::vector<double> latencies;
+    bool ok = true;
+    int lost = 0;
+    std::uint64_t rejected = 0;
+    std::uint64_t replayed = 0;
+    for (int i = 0; i < listeners; ++i) {
+        std::vector<Clock::rep> result(kTransitions + 3);
+        int status = 0;
+        bool got = read_all(results[i], result.data(), result.size() * sizeof(Clock::rep));
+        waitpid(children[i], &status, 0);
+        if (!got || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+            continue;
+        }
+        for (int j = 0; j < kTransitions; ++j) {
+            if (result[j] == 0) {
+                ++lost;
+            } else {
+                Clock::duration latency(result[j] - sent[j]);
+                latencies.push_back(std::chrono::duration<double, std::micro>(latency).count());
+            }
+        }
+        ok = ok && result[kTransitions] == kTransitions;
+        rejected += std::uint64_t(result[kTransitions + 1]);
+        replayed += std::uint64_t(result[kTransitions + 2]);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        std::printf("%d listeners, %d transitions each: send to notifier p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                    listeners, kTransitions, latencies[latencies.size() / 2],
+                    latencies[latencies.size() * 99 / 100], latencies.back());
+    }
+    std::printf("lost %d, forged packets rejected %llu, replays dropped %llu (%d bad packets per listener)\n", lost,
+                (unsigned long long)rejected, (unsigned long long)replayed, bad_packets);
+    ok = ok && lost == 0 && rejected == std::uint64_t(listeners) * kTransitions / 2 &&
+         replayed == std::uint64_t(listeners) * kTransitions / 2;
+    ok = fresh_listener_drops_old_packet() && ok;
+    ok = listener_forgets_old_senders() && ok;
+    if (!ok) {
+        std::printf("transitions were lost, bad packets got through, or old senders were kept\n");
+    }
+    return ok ? 0 : 1;
+}
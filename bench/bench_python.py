@@ -0,0 +1,32 @@
+"""Time batch analysis of a recording through the Python bindings.
+
+Usage: PYTHONPATH=build/python python3 bench/bench_python.py <recording>
+
+Create a day of feeds with `feed_replay --synthesize day.feed`.
+"""
+import sys
+import time
+
+import alerts
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    best = None
+    for _ in range(5):
+        engine = alerts.Engine()
+        started = time.perf_counter()
+        snapshots = engine.replay(sys.argv[1])
+        transitions = memoryview(engine.transitions)
+        states = memoryview(engine.states)
+        elapsed = time.perf_counter() - started
+        best = elapsed if best is None else min(best, elapsed)
+        count, regions = transitions.shape[0], states.shape[0]
+        transitions.release()
+        states.release()
+    print(f"{snapshots} snapshots, {regions} regions, {count} transitions in {best * 1e3:.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "alerts/known_regions.h"
+#include "alerts/regions.h"
+#include "bench.h"
+
+/*
+ * Resolving the keys of a feed to region IDs: the compile-time perfect hash
+ * of the known region names, RegionRegistry::intern (which uses it), a
+ * std::unordered_map keyed by std::string as the registry used before, and
+ * a std::map searched without copying the key, which is the member lookup of
+ * a jsoncpp object value. Keys are the transliterated names, the Ukrainian
+ * ones and unknown names; every method must resolve them alike.
+ */
+
+namespace {
+
+using Keys = std::vector<std::string>;
+
+/// `count` keys drawn from `names`, in a fixed random order.
+Keys draw(const std::vector<std::string>& names, size_t count) {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pick(0, names.size() - 1);
+    Keys keys;
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(names[pick(rng)]);
+    }
+    return keys;
+}
+
+} // namespace
+
+int main() {
+    using namespace alerts;
+    const int rounds = 5;
+    const size_t lookups = 1000000;
+
+    std::vector<std::string> transliterated;
+    std::vector<std::string> ukrainian;
+    std::vector<std::string> unknown;
+    for (size_t i = 0; i < kKnownRegionCount; ++i) {
+        transliterated.push_back(known_region_name(int(i)));
+        ukrainian.push_back(known_region_name(int(i), true));
+        unknown.push_back(transliterated.back() + " 1");
+    }
+
+    // Every method maps a name to its region index, -1 for unknown names.
+    std::unordered_map<std::string, int> hashed;
+    std::map<std::string, int, std::less<>> ordered;
+    for (size_t i = 0; i < kKnownRegionCount; ++i) {
+        hashed[transliterated[i]] = hashed[ukrainian[i]] = int(i);
+        ordered[transliterated[i]] = ordered[ukrainian[i]] = int(i);
+    }
+    RegionRegistry registry;
+    for (size_t i = 0; i < kKnownRegionCount; ++i) {
+        registry.intern(transliterated[i]);
+    }
+
+    bool ok = true;
+    const struct {
+        const char* name;
+        const std::vector<std::string>& names;
+    } sets[] = {{"transliterated names", transliterated}, {"Ukrainian names", ukrainian}, {"unknown names", unknown}};
+    for (const auto& set : sets) {
+        Keys keys = draw(set.names, lookups);
+        std::printf("%s\n", set.name);
+        long perfect_sum = 0;
+        long registry_sum = 0;
+        long hashed_sum = 0;
+        long ordered_sum = 0;
+        double perfect = bench::best_of(rounds, [&] {
+            perfect_sum = 0;
+            for (const auto& key : keys) {
+                perfect_sum += find_known_region(key.data(), key.size());
+            }
+        });
+        double interned = bench::best_of(rounds, [&] {
+            RegionRegistry copy = registry; // unknown names are registered again every round
+            registry_sum = 0;
+            for (const auto& key : keys) {
+                RegionId id = copy.intern(key.data(), key.size());
+                registry_sum += id < kKnownRegionCount ? long(id) : -1;
+            }
+        });
+        double unordered = bench::best_of(rounds, [&] {
+            hashed_sum = 0;
+            for (const auto& key : keys) {
+                auto it = hashed.find(std::string(key.data(), key.size()));
+                hashed_sum += it == hashed.end() ? -1 : it->second;
+            }
+        });
+        double jsoncpp = bench::best_of(rounds, [&] {
+            ordered_sum = 0;
+            for (const auto& key : keys) {
+                auto it = ordered.find(std::string_view(key.data(), key.size()));
+                ordered_sum += it == ordered.end() ? -1 : it->second;
+            }
+        });
+        bench::report("perfect hash (find_known_region)", perfect, double(lookups));
+        bench::report("RegionRegistry::intern", interned, double(lookups));
+        bench::report("std::unordered_map<std::string>", unordered, double(lookups));
+        bench::report("std::map, as jsoncpp objects", jsoncpp, double(lookups));
+        bool same = perfect_sum == hashed_sum && perfect_sum == ordered_sum && perfect_sum == registry_sum;
+        std::printf("results %s\n\n", same ? "agree" : "DIFFER");
+        ok = ok && same;
+    }
+    return ok ? 0 : 1;
+}
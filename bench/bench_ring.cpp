@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alerts/engine.h"
+#include "alerts/event_ring.h"
+#include "alerts/queued_notifier.h"
+#include "bench.h"
+#include "synthetic_feed.h"
+
+/*
+ * The event ring between the engine and the notifier threads. First the
+ * rings alone: producers push two million event records as fast as they can
+ * and one consumer pops them, through an SpscRing, an MpscRing with one, two
+ * and four producers, and a mutex-protected std::deque for comparison; the
+ * queueing latency of every record is kept for percentiles. Then bursts from
+ * replayed data: a recording (`bench_ring recording.tsv`; a synthetic day by
+ * default) with 100 copies of every region is fed to an engine whose notifier
+ * takes a few microseconds per call, as spawning a player does, called
+ * directly and through a QueuedNotifier. Both must deliver the same
+ * transitions in the same order.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/// A std::deque behind a mutex, the usual queue between threads.
+class LockedQueue {
+public:
+    explicit LockedQueue(size_t capacity) : capacity_(capacity) {}
+
+    bool try_push(const alerts::EventRecord& record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (records_.size() >= capacity_) {
+            return false;
+        }
+        records_.push_back(record);
+        return true;
+    }
+
+    bool try_pop(alerts::EventRecord& record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (records_.empty()) {
+            return false;
+        }
+        record = records_.front();
+        records_.pop_front();
+        return true;
+    }
+
+private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::deque<alerts::EventRecord> records_;
+};
+
+struct Latencies {
+    std::vector<std::int64_t> ns;
+
+    std::int64_t percentile(double p) {
+        if (ns.empty()) {
+            return 0;
+        }
+        size_t at = std::min(ns.size() - 1, size_t(p * ns.size()));
+        std::nth_element(ns.begin(), ns.begin() + at, ns.end());
+        return ns[at];
+    }
+};
+
+void print_latencies(const char* name, Latencies& latencies) {
+    std::printf("%-40s p50 %8.1f us   p99 %8.1f us   max %9.1f us\n", name, latencies.percentile(0.5) / 1e3,
+                latencies.percentile(0.99) / 1e3, latencies.percentile(1.0) / 1e3);
+}
+
+/**
+ * @brief Pushes `count` records split among `producers` threads and pops them on this thread.
+ * @return false if a record was lost, duplicated or reordered within its producer.
+ */
+template <class Queue>
+bool run_queue(Queue& queue, int producers, size_t count, double& seconds, Latencies& latencies) {
+    latencies.ns.assign(count, 0);
+    std::vector<std::thread> threads;
+    auto started = Clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p, producers, count] {
+            alerts::EventRecord record{};
+            record.region = alerts::RegionId(p);
+            for (size_t i = p; i < count; i += producers) {
+                record.time = std::int64_t(i);
+                record.enqueued = now_ns();
+                while (!queue.try_push(record)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<std::int64_t> next(producers);
+    for (int p = 0; p < producers; ++p) {
+        next[p] = p;
+    }
+    bool ok = true;
+    alerts::EventRecord record;
+    for (size_t received = 0; received < count;) {
+        if (!queue.try_pop(record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        latencies.ns[received++] = now_ns() - record.enqueued;
+        ok = ok && record.time == next[record.region];
+        next[record.region] += producers;
+    }
+    seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return ok;
+}
+
+template <class Queue>
+bool measure_queue(const char* name, int producers, size_t count) {
+    double best = 1e300;
+    Latencies latencies;
+    bool ok = true;
+    for (int round = 0; round < 3; ++round) {
+        Queue queue(4096);
+        double seconds;
+        Latencies round_latencies;
+        ok = run_queue(queue, producers, count, seconds, round_latencies) && ok;
+        if (seconds < best) {
+            best = seconds;
+            latencies = std::move(round_latencies);
+        }
+    }
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s, %d producer%s", name, producers, producers > 1 ? "s" : "");
+    alerts::bench::report(label, best, double(count));
+    print_latencies("  queueing latency", latencies);
+    if (!ok) {
+        std::printf("  records were lost or reordered\n");
+    }
+    return ok;
+}
+
+/// A notifier that takes a while, as starting a player process does, and records what it is given.
+class SlowNotifier : public alerts::Notifier {
+public:
+    explicit SlowNotifier(std::chrono::microseconds cost) : cost_(cost) {}
+
+    void notify(const alerts::Transition& transition, const std::string& region) override {
+        auto until = Clock::now() + cost_;
+        while (Clock::now() < until) {
+        }
+        received.push_back(region + (transition.kind == alerts::TransitionKind::AlertOn ? " on " : " off ") +
+                           std::to_string(transition.time));
+    }
+
+    std::vector<std::string> received;
+
+private:
+    std::chrono::microseconds cost_;
+};
+
+/// The feed with `copies` copies of every region.
+std::vector<std::string> inflate(const std::vector<alerts::FetchResult>& feed, int copies) {
+    std::vector<std::string> bodies;
+    for (const auto& fetched : feed) {
+        std::string body = fetched.body;
+        for (int copy = 1; copy < copies; ++copy) {
+            std::string renamed = fetched.body.substr(1, fetched.body.size() - 2);
+            for (size_t at = 0; (at = renamed.find("\":", at)) != std::string::npos; at += 2) {
+                std::string suffix = " " + std::to_string(copy);
+                renamed.insert(at, suffix);
+                at += suffix.size();
+            }
+            body.insert(body.size() - 1, "," + renamed);
+        }
+        bodies.push_back(std::move(body));
+    }
+    return bodies;
+}
+
+struct Burst {
+    double feed_seconds = 0;   // time the engine spent in feed()
+    double total_seconds = 0;  // until every transition was delivered
+    double worst_feed = 0;     // the longest single feed()
+    size_t transitions = 0;
+    size_t full_waits = 0;     // pushes that found the ring full
+    Latencies latencies;       // from the engine to the notifier, queued only
+};
+
+Burst run_burst(const std::vector<alerts::FetchResult>& feed, const std::vector<std::string>& bodies,
+                std::shared_ptr<SlowNotifier> slow, bool queued) {
+    Burst burst;
+    alerts::Engine engine;
+    std::shared_ptr<alerts::QueuedNotifier> queue;
+    if (queued) {
+        queue = std::make_shared<alerts::QueuedNotifier>(slow, 4096);
+        queue->set_delivery_callback([&burst](const alerts::EventRecord& record) {
+            burst.latencies.ns.push_back(now_ns() - record.enqueued);
+        });
+        engine.add_notifier(queue);
+    } else {
+        engine.add_notifier(slow);
+    }
+    burst.latencies.ns.reserve(1 << 20);
+    auto started = Clock::now();
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        auto fed = Clock::now();
+        engine.feed(bodies[i].data(), bodies[i].size(), feed[i].time);
+        double seconds = std::chrono::duration<double>(Clock::now() - fed).count();
+        burst.feed_seconds += seconds;
+        burst.worst_feed = std::max(burst.worst_feed, seconds);
+    }
+    engine.drain(Clock::now() + std::chrono::seconds(60));
+    burst.total_seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    burst.transitions = slow->received.size();
+    if (queue) {
+        burst.full_waits = queue->stats().full_waits;
+    }
+    return burst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = 2000000;
+    bool ok = true;
+    std::printf("rings: %zu records of %zu bytes\n", count, sizeof(alerts::EventRecord));
+    ok = measure_queue<alerts::SpscRing<alerts::EventRecord>>("SpscRing", 1, count) && ok;
+    for (int producers : {1, 2, 4}) {
+        ok = measure_queue<alerts::MpscRing<alerts::EventRecord>>("MpscRing", producers, count) && ok;
+    }
+    for (int producers : {1, 4}) {
+        ok = measure_queue<LockedQueue>("mutex + std::deque", producers, count) && ok;
+    }
+
+    std::vector<alerts::FetchResult> feed;
+    if (argc > 1) {
+        if (!alerts::tools::read_recording(argv[1], feed)) {
+            std::fprintf(stderr, "cannot read %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        feed = alerts::tools::synthesize_feed(86400, 60, 1);
+    }
+    std::vector<std::string> bodies = inflate(feed, 100);
+    std::printf("\nbursts: %zu snapshots of %zu regions, notifier taking 5 us per call\n", bodies.size(),
+                size_t(2700));
+    std::vector<std::vector<std::string>> received;
+    for (bool queued : {false, true}) {
+        auto slow = std::make_shared<SlowNotifier>(std::chrono::microseconds(5));
+        Burst burst = run_burst(feed, bodies, slow, queued);
+        const char* name = queued ? "QueuedNotifier" : "direct";
+        std::printf("%-40s %zu transitions, %.0f per second delivered\n", name, burst.transitions,
+                    burst.transitions / burst.total_seconds);
+        std::printf("%-40s feed() %8.1f us/snapshot, worst %8.1f us, all delivered after %.2f s\n", "",
+                    burst.feed_seconds * 1e6 / bodies.size(), burst.worst_feed * 1e6, burst.total_seconds);
+        if (queued) {
+            print_latencies("  engine to notifier", burst.latencies);
+            std::printf("  the ring was full at %zu pushes\n", burst.full_waits);
+        }
+        received.push_back(std::move(slow->received));
+    }
+    if (received[0] != received[1]) {
+        std::printf("the queued notifier did not deliver the same transitions\n");
+        ok = false;
+    } else {
+        std::printf("results agree\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/seat.h"
+
+/*
+ * One service feeding the agents of many sessions through a local socket, as
+ * on a shared terminal. The service raises and lifts an alert in turn; every
+ * agent process applies the packets to an engine of its own and records when
+ * each transition reached its notifier. An agent that connects afterwards
+ * must raise the alert still active at once, and every agent must connect
+ * again when the service restarts. A second service may not take over the
+ * socket while the first serves it. Reports the delivery latency from the
+ * service to every agent's notifier, and exits non-zero if a transition was
+ * lost, an agent did not catch up, or the second service started.
+ *
+ * Usage: bench_seats [sessions]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kTransitions = 201; // the last one raises the alert, for the late agent
+const char kRegion[] = "Київська область";
+const auto kRetry = std::chrono::milliseconds(20);
+
+/// Records when each transition reached the agent's notifiers.
+class TimingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition& transition, const std::string&) override {
+        if (transition.time >= 0 && transition.time < kTransitions) {
+            arrived[transition.time] = Clock::now().time_since_epoch().count();
+        }
+        last = transition;
+        ++notified;
+    }
+    std::vector<Clock::rep> arrived = std::vector<Clock::rep>(kTransitions, 0);
+    alerts::Transition last;
+    int notified = 0;
+};
+
+/**
+ * @brief An agent process: connects, and after the end marker (or after five seconds) writes its arrival times,
+ * its notification count and how many times it connected to the pipe. The end marker is a heartbeat with the time
+ * kTransitions; the service sends it after restarting.
+ */
+int agent_child(const std::string& path, int result_fd) {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    engine.watch(kRegion);
+    auto timing = std::make_shared<TimingNotifier>();
+    engine.add_notifier(timing);
+    alerts::SeatAgent agent(loop, engine, path, kRetry);
+    std::string error;
+    agent.start(error); // the service may not be listening yet; the agent retries
+    alerts::EventLoop::TimerId timeout = loop.add_timer(std::chrono::seconds(5), [&loop] { loop.stop(); });
+    agent.set_packet_callback([&](const alerts::Packet& packet) {
+        if (packet.type == alerts::PacketType::Heartbeat && packet.time == kTransitions) {
+            loop.cancel_timer(timeout);
+            loop.stop();
+        }
+    });
+    loop.run();
+    std::vector<Clock::rep> result(timing->arrived);
+    result.push_back(timing->notified);
+    result.push_back(Clock::rep(agent.stats().connects));
+    (void)!write(result_fd, result.data(), result.size() * sizeof(Clock::rep));
+    return 0;
+}
+
+/**
+ * @brief An agent that connects once the alert is active: writes how long after its start the alert was raised
+ * in its session, or -1.
+ */
+int late_agent_child(const std::string& path, int result_fd) {
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    engine.watch(kRegion);
+    auto timing = std::make_shared<TimingNotifier>();
+    engine.add_notifier(timing);
+    Clock::time_point started = Clock::now();
+    Clock::rep raised = -1;
+    alerts::SeatAgent agent(loop, engine, path, kRetry);
+    agent.set_packet_callback([&](const alerts::Packet&) {
+        if (timing->notified > 0 && raised < 0 && timing->last.kind == alerts::TransitionKind::AlertOn) {
+            raised = (Clock::now() - started).count();
+            loop.stop();
+        }
+    });
+    std::string error;
+    if (!agent.start(error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+    }
+    loop.add_timer(std::chrono::seconds(2), [&loop] { loop.stop(); });
+    loop.run();
+    (void)!write(result_fd, &raised, sizeof(raised));
+    return 0;
+}
+
+bool read_all(int fd, void* data, std::size_t size) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = read(fd, out, size);
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= std::size_t(n);
+    }
+    return true;
+}
+
+pid_t spawn(int (*child)(const std::string&, int), const std::string& path, int& result_fd) {
+    int result[2];
+    if (pipe(result) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(result[0]);
+        _exit(child(path, result[1]));
+    }
+    close(result[1]);
+    result_fd = result[0];
+    return pid;
+}
+
+/// Binds a socket at a path and closes it without removing it, as a service that crashed. @return false on failure.
+bool leave_stale(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    bool bound = fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && listen(fd, 1) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    return bound;
+}
+
+/// Runs the loop until the condition holds, or for at most five seconds. @return the condition.
+template <typename Condition>
+bool run_until(alerts::EventLoop& loop, Condition condition) {
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (!condition() && Clock::now() < deadline) {
+        loop.add_timer(std::chrono::milliseconds(1), [&loop] { loop.stop(); });
+        loop.run();
+    }
+    return condition();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int sessions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 16;
+    std::string path = "/tmp/bench_seats." + std::to_string(getpid()) + ".sock";
+    std::vector<pid_t> children;
+    std::vector<int> results;
+    for (int i = 0; i < sessions; ++i) {
+        int fd = -1;
+        children.push_back(spawn(agent_child, path, fd));
+        results.push_back(fd);
+    }
+
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    alerts::SeatServer seats(loop, engine, path);
+    std::string error;
+    if (!seats.start(error)) {
+        std::printf("%s\n", error.c_str());
+        return 1;
+    }
+    bool ok = run_until(loop, [&] { return seats.sessions() == std::size_t(sessions); });
+    if (!ok) {
+        std::printf("only %zu of %d agents connected\n", seats.sessions(), sessions);
+    }
+    std::vector<Clock::rep> sent(kTransitions);
+    for (int i = 0; ok && i < kTransitions; ++i) {
+        sent[i] = Clock::now().time_since_epoch().count();
+        engine.apply_reading(kRegion, i % 2 == 0 ? alerts::Status::Full : alerts::Status::Null, i);
+        seats.publish(engine, i);
+        // Spaced out as alerts are; this also lets the agents run on a single core.
+        poll(nullptr, 0, 1);
+    }
+
+    // A session that logs in now, and the service restarting under the sessions already there.
+    int late_fd = -1;
+    pid_t late = spawn(late_agent_child, path, late_fd);
+    Clock::rep raised = -1;
+    run_until(loop, [late_fd] {
+        pollfd done{late_fd, POLLIN, 0};
+        return poll(&done, 1, 0) > 0;
+    });
+    ok = read_all(late_fd, &raised, sizeof(raised)) && ok;
+    waitpid(late, nullptr, 0);
+    // A second service must leave the socket of the running one alone, but take over a socket nobody serves.
+    alerts::SeatServer rival(loop, engine, path);
+    bool refused = !rival.start(error);
+    std::string stale = path + ".stale";
+    alerts::SeatServer successor(loop, engine, stale);
+    bool replaced = leave_stale(stale) && successor.start(error);
+    successor.stop();
+    seats.stop();
+    Clock::time_point restarted = Clock::now();
+    ok = seats.start(error) && ok;
+    bool reconnected = run_until(loop, [&] { return seats.sessions() == std::size_t(sessions); });
+    double reconnect_ms = std::chrono::duration<double, std::milli>(Clock::now() - restarted).count();
+    alerts::Packet end;
+    end.time = kTransitions;
+    seats.send(end);
+
+    std::vector<double> latencies;
+    int lost = 0;
+    int connects = 0;
+    for (int i = 0; i < sessions; ++i) {
+        std::vector<Clock::rep> result(kTransitions + 2);
+        int status = 0;
+        bool got = read_all(results[i], result.data(), result.size() * sizeof(Clock::rep));
+        waitpid(children[i], &status, 0);
+        if (!got || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+            continue;
+        }
+        for (int j = 0; j < kTransitions; ++j) {
+            if (result[j] == 0) {
+                ++lost;
+            } else {
+                Clock::duration latency(result[j] - sent[j]);
+                latencies.push_back(std::chrono::duration<double, std::micro>(latency).count());
+            }
+        }
+        ok = ok && result[kTransitions] == kTransitions;
+        connects += int(result[kTransitions + 1]);
+    }
+    unlink(path.c_str());
+
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        std::printf("%d sessions, %d transitions each, one source: service to notifier p50 %.1f us, p99 %.1f us, "
+                    "max %.1f us\n",
+                    sessions, kTransitions, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100],
+                    latencies.back());
+    }
+    std::printf("lost %d, hung agents dropped %llu\n", lost, (unsigned long long)seats.stats().dropped);
+    if (raised >= 0) {
+        std::printf("late session: active alert raised %.2f ms after the agent started\n",
+                    std::chrono::duration<double, std::milli>(Clock::duration(raised)).count());
+    } else {
+        std::printf("late session: the active alert was not raised\n");
+    }
+    std::printf("service restart: %s in %.1f ms (retry every %lld ms), %d connections in all\n",
+                reconnected ? "all agents back" : "agents missing", reconnect_ms, (long long)kRetry.count(), connects);
+    std::printf("second service: %s on a served socket, %s a stale one\n", refused ? "refused" : "STARTED",
+                replaced ? "replaced" : "DID NOT REPLACE");
+    ok = ok && lost == 0 && raised >= 0 && reconnected && connects == 2 * sessions && refused && replaced;
+    if (!ok) {
+        std::printf("transitions were lost, an agent did not catch up, or a second service took over the socket\n");
+    }
+    return ok ? 0 : 1;
+}
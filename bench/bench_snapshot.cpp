@@ -0,0 +1,151 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "alerts/binary_snapshot.h"
+#include "alerts/engine.h"
+#include "bench.h"
+#include "synthetic_feed.h"
+
+/*
+ * Encoding and decoding the state of the full region set as a binary
+ * snapshot compared with the upstream's JSON, for the real 27 regions and for
+ * an inflated set of 2700. Decoding means validating the block and converting
+ * it to a snapshot of the reader's registry; validation alone is what a reader
+ * that uses the records in place pays.
+ */
+
+namespace {
+
+/// The state of an engine in the upstream's JSON form.
+void encode_json(const alerts::Engine& engine, std::string& out) {
+    out = "{";
+    for (size_t id = 0; id < engine.regions().size(); ++id) {
+        alerts::RegionId region = alerts::RegionId(id);
+        alerts::Status status = engine.state().status(region);
+        out += id ? ",\"" : "\"";
+        out += engine.regions().name(region);
+        out += "\":";
+        if (status == alerts::Status::Null) {
+            out += "null";
+        } else {
+            out += "\"";
+            out += alerts::status_name(status);
+            out += "\"";
+        }
+    }
+    out += "}";
+}
+
+/// An engine that has applied a day of the synthetic feed, with `copies` copies of every region.
+void prepare(alerts::Engine& engine, int copies) {
+    for (const auto& snapshot : alerts::tools::synthesize_feed(86400, 60, 1)) {
+        std::string body = snapshot.body;
+        for (int copy = 1; copy < copies; ++copy) {
+            std::string renamed = snapshot.body.substr(1, snapshot.body.size() - 2);
+            for (size_t at = 0; (at = renamed.find("\":", at)) != std::string::npos; at += 2) {
+                std::string suffix = " " + std::to_string(copy);
+                renamed.insert(at, suffix);
+                at += suffix.size();
+            }
+            body.insert(body.size() - 1, "," + renamed);
+        }
+        engine.feed(body.data(), body.size(), snapshot.time);
+    }
+}
+
+/// A region name longer than a record holds must be flagged, and left out when read rather than registered cut.
+bool long_name_left_out() {
+    alerts::Engine engine;
+    const std::string name = "Автономна Республіка Крим, Севастопольська міська рада";
+    engine.watch(name);
+    engine.watch("Lviv");
+    std::string block;
+    std::size_t truncated = alerts::encode_binary_snapshot(engine.regions(), engine.state(), 0, 1, block);
+    alerts::BinarySnapshotView view;
+    std::string error;
+    alerts::RegionRegistry regions;
+    alerts::Snapshot snapshot;
+    bool valid = view.validate(block.data(), block.size(), error);
+    if (valid) {
+        view.read(regions, snapshot);
+    }
+    bool ok = valid && truncated == 1 && view.name_truncated(0) && !view.name_truncated(1) &&
+              snapshot.readings.size() == 1 && regions.size() == 1 && regions.name(0) == "Lviv";
+    std::printf("region name over %zu bytes: %s\n\n", sizeof(alerts::BinaryRegionRecord::name),
+                ok ? "flagged and left out" : "MISREAD");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    using namespace alerts;
+    const int rounds = 5;
+    const int operations = 2000;
+    bool ok = long_name_left_out();
+
+    for (int copies : {1, 100}) {
+        Engine engine;
+        prepare(engine, copies);
+        std::printf("%zu regions\n", engine.regions().size());
+
+        std::string json;
+        std::string block;
+        double json_encode = bench::best_of(rounds, [&] {
+            for (int i = 0; i < operations; ++i) {
+                encode_json(engine, json);
+                bench::do_not_optimize(json.data());
+            }
+        });
+        double binary_encode = bench::best_of(rounds, [&] {
+            for (int i = 0; i < operations; ++i) {
+                encode_binary_snapshot(engine.regions(), engine.state(), 0, std::uint64_t(i), block);
+                bench::do_not_optimize(block.data());
+            }
+        });
+
+        RegionRegistry json_regions;
+        Snapshot json_snapshot;
+        FeedDecoder decoder;
+        double json_decode = bench::best_of(rounds, [&] {
+            for (int i = 0; i < operations; ++i) {
+                decoder.decode(json.data(), json.size(), json_regions, json_snapshot);
+            }
+        });
+        RegionRegistry binary_regions;
+        Snapshot binary_snapshot;
+        BinarySnapshotView view;
+        std::string error;
+        bool valid = true;
+        double binary_decode = bench::best_of(rounds, [&] {
+            for (int i = 0; i < operations; ++i) {
+                valid = view.validate(block.data(), block.size(), error) && valid;
+                view.read(binary_regions, binary_snapshot);
+            }
+        });
+        double binary_validate = bench::best_of(rounds, [&] {
+            for (int i = 0; i < operations; ++i) {
+                valid = view.validate(block.data(), block.size(), error) && valid;
+                bench::do_not_optimize(view.header().sequence);
+            }
+        });
+
+        std::printf("%-40s %12zu bytes\n", "JSON", json.size());
+        std::printf("%-40s %12zu bytes\n", "binary snapshot", block.size());
+        bench::report("encode JSON", json_encode, operations);
+        bench::report("encode binary snapshot", binary_encode, operations);
+        bench::report("decode JSON (FeedDecoder)", json_decode, operations);
+        bench::report("decode binary snapshot", binary_decode, operations);
+        bench::report("validate binary snapshot (in place)", binary_validate, operations);
+
+        // Both readers registered the regions in the writer's order; their readings must agree.
+        bool same = valid && json_snapshot.readings.size() == binary_snapshot.readings.size();
+        for (size_t i = 0; same && i < json_snapshot.readings.size(); ++i) {
+            same = json_snapshot.readings[i].region == binary_snapshot.readings[i].region &&
+                   json_snapshot.readings[i].status == binary_snapshot.readings[i].status;
+        }
+        std::printf("decoded snapshots %s\n\n", same ? "agree" : "DIFFER");
+        ok = ok && same;
+    }
+    return ok ? 0 : 1;
+}
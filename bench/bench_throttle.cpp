@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "alerts/feed_source.h"
+#include "alerts/rate_limiter.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * How an HttpFeedSource handles an upstream that throttles it, against a stub
+ * server scripted to answer 429, 503 and 404:
+ *
+ *   - 429 without Retry-After, again and again: the pause doubles from 5 s up
+ *     to 5 min, and a successful fetch starts it over;
+ *   - 503 with Retry-After: the pause is the time asked for, and fetches
+ *     made during it send no request;
+ *   - 404: the fetch fails, but nothing is paused;
+ *   - a source on another host, sharing the rate limiter, is never paused.
+ *
+ * The other host is the same server reached as "localhost". Pauses are read
+ * from next_fetch_allowed() and lifted rather than waited out, except one
+ * short Retry-After. Exits non-zero if a pause is off by more than a second.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// The pause a source is in now, in seconds; 0 if it may fetch.
+double pause(const alerts::HttpFeedSource& source) {
+    return std::max(0.0, std::chrono::duration<double>(source.next_fetch_allowed() - Clock::now()).count());
+}
+
+/// Prints one check. @return whether the pause is within a second below the expected one.
+bool check(const char* name, double seconds, double expected) {
+    bool ok = seconds <= expected + 0.01 && seconds > expected - 1;
+    std::printf("%-44s pause %6.2f s, expected %4.0f s%s\n", name, seconds, expected, ok ? "" : "  MISMATCH");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    alerts::FetchResult snapshot;
+    alerts::tools::SyntheticFeed(60, 1).next(snapshot);
+    alerts::tools::StubServer server(snapshot.body);
+    std::string url = server.url();
+    alerts::RateLimiter limiter; // unlimited, so only the upstream's pauses hold fetches back
+    alerts::HttpFeedSource source(url, limiter);
+    alerts::HttpFeedSource mirror("http://localhost:" + url.substr(url.rfind(':') + 1), limiter);
+    alerts::FetchResult result;
+    alerts::FetchResult mirrored;
+    bool ok = source.fetch(result) && mirror.fetch(mirrored);
+
+    // 429 without Retry-After, until the backoff reaches its cap.
+    const double schedule[] = {5, 10, 20, 40, 80, 160, 300, 300};
+    for (double expected : schedule) {
+        server.script(429);
+        ok = !source.fetch(result) && ok;
+        ok = check("429, no Retry-After:", pause(source), expected) && ok;
+        ok = check("  other host:", pause(mirror), 0) && ok;
+        limiter.resume();
+    }
+    ok = source.fetch(result) && ok;
+    server.script(429);
+    ok = !source.fetch(result) && ok;
+    ok = check("429 after a successful fetch:", pause(source), 5) && ok;
+    limiter.resume();
+
+    // 503 with Retry-After: nothing is sent to the host until it is over, but the other host is still polled.
+    server.script(503, "Retry-After: 120\r\n");
+    ok = !source.fetch(result) && ok;
+    ok = check("503, Retry-After: 120:", pause(source), 120) && ok;
+    std::size_t requests = server.requests();
+    bool skipped = !source.fetch(result) && server.requests() == requests;
+    bool polled = mirror.fetch(mirrored) && server.requests() == requests + 1;
+    std::printf("%-44s %s, other host %s\n", "  fetch while paused:", skipped ? "no request" : "REQUEST SENT",
+                polled ? "polled" : "NOT POLLED");
+    ok = ok && skipped && polled;
+    limiter.resume();
+
+    server.script(503, "Retry-After: 1\r\n");
+    ok = !source.fetch(result) && ok;
+    Clock::time_point paused = Clock::now();
+    std::this_thread::sleep_until(source.next_fetch_allowed());
+    bool resumed = source.fetch(result);
+    std::printf("%-44s fetched again after %.2f s\n", "503, Retry-After: 1, waited out:",
+                std::chrono::duration<double>(Clock::now() - paused).count());
+    ok = ok && resumed;
+
+    // 404 is an error, not throttling.
+    server.script(404, {}, "not found");
+    bool failed = !source.fetch(result) && result.body.empty();
+    ok = check("404:", pause(source), 0) && ok;
+    ok = ok && failed && source.fetch(result);
+
+    std::printf("server: %zu requests\n", server.requests());
+    if (!ok) {
+        std::printf("the source did not pause as the upstream asked\n");
+    }
+    return ok ? 0 : 1;
+}
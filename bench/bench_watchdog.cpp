@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "alerts/event_loop.h"
+#include "alerts/watchdog.h"
+
+/*
+ * Watchdog detection times. The event loop is blocked on purpose, and the
+ * time until the watchdog reports the hang is compared with its documented
+ * bound (the hang timeout plus one check interval). A datagram socket stands
+ * in for systemd's NOTIFY_SOCKET: WATCHDOG=1 pings must stop while the loop
+ * is hung. Stale-data detection is timed the same way. Exits non-zero if a
+ * bound is exceeded.
+ */
+
+namespace {
+
+using Clock = alerts::Watchdog::Clock;
+using std::chrono::milliseconds;
+
+const Clock::duration kHangTimeout = milliseconds(400);
+const Clock::duration kStaleAfter = milliseconds(500);
+const Clock::duration kSlack = milliseconds(50); // scheduling delay allowed on a loaded machine
+
+double ms(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// Receives the service manager notifications and remembers when each WATCHDOG=1 ping arrived.
+class FakeServiceManager {
+public:
+    FakeServiceManager() : path_("/tmp/bench_watchdog." + std::to_string(getpid()) + ".sock") {
+        fd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        path_.copy(address.sun_path, sizeof(address.sun_path) - 1);
+        unlink(path_.c_str());
+        bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        timeval timeout = {0, 100000};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setenv("NOTIFY_SOCKET", path_.c_str(), 1);
+        setenv("WATCHDOG_USEC", "1000000", 1);
+        receiver_ = std::thread([this] {
+            char buffer[256];
+            while (!stopping_) {
+                ssize_t size = recv(fd_, buffer, sizeof(buffer), 0);
+                if (size > 0 && std::string(buffer, size) == "WATCHDOG=1") {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    pings_.push_back(Clock::now());
+                }
+            }
+        });
+    }
+
+    ~FakeServiceManager() {
+        stopping_ = true;
+        receiver_.join();
+        close(fd_);
+        unlink(path_.c_str());
+    }
+
+    /// Counts the pings received in [from, to).
+    size_t pings_between(Clock::time_point from, Clock::time_point to) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::count_if(pings_.begin(), pings_.end(), [&](Clock::time_point t) { return t >= from && t < to; });
+    }
+
+    size_t pings() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pings_.size();
+    }
+
+private:
+    std::string path_;
+    int fd_;
+    std::thread receiver_;
+    std::atomic<bool> stopping_{false};
+    std::mutex mutex_;
+    std::vector<Clock::time_point> pings_;
+};
+
+/// Blocks the loop for twice the hang timeout and returns how long the watchdog took to report it.
+bool hang_round(FakeServiceManager& manager, Clock::duration& detection, size_t& late_pings) {
+    alerts::EventLoop loop;
+    alerts::Watchdog watchdog(loop, kHangTimeout, std::chrono::hours(1));
+    std::atomic<Clock::rep> detected{0};
+    watchdog.set_hang_callback([&](Clock::duration) { detected = Clock::now().time_since_epoch().count(); });
+    Clock::time_point blocked;
+    Clock::time_point unblocked;
+    watchdog.start();
+    loop.add_timer(milliseconds(300), [&] {
+        blocked = Clock::now();
+        std::this_thread::sleep_for(kHangTimeout * 2);
+        unblocked = Clock::now();
+        loop.stop();
+    });
+    loop.run();
+    watchdog.stop();
+    if (!detected) {
+        return false;
+    }
+    Clock::time_point detected_at{Clock::duration(detected.load())};
+    detection = detected_at - blocked;
+    late_pings = manager.pings_between(detected_at, unblocked);
+    return true;
+}
+
+/// Feeds no data, then some, and returns how long the watchdog took to report the data stale and fresh.
+bool stale_round(Clock::duration& stale_detection, Clock::duration& fresh_detection) {
+    alerts::EventLoop loop;
+    alerts::Watchdog watchdog(loop, kHangTimeout, kStaleAfter);
+    Clock::time_point started = Clock::now();
+    Clock::time_point resumed;
+    bool reported_stale = false;
+    bool reported_fresh = false;
+    watchdog.set_stale_callback([&](bool stale, Clock::duration) {
+        if (stale) {
+            reported_stale = true;
+            stale_detection = Clock::now() - started - kStaleAfter;
+            loop.add_timer(milliseconds(100), [&] {
+                resumed = Clock::now();
+                watchdog.data_received();
+            });
+        } else {
+            reported_fresh = true;
+            fresh_detection = Clock::now() - resumed;
+            loop.stop();
+        }
+    });
+    loop.add_timer(kStaleAfter * 4, [&] { loop.stop(); });
+    watchdog.start();
+    loop.run();
+    watchdog.stop();
+    return reported_stale && reported_fresh;
+}
+
+} // namespace
+
+int main() {
+    FakeServiceManager manager;
+    bool ok = true;
+
+    alerts::EventLoop probe_loop;
+    Clock::duration check_interval = alerts::Watchdog(probe_loop, kHangTimeout, kStaleAfter).check_interval();
+    Clock::duration bound = kHangTimeout + check_interval + kSlack;
+    Clock::duration worst(0);
+    Clock::duration best = Clock::duration::max();
+    size_t late_pings = 0;
+    const int rounds = 5;
+    for (int i = 0; i < rounds; ++i) {
+        Clock::duration detection;
+        size_t late = 0;
+        if (!hang_round(manager, detection, late)) {
+            std::printf("FAIL: hang not detected\n");
+            return 1;
+        }
+        worst = std::max(worst, detection);
+        best = std::min(best, detection);
+        late_pings += late;
+    }
+    std::printf("hang timeout %.0f ms, check interval %.0f ms\n", ms(kHangTimeout), ms(check_interval));
+    std::printf("%-40s %8.1f .. %8.1f ms (bound %.0f ms)\n", "hung loop detected after", ms(best), ms(worst), ms(bound));
+    std::printf("%-40s %8zu (%zu after detection)\n", "service manager pings", manager.pings(), late_pings);
+    if (worst > bound) {
+        std::printf("FAIL: hang detection exceeded its bound\n");
+        ok = false;
+    }
+    if (late_pings) {
+        std::printf("FAIL: the watchdog kept pinging the service manager while the loop was hung\n");
+        ok = false;
+    }
+
+    Clock::duration stale_detection;
+    Clock::duration fresh_detection;
+    if (!stale_round(stale_detection, fresh_detection)) {
+        std::printf("FAIL: stale data not reported\n");
+        return 1;
+    }
+    std::printf("%-40s %8.1f ms after the stale timeout\n", "stale data reported", ms(stale_detection));
+    std::printf("%-40s %8.1f ms after fresh data\n", "fresh data reported", ms(fresh_detection));
+    if (stale_detection > check_interval + kSlack || fresh_detection > check_interval + kSlack) {
+        std::printf("FAIL: stale data detection exceeded one check interval\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
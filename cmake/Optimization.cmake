@@ -0,0 +1,53 @@
+# Optimisation settings shared by every target: LTO, profile-guided
+# optimisation stages and reproducible-build flags.
+
+include(CheckIPOSupported)
+
+if(ALERTS_LTO)
+    check_ipo_supported(RESULT ALERTS_LTO_SUPPORTED OUTPUT ALERTS_LTO_ERROR LANGUAGES CXX)
+    if(NOT ALERTS_LTO_SUPPORTED)
+        message(WARNING "LTO requested but not supported: ${ALERTS_LTO_ERROR}")
+    endif()
+endif()
+
+string(TOLOWER "${ALERTS_PGO}" ALERTS_PGO)
+set(ALERTS_PGO_FLAGS "")
+if(ALERTS_PGO STREQUAL "generate")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        set(ALERTS_PGO_FLAGS -fprofile-generate -fprofile-update=atomic)
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set(ALERTS_PGO_FLAGS -fprofile-generate=${CMAKE_BINARY_DIR}/pgo-data)
+    else()
+        message(FATAL_ERROR "ALERTS_PGO is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+elseif(ALERTS_PGO STREQUAL "use")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        set(ALERTS_PGO_FLAGS -fprofile-use -fprofile-correction -Wno-missing-profile)
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        set(ALERTS_PGO_FLAGS -fprofile-use=${CMAKE_BINARY_DIR}/pgo-data/default.profdata
+                             -Wno-profile-instr-unprofiled)
+    else()
+        message(FATAL_ERROR "ALERTS_PGO is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+elseif(NOT ALERTS_PGO STREQUAL "off")
+    message(FATAL_ERROR "ALERTS_PGO must be one of: off, generate, use")
+endif()
+
+# alerts_optimize(<target>)
+# Applies the project-wide optimisation policy to a target.
+function(alerts_optimize target)
+    if(ALERTS_LTO AND ALERTS_LTO_SUPPORTED)
+        set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    endif()
+    if(ALERTS_NATIVE)
+        target_compile_options(${target} PRIVATE -march=native)
+    endif()
+    if(ALERTS_PGO_FLAGS)
+        target_compile_options(${target} PRIVATE ${ALERTS_PGO_FLAGS})
+        target_link_options(${target} PRIVATE ${ALERTS_PGO_FLAGS})
+    endif()
+    # Keep absolute source paths out of the binary so builds are reproducible.
+    target_compile_options(${target} PRIVATE
+        -ffile-prefix-map=${CMAKE_SOURCE_DIR}=.
+        -ffile-prefix-map=${CMAKE_BINARY_DIR}=build)
+endfunction()
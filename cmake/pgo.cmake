@@ -0,0 +1,46 @@
+# Profile-guided build pipeline, run as `cmake -P`:
+#   1. configure and build instrumented binaries (ALERTS_PGO=generate)
+#   2. replay a deterministic synthetic day of feeds to collect a profile
+#   3. reconfigure the same tree with ALERTS_PGO=use and rebuild
+# The same build tree is reused so object paths, and therefore profile file
+# names, match between the two stages.
+
+foreach(var SOURCE_DIR BUILD_DIR BUILD_TYPE LTO)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "pgo.cmake: ${var} is not set")
+    endif()
+endforeach()
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Command failed (${result}): ${ARGN}")
+    endif()
+endfunction()
+
+set(common -S ${SOURCE_DIR} -B ${BUILD_DIR} -DCMAKE_BUILD_TYPE=${BUILD_TYPE} -DALERTS_LTO=${LTO})
+
+message(STATUS "[pgo] instrument")
+file(GLOB_RECURSE stale_profiles "${BUILD_DIR}/*.gcda")
+if(stale_profiles)
+    file(REMOVE ${stale_profiles})
+endif()
+file(REMOVE_RECURSE "${BUILD_DIR}/pgo-data")
+run(${CMAKE_COMMAND} ${common} -DALERTS_PGO=generate)
+run(${CMAKE_COMMAND} --build ${BUILD_DIR})
+
+message(STATUS "[pgo] replay-run")
+set(training_feed "${BUILD_DIR}/training.feed")
+run(${BUILD_DIR}/feed_replay --synthesize ${training_feed} --seconds 604800 --interval 15 --seed 1)
+run(${BUILD_DIR}/feed_replay ${training_feed} --repeat 3)
+
+file(GLOB clang_profiles "${BUILD_DIR}/pgo-data/*.profraw")
+if(clang_profiles)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    run(${LLVM_PROFDATA} merge -o ${BUILD_DIR}/pgo-data/default.profdata ${clang_profiles})
+endif()
+
+message(STATUS "[pgo] optimise")
+run(${CMAKE_COMMAND} ${common} -DALERTS_PGO=use)
+run(${CMAKE_COMMAND} --build ${BUILD_DIR})
+message(STATUS "[pgo] profile-guided binaries are in ${BUILD_DIR}")
@@ -0,0 +1,115 @@
+#ifndef ALERTS_ACK_TRACKER_H
+#define ALERTS_ACK_TRACKER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "alerts/event_loop.h"
+#include "alerts/notifier.h"
+
+namespace alerts {
+
+/**
+ * @brief Repeats the notification of a raised alert until someone acknowledges it.
+ *
+ * Every raised alert opens an event for its region, and the tracker passes the transition on to its target (the
+ * siren). Until the event is acknowledged, or the alert is lifted, the target is notified again on a timer of
+ * the event loop; every repeat comes sooner than the one before, halving the delay from repeat_after down to
+ * shortest_repeat. No thread is started for the repeats. The time from the alert to its acknowledgement is
+ * recorded for drills.
+ *
+ * The engine must be fed on the loop thread, which calls notify() and drain(); acknowledge() can be called
+ * from any thread, such as a UI thread.
+ */
+class AckTracker : public Notifier {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        Clock::duration repeat_after = std::chrono::seconds(60); ///< delay of the first repeat
+        Clock::duration shortest_repeat = std::chrono::seconds(15); ///< the delay stops halving here
+        unsigned max_repeats = 0; ///< repeats of one event before giving up; 0 for no limit
+    };
+
+    /// Counters over every event so far.
+    struct Stats {
+        std::uint64_t raised = 0;       ///< events opened
+        std::uint64_t acknowledged = 0;
+        std::uint64_t lifted = 0;       ///< events closed by the end of the alert before anyone acknowledged them
+        std::uint64_t repeats = 0;      ///< notifications repeated
+        Clock::duration total_latency{}; ///< sum of the acknowledgement latencies
+        Clock::duration max_latency{};
+
+        double mean_seconds() const {
+            return acknowledged ? std::chrono::duration<double>(total_latency).count() / acknowledged : 0.0;
+        }
+
+        /// One line for the log: events, acknowledgements, repeats and latency.
+        std::string summary() const;
+    };
+
+    /// Receives the acknowledged transition, the acknowledgement latency and the repeats it took.
+    using AckCallback = std::function<void(const Transition&, Clock::duration, unsigned)>;
+
+    /**
+     * @param loop The loop that runs the repeat timers.
+     * @param target The notifier to repeat, and to pass every transition to.
+     */
+    AckTracker(EventLoop& loop, std::shared_ptr<Notifier> target, Options options);
+    AckTracker(EventLoop& loop, std::shared_ptr<Notifier> target) : AckTracker(loop, std::move(target), Options()) {}
+    ~AckTracker() override;
+    AckTracker(const AckTracker&) = delete;
+    AckTracker& operator=(const AckTracker&) = delete;
+
+    void notify(const Transition& transition, const std::string& region) override;
+    void data_stale(bool stale, std::chrono::seconds age) override;
+
+    /// Stops the repeats and drains the target.
+    bool drain(std::chrono::steady_clock::time_point deadline) override;
+
+    /**
+     * @brief Acknowledges the event of a raised alert, identified by the transition that raised it.
+     * An alert that has been lifted, or acknowledged already, is ignored. Thread-safe; the event is closed
+     * on the loop thread.
+     */
+    void acknowledge(const Transition& transition);
+
+    /// Called on the loop thread for every acknowledged event.
+    void set_ack_callback(AckCallback callback) { on_ack_ = std::move(callback); }
+
+    Stats stats() const;
+
+    /// Events waiting for an acknowledgement.
+    std::size_t open() const;
+
+private:
+    struct Event {
+        Transition transition;
+        std::string region;
+        Clock::time_point raised;
+        Clock::duration delay; // until the next repeat
+        unsigned repeats = 0;
+        EventLoop::TimerId timer = 0;
+    };
+
+    void repeat(RegionId region);
+    void close(RegionId region, bool acknowledged);
+
+    EventLoop& loop_;
+    std::shared_ptr<Notifier> target_;
+    Options options_;
+    AckCallback on_ack_;
+    std::unordered_map<RegionId, Event> events_; // open events by region, on the loop thread only
+    std::shared_ptr<AckTracker*> self_;          // lets posted acknowledgements outlive the tracker safely
+    mutable std::mutex mutex_;
+    Stats stats_;
+    std::size_t open_ = 0;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_ACK_TRACKER_H
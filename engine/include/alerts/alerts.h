@@ -0,0 +1,118 @@
+/*
+ * C interface of the alerts detection engine (libalerts).
+ *
+ * The ABI is stable: handles are opaque, structures passed to callbacks only
+ * ever grow at the end, and enumerators keep their values. No thread is
+ * created unless alerts_engine_start_polling() is called.
+ */
+#ifndef ALERTS_ALERTS_H
+#define ALERTS_ALERTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(ALERTS_BUILDING_LIBRARY)
+#define ALERTS_API __attribute__((visibility("default")))
+#else
+#define ALERTS_API
+#endif
+
+/** Version of this interface; incremented when functions or structure fields are added. */
+#define ALERTS_API_VERSION 1
+
+/** Region status, as published by the data source. */
+enum alerts_status {
+    ALERTS_STATUS_NULL = 0,
+    ALERTS_STATUS_NO_DATA = 1,
+    ALERTS_STATUS_PARTIAL = 2,
+    ALERTS_STATUS_FULL = 3,
+    ALERTS_STATUS_UNKNOWN = 4
+};
+
+/** Direction of a transition. */
+enum alerts_transition_kind {
+    ALERTS_ALERT_OFF = 0,
+    ALERTS_ALERT_ON = 1
+};
+
+/** An alert state change, valid only for the duration of the callback. */
+typedef struct alerts_transition {
+    const char* region;  /**< region name, NUL-terminated */
+    uint16_t region_id;  /**< region ID within the engine */
+    uint8_t kind;        /**< enum alerts_transition_kind */
+    uint8_t status;      /**< enum alerts_status that caused the change */
+    int64_t time;        /**< Unix time of the snapshot */
+} alerts_transition;
+
+typedef struct alerts_engine alerts_engine;
+
+/**
+ * Called for every transition of a watched region, on the thread that fed the
+ * engine (or the polling thread), once the feed is over. No lock is held, so
+ * the callback may query the engine and call alerts_engine_set_callback().
+ */
+typedef void (*alerts_transition_cb)(const alerts_transition* transition, void* user_data);
+
+/** Returns ALERTS_API_VERSION of the library actually loaded. */
+ALERTS_API unsigned alerts_api_version(void);
+
+/** Creates an engine. Returns NULL if out of memory. */
+ALERTS_API alerts_engine* alerts_engine_create(void);
+
+/** Stops polling, if started, and frees the engine. NULL is ignored. */
+ALERTS_API void alerts_engine_destroy(alerts_engine* engine);
+
+/**
+ * Restricts callbacks to a region; call once per region. Without any watched
+ * region every region is reported. Thread-safe. Returns 0, or -1 on error or
+ * while the engine is polling.
+ */
+ALERTS_API int alerts_engine_watch(alerts_engine* engine, const char* region);
+
+/**
+ * Sets (or, with NULL, clears) the transition callback. Thread-safe; the
+ * transitions of a feed already in progress still go to the previous callback.
+ */
+ALERTS_API void alerts_engine_set_callback(alerts_engine* engine, alerts_transition_cb callback, void* user_data);
+
+/**
+ * Processes one raw response body of the data source. Thread-safe: feeds from
+ * several threads are applied one at a time, and each calls the callback for
+ * its own transitions. Returns the number of transitions reported to the
+ * callback, or -1 if the body could not be decoded or the engine is polling
+ * on its own thread.
+ */
+ALERTS_API int alerts_engine_feed(alerts_engine* engine, const char* data, size_t size, int64_t time);
+
+/**
+ * Returns the last reported status of a region (enum alerts_status), or
+ * ALERTS_STATUS_UNKNOWN if the region has not been reported. Thread-safe:
+ * while the engine is polling, state may be queried from any thread.
+ */
+ALERTS_API int alerts_engine_status(const alerts_engine* engine, const char* region);
+
+/** Returns 1 if an alert is raised in a region, 0 otherwise. Thread-safe. */
+ALERTS_API int alerts_engine_alert_active(const alerts_engine* engine, const char* region);
+
+/**
+ * Starts a background thread that fetches url every interval_seconds and
+ * feeds the engine; callbacks are then called on that thread.
+ * Returns 0, or -1 if already polling or the arguments are invalid.
+ */
+ALERTS_API int alerts_engine_start_polling(alerts_engine* engine, const char* url, int interval_seconds);
+
+/**
+ * Stops the polling thread, aborting a fetch in progress, and joins it. Does
+ * nothing if not polling. Must not be called from the callback.
+ */
+ALERTS_API void alerts_engine_stop_polling(alerts_engine* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ALERTS_ALERTS_H */
@@ -0,0 +1,103 @@
+#ifndef ALERTS_ARENA_H
+#define ALERTS_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief A bump allocator for data that lives for one poll cycle: allocation moves a pointer, nothing is freed
+ * on its own, and reset() releases everything at once.
+ *
+ * Memory is kept across resets. When a cycle needed more than one chunk, reset() replaces them with a single
+ * chunk that holds all of it, so a steady workload stops touching the heap after its first cycles. An arena
+ * is not thread-safe.
+ */
+class Arena {
+public:
+    /// @param chunk_size The size of the first chunk; later chunks are at least twice as large as the last.
+    explicit Arena(std::size_t chunk_size = 4096);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Returns uninitialised memory, valid until the next reset().
+     * @param alignment A power of two, at most alignof(std::max_align_t).
+     */
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        std::size_t at = (used_ + alignment - 1) & ~(alignment - 1);
+        if (at + size > size_) {
+            return allocate_slow(size, alignment);
+        }
+        used_ = at + size;
+        return data_ + at;
+    }
+
+    /// Room for `count` objects of type T, not constructed.
+    template <class T>
+    T* allocate_array(std::size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /// Releases everything allocated since the last reset.
+    void reset();
+
+    /// Bytes handed out since the last reset, including alignment padding.
+    std::size_t used() const { return retired_ + used_; }
+
+    /// Bytes held, in all chunks.
+    std::size_t capacity() const;
+
+    /// Chunks taken from the heap since the arena was created.
+    std::size_t heap_allocations() const { return heap_allocations_; }
+
+private:
+    void* allocate_slow(std::size_t size, std::size_t alignment);
+    void add_chunk(std::size_t size);
+
+    std::vector<char*> chunks_;  // the current chunk is the last
+    std::vector<std::size_t> chunk_sizes_;
+    char* data_ = nullptr;       // the current chunk
+    std::size_t size_ = 0;
+    std::size_t used_ = 0;
+    std::size_t retired_ = 0;    // bytes used in the earlier chunks of this cycle
+    std::size_t heap_allocations_ = 0;
+};
+
+/**
+ * @brief A standard allocator that takes memory from an Arena, for containers that live for one cycle.
+ * Deallocation is a no-op; memory returns to the arena when it is reset.
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(std::size_t count) { return arena_->allocate_array<T>(count); }
+    void deallocate(T*, std::size_t) {}
+
+    Arena* arena() const { return arena_; }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+    Arena* arena_;
+};
+
+/// A vector in an arena.
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace alerts
+
+#endif // ALERTS_ARENA_H
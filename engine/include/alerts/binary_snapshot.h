@@ -0,0 +1,147 @@
+#ifndef ALERTS_BINARY_SNAPSHOT_H
+#define ALERTS_BINARY_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "alerts/regions.h"
+#include "alerts/snapshot.h"
+#include "alerts/state_store.h"
+
+namespace alerts {
+
+/**
+ * @brief Header of a binary snapshot: the state of every region in one fixed-layout block of memory, for
+ * handing over to other processes by memcpy, a pipe or a shared file that readers mmap.
+ *
+ * A snapshot is this 64-byte header followed by region_count records of 64 bytes, record i describing region
+ * ID i of the writer. Fields are naturally aligned and in the writer's byte order (little endian on every
+ * platform we build for), so the block is read in place. Readers check the magic, byte order, format version,
+ * sizes and the total length (see BinarySnapshotView::validate), which is O(1); an unknown format version is
+ * refused rather than guessed.
+ */
+struct BinarySnapshotHeader {
+    char magic[4];                ///< "ALSS"
+    std::uint32_t byte_order;     ///< kBinarySnapshotByteOrder as written, so a foreign byte order is detected
+    std::uint16_t version;        ///< kBinarySnapshotVersion
+    std::uint16_t header_size;    ///< sizeof(BinarySnapshotHeader)
+    std::uint16_t record_size;    ///< sizeof(BinaryRegionRecord)
+    std::uint16_t name_capacity;  ///< bytes available for a region name
+    std::uint32_t region_count;
+    std::uint32_t reserved0;
+    std::int64_t time;            ///< Unix time of the last snapshot applied
+    std::uint64_t sequence;       ///< incremented by the writer for every snapshot it writes
+    std::uint8_t reserved[24];
+};
+
+/// One region of a binary snapshot.
+struct BinaryRegionRecord {
+    std::int64_t changed_at;     ///< Unix time the status last changed; 0 if unknown
+    std::uint8_t status;         ///< a Status value
+    std::uint8_t alert_active;   ///< 0 or 1
+    std::uint8_t name_size;      ///< bytes of name in use; longer names are cut at a UTF-8 character boundary
+    std::uint8_t flags;          ///< kBinaryNameTruncated if the name was cut
+    std::uint8_t reserved[4];
+    char name[48];               ///< UTF-8, not NUL-terminated when it fills the field
+};
+
+static_assert(sizeof(BinarySnapshotHeader) == 64, "binary snapshot header layout");
+static_assert(sizeof(BinaryRegionRecord) == 64, "binary snapshot record layout");
+
+const std::uint32_t kBinarySnapshotByteOrder = 0x01020304;
+const std::uint16_t kBinarySnapshotVersion = 2; // 2: BinaryRegionRecord::flags
+
+/// BinaryRegionRecord::flags: the region's name is longer than the record holds, and only its start is kept.
+const std::uint8_t kBinaryNameTruncated = 1;
+
+/**
+ * @brief Writes the state of every region as a binary snapshot.
+ * @param regions The region names.
+ * @param state The statuses, alert flags and change times.
+ * @param time The Unix time of the last snapshot applied.
+ * @param sequence The writer's snapshot counter.
+ * @param out Receives the block; it is resized, so its buffer is reused from one call to the next.
+ * @return The number of region names that did not fit in their records; those records are flagged
+ * kBinaryNameTruncated.
+ */
+std::size_t encode_binary_snapshot(const RegionRegistry& regions, const StateStore& state, std::int64_t time,
+                            std::uint64_t sequence, std::string& out);
+
+/**
+ * @brief Writes a binary snapshot to a file atomically (a temporary file renamed over it), so that readers
+ * which map the file always see a whole snapshot.
+ * @return false and sets error on failure.
+ */
+bool write_binary_snapshot_file(const std::string& path, const std::string& block, std::string& error);
+
+/**
+ * @brief A validated binary snapshot, read in place from memory the caller keeps alive.
+ */
+class BinarySnapshotView {
+public:
+    BinarySnapshotView() = default;
+
+    /**
+     * @brief Checks a block in O(1) and points the view at it.
+     * @param data The block; it must be 8-byte aligned, as malloc, std::string storage and mmap give.
+     * @param size The block length.
+     * @param error Receives the reason when the block is refused.
+     * @return false if the block is not a binary snapshot this version can read.
+     */
+    bool validate(const void* data, std::size_t size, std::string& error);
+
+    const BinarySnapshotHeader& header() const { return *header_; }
+    std::size_t size() const { return header_ ? header_->region_count : 0; }
+    const BinaryRegionRecord& record(std::size_t index) const { return records_[index]; }
+
+    /// The name of a region, as far as it fits in its record.
+    std::string name(std::size_t index) const;
+
+    /// Whether name() is only the start of the region's name.
+    bool name_truncated(std::size_t index) const { return records_[index].flags & kBinaryNameTruncated; }
+
+    /// The status of a region; values from a newer writer read as Status::Unknown.
+    Status status(std::size_t index) const;
+
+    /**
+     * @brief Converts the records to a snapshot of the reader's registry, for an engine to apply.
+     * @param regions Region names are resolved to IDs, and new names registered, here.
+     * @param snapshot Receives one reading per region; its time is the snapshot's. A region whose name was cut
+     * is left out, since its cut name would be registered as another region.
+     */
+    void read(RegionRegistry& regions, Snapshot& snapshot) const;
+
+private:
+    const BinarySnapshotHeader* header_ = nullptr;
+    const BinaryRegionRecord* records_ = nullptr;
+};
+
+/**
+ * @brief A binary snapshot file mapped read-only into memory.
+ */
+class MappedBinarySnapshot {
+public:
+    MappedBinarySnapshot() = default;
+    ~MappedBinarySnapshot();
+    MappedBinarySnapshot(const MappedBinarySnapshot&) = delete;
+    MappedBinarySnapshot& operator=(const MappedBinarySnapshot&) = delete;
+
+    /**
+     * @brief Maps a file and validates it, replacing the previous mapping.
+     * @return false and sets error if the file cannot be mapped or is not a valid snapshot.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    const BinarySnapshotView& view() const { return view_; }
+
+private:
+    void unmap();
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    BinarySnapshotView view_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_BINARY_SNAPSHOT_H
@@ -0,0 +1,42 @@
+#ifndef ALERTS_CONFIG_H
+#define ALERTS_CONFIG_H
+
+#include <string>
+
+namespace alerts {
+
+/// Monitor settings, as read from config.json.
+struct Config {
+    std::string region;       ///< the region to monitor
+    std::string alert_on;     ///< sound played when an alert is raised
+    std::string alert_off;    ///< sound played when an alert is lifted
+    std::string data_url;     ///< the data source URL
+    int update_interval = 60; ///< seconds between checks
+    std::string state_file;   ///< where the alert state is kept across restarts; empty to disable
+    std::string snapshot_file; ///< binary snapshot rewritten after every poll, for other processes; empty to disable
+    int drain_timeout = 5;    ///< seconds allowed for pending notifications at shutdown
+    int stale_after = 0;      ///< seconds without a good snapshot before the data is stale; 3 intervals if 0
+    int watchdog_timeout = 60; ///< seconds the event loop may be unresponsive before the process is aborted
+    int max_requests_per_minute = 0; ///< process-wide limit on requests to the data source; 0 for none
+    int upstream_period = 0;  ///< seconds between the data source's own updates; update_interval if 0
+    int repeat_after = 60;    ///< seconds before an unacknowledged alert sounds again; 0 to sound it once
+    std::string multicast;    ///< "group:port" where instances on the LAN exchange transitions; empty to disable
+    std::string multicast_key; ///< the shared secret that signs them
+    std::string multicast_role = "publish"; ///< "publish": poll and broadcast; "listen": take the broadcast instead;
+                                            ///< "elect": poll and broadcast only while elected leader
+    std::string leader_lease; ///< with "elect": a lock file shared by the instances on a host; empty for the LAN
+    std::string seat_socket;  ///< the socket by which alert_headless, as a service, feeds alert_system in every session
+};
+
+/**
+ * @brief Reads the monitor settings from a JSON configuration file.
+ * @param path The configuration file path.
+ * @param config Receives the settings. Missing fields keep their defaults.
+ * @param error Receives a description of the problem when the function fails.
+ * @return true if the file was read and parsed.
+ */
+bool load_config(const std::string& path, Config& config, std::string& error);
+
+} // namespace alerts
+
+#endif // ALERTS_CONFIG_H
@@ -0,0 +1,133 @@
+#ifndef ALERTS_DBUS_MESSAGE_H
+#define ALERTS_DBUS_MESSAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * The D-Bus wire format, as far as a notification client and a stand-in bus need it: building and parsing
+ * messages with the basic types (y, b, u, i, s, o, g), arrays, structs, dict entries and variants. A message
+ * is a 16-byte fixed header, an array of (code, variant) header fields padded to 8 bytes, and the body; every
+ * value is aligned to its size from the start of the message. Messages are written in the host's byte order
+ * and read in either.
+ */
+
+namespace alerts {
+
+/// Message types.
+enum class DBusType : std::uint8_t {
+    Invalid = 0,
+    MethodCall = 1,
+    MethodReturn = 2,
+    Error = 3,
+    Signal = 4,
+};
+
+/// The header of a message; empty strings and 0 mean the field is absent.
+struct DBusHeader {
+    DBusType type = DBusType::Invalid;
+    std::uint8_t flags = 0;
+    std::uint32_t serial = 0;
+    std::uint32_t reply_serial = 0;
+    std::string path;
+    std::string interface;
+    std::string member;
+    std::string error_name;
+    std::string destination;
+    std::string sender;
+    std::string signature; ///< of the body
+
+    std::size_t body_at = 0;   ///< where the body starts in the message
+    std::size_t body_size = 0;
+    bool swap = false;         ///< whether the message is in the other byte order than the host's
+};
+
+/// An array being written: where its length goes and where its elements start.
+struct DBusArray {
+    std::size_t length_at;
+    std::size_t start;
+};
+
+/**
+ * @brief Builds one message in a reused buffer: start(), the body values in signature order, then finish().
+ */
+class DBusWriter {
+public:
+    /// Starts a message and writes its header fields; the body length is filled in by finish().
+    void start(const DBusHeader& header);
+
+    void put_byte(std::uint8_t value);
+    void put_bool(bool value) { put_uint32(value ? 1 : 0); }
+    void put_uint32(std::uint32_t value);
+    void put_int32(std::int32_t value) { put_uint32(std::uint32_t(value)); }
+    /// A string or object path.
+    void put_string(const char* data, std::size_t size);
+    void put_string(const std::string& value) { put_string(value.data(), value.size()); }
+    void put_signature(const char* signature);
+
+    /// Opens an array whose elements are aligned to `alignment` (8 for structs and dict entries).
+    DBusArray open_array(std::size_t alignment);
+    /// Closes an array, filling in its length.
+    void close_array(const DBusArray& array);
+    /// Starts a struct or dict entry.
+    void open_struct() { align(8); }
+    /// Starts a variant holding one value of a single complete type; write the value next.
+    void put_variant(const char* signature) { put_signature(signature); }
+
+    /// Fills in the body length. @return The whole message.
+    const std::string& finish();
+
+private:
+    void align(std::size_t alignment);
+    void put_field(std::uint8_t code, const char* signature, const std::string& value);
+    void put_field(std::uint8_t code, std::uint32_t value);
+
+    std::string out_;
+    std::size_t body_at_ = 0;
+};
+
+/**
+ * @brief Parses the header of the message at the start of a buffer.
+ * @param length Receives the whole length of the message, or 0 if the buffer does not hold all of it yet.
+ * @return false if the data is not a valid message.
+ */
+bool parse_dbus_header(const char* data, std::size_t size, DBusHeader& header, std::size_t& length);
+
+/**
+ * @brief Reads the values of a message body, in signature order. Every getter returns false, and later ones
+ * too, past the end of the body.
+ */
+class DBusReader {
+public:
+    /// @param message The whole message, as parsed by parse_dbus_header().
+    DBusReader(const char* message, const DBusHeader& header)
+        : data_(message), at_(header.body_at), end_(header.body_at + header.body_size), swap_(header.swap) {}
+
+    bool get_byte(std::uint8_t& value);
+    bool get_uint32(std::uint32_t& value);
+    bool get_int32(std::int32_t& value);
+    /// A string or object path.
+    bool get_string(std::string& value);
+    bool get_signature(std::string& value);
+    /// Reads an array's length and moves to its first element, aligned to `alignment`.
+    bool get_array_size(std::size_t alignment, std::uint32_t& size);
+    /// Moves to the start of a struct or dict entry.
+    bool open_struct() { return align(8); }
+    /// Skips bytes, such as a whole array.
+    bool skip(std::size_t size);
+
+    std::size_t position() const { return at_; }
+
+private:
+    bool align(std::size_t alignment);
+
+    const char* data_;
+    std::size_t at_;
+    std::size_t end_;
+    bool swap_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_DBUS_MESSAGE_H
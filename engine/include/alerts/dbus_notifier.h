@@ -0,0 +1,116 @@
+#ifndef ALERTS_DBUS_NOTIFIER_H
+#define ALERTS_DBUS_NOTIFIER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include "alerts/dbus_message.h"
+#include "alerts/event_loop.h"
+#include "alerts/notifier.h"
+
+namespace alerts {
+
+/**
+ * @brief Shows desktop notifications through the freedesktop Notifications service, over D-Bus.
+ *
+ * The notifier speaks the D-Bus protocol on the session bus socket itself, so it needs neither libdbus nor
+ * a toolkit. It keeps one connection for its lifetime; each transition costs one Notify call, written
+ * without waiting for the reply. Replies are picked up before the next call. Each region has a notification
+ * of its own, whose ID is sent as replaces_id with the region's next transition, so an alert that is lifted
+ * replaces the notification that announced it instead of stacking a new one, and leaves the other regions'
+ * notifications alone. Raised alerts are sent with critical urgency. Stale data is announced by a
+ * notification of its own, replaced when the data is fresh again.
+ *
+ * With an acknowledgement callback, raised alerts carry an action to acknowledge them, and the notifier
+ * listens for the service's signals: a click on a notification or its action, or its dismissal by the
+ * user, acknowledges the alert that notification shows.
+ */
+class DBusNotifier : public Notifier {
+public:
+    /**
+     * @param app_name The application name shown with the notifications.
+     * @param address The bus address; empty for the session bus (DBUS_SESSION_BUS_ADDRESS, or
+     * $XDG_RUNTIME_DIR/bus). Only unix:path= and unix:abstract= addresses are supported.
+     */
+    explicit DBusNotifier(std::string app_name, std::string address = "");
+    ~DBusNotifier() override;
+    DBusNotifier(const DBusNotifier&) = delete;
+    DBusNotifier& operator=(const DBusNotifier&) = delete;
+
+    /**
+     * @brief Connects and registers on the bus, waiting for the bus to answer. notify() connects by itself
+     * when needed; calling this first tells whether there is a bus at all.
+     * @return false and sets error if there is no bus to talk to.
+     */
+    bool connect(std::string& error);
+
+    /**
+     * @brief Called when the user acknowledges a notification of a raised alert, with the transition that
+     * raised it. Set before connecting. The callback runs with the notifier locked and must not call it.
+     */
+    void set_ack_callback(std::function<void(const Transition&)> callback) { on_ack_ = std::move(callback); }
+
+    /**
+     * @brief Reads the bus whenever it has something to say, on the loop's thread, so that acknowledgements
+     * arrive without waiting for the next notification. Call before connecting; notify() must then be called
+     * on the loop thread as well.
+     */
+    void attach(EventLoop& loop) { loop_ = &loop; }
+
+    void notify(const Transition& transition, const std::string& region) override;
+    void data_stale(bool stale, std::chrono::seconds age) override;
+
+    /// Waits for the replies to the notifications sent, so that none is lost at exit.
+    bool drain(std::chrono::steady_clock::time_point deadline) override;
+
+    /// Notify calls written to the bus so far.
+    std::uint64_t sent() const;
+
+    /// The ID of the last notification the service acknowledged; 0 before the first reply.
+    std::uint32_t last_id() const;
+
+private:
+    /// What a Notify call shows: a region's transition, or the data's staleness.
+    struct Call {
+        Transition transition{};
+        bool stale = false;
+    };
+
+    bool connect_locked(std::string& error);
+    void disconnect();
+    bool send(const std::string& message);
+    bool read_replies(int timeout_ms);
+    void handle(const char* message);
+    void handle_signal(const char* message);
+    void send_notify(const Call& call, bool urgent, const char* icon);
+
+    std::string app_name_;
+    std::string address_;
+    std::function<void(const Transition&)> on_ack_;
+    EventLoop* loop_ = nullptr;
+    mutable std::mutex mutex_;
+    int fd_ = -1;
+    std::uint32_t next_serial_ = 1;
+    std::uint32_t awaited_serial_ = 0;  // of the last call whose reply has not been read
+    std::string error_name_;            // of the last error reply to an awaited call
+    std::uint32_t last_id_ = 0;
+    std::map<RegionId, std::uint32_t> ids_;          // of the notification showing each region
+    std::map<std::uint32_t, Transition> shown_;      // the transition each of those notifications shows
+    std::map<std::uint32_t, Call> unanswered_;       // by the serial of a Notify call whose reply is not read
+    std::uint32_t stale_id_ = 0;                     // of the notification about stale data
+    std::uint64_t sent_ = 0;
+    bool reported_ = false;             // whether a failure has been logged since the last success
+    DBusWriter writer_;
+    DBusHeader call_;                   // of the Notify calls; only the serial changes
+    DBusHeader reply_;                  // of the message being handled
+    std::string input_;                 // bytes received and not yet handled
+    std::string title_;
+    std::string message_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_DBUS_NOTIFIER_H
@@ -0,0 +1,125 @@
+#ifndef ALERTS_DELTA_FEED_H
+#define ALERTS_DELTA_FEED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "alerts/arena.h"
+#include "alerts/regions.h"
+#include "alerts/snapshot.h"
+
+/*
+ * The delta feed: a compact binary protocol between a central fetcher (a proxy that polls the upstream once)
+ * and many local clients. A client names the last snapshot version it has applied, and the proxy answers
+ * with the region entries that changed since then, or with nothing but a header when none did.
+ *
+ * Requests carry the cursor in an HTTP header, "Alerts-Since: <epoch>.<version>", and advertise the format with
+ * "Accept: application/x-alerts-delta". A response body is, with unsigned LEB128 varints:
+ *
+ *   "ALD1"                       magic and format version
+ *   u32 epoch (little endian)    changes whenever the proxy restarts, so stale cursors are detected
+ *   varint base                  the version the delta applies to; 0 for a full snapshot
+ *   varint version               the version the client has after applying it
+ *   varint first, varint count   names of the regions first..first+count-1, each a varint length and UTF-8
+ *   varint count                 then count entries, in increasing region order:
+ *   varint (gap << 3 | status)   gap = region - previous region - 1 (the first entry counts from -1)
+ *
+ * Regions are numbered by the proxy in order of first appearance, and their names are only sent once per
+ * client. An unchanged feed costs about 15 bytes, and a typical update a few bytes per changed region.
+ */
+
+namespace alerts {
+
+/// Media type of delta feed responses.
+extern const char* const kDeltaContentType;
+
+/// A position in a proxy's sequence of snapshots.
+struct DeltaCursor {
+    std::uint32_t epoch = 0;
+    std::uint64_t version = 0; ///< 0 before anything was applied
+
+    /// The "Alerts-Since" header value.
+    std::string to_string() const;
+
+    /**
+     * @brief Parses an "Alerts-Since" header value.
+     * @return false, leaving the cursor at version 0, if the text is malformed.
+     */
+    bool parse(const std::string& text);
+};
+
+/**
+ * @brief The proxy side: keeps the latest status of every region, with the version at which it last changed,
+ * and encodes the answer to any client's cursor in one pass over the regions. No history of snapshots is kept.
+ */
+class DeltaPublisher {
+public:
+    /// Starts a new epoch, so the cursors of a previous instance are answered with a full snapshot.
+    DeltaPublisher();
+
+    /**
+     * @brief Publishes a decoded snapshot; the version only advances if some status changed.
+     * @param snapshot Readings with IDs from regions. Regions missing from it keep their status.
+     * @param regions The registry the IDs come from; new names are taken from it.
+     */
+    void publish(const Snapshot& snapshot, const RegionRegistry& regions);
+
+    /// The cursor of the latest published snapshot.
+    DeltaCursor cursor() const { return {epoch_, version_}; }
+
+    /**
+     * @brief Encodes the answer to a client: the changes since its cursor, or everything if the cursor is
+     * from another epoch or unknown.
+     * @param since The client's cursor; a default cursor asks for a full snapshot.
+     * @param out Receives the body.
+     */
+    void encode(const DeltaCursor& since, std::string& out) const;
+
+private:
+    std::uint32_t epoch_;
+    std::uint64_t version_ = 1;
+    std::vector<std::string> names_;       // indexed by region ID
+    std::vector<std::uint64_t> named_at_;  // version at which each name was first published
+    std::vector<Status> statuses_;
+    std::vector<std::uint64_t> changed_at_; // version at which each status last changed
+};
+
+/**
+ * @brief The client side: applies delta feed bodies, producing snapshots of the changed regions only, which
+ * StateStore applies as it does full ones. FeedDecoder hands delta bodies to one of these.
+ */
+class DeltaDecoder {
+public:
+    /// Whether a body is in the delta format (rather than JSON).
+    static bool is_delta(const char* data, std::size_t size);
+
+    /**
+     * @brief Checks a whole body without applying it.
+     * @param cursor Receives the cursor the client has once the body is applied.
+     * @return false if the body is malformed.
+     */
+    static bool validate(const char* data, std::size_t size, DeltaCursor& cursor);
+
+    /**
+     * @brief Applies one body.
+     * @param regions Region names are resolved to IDs, and new names registered, here.
+     * @param snapshot Receives the readings of the regions that changed. Its time is left unchanged.
+     * @param arena Holds the parsed body while it is applied; without one, an internal arena is used.
+     * @return false if the body is malformed or is a delta from another cursor; nothing is applied then.
+     */
+    bool decode(const char* data, std::size_t size, RegionRegistry& regions, Snapshot& snapshot,
+                Arena* arena = nullptr);
+
+    /// The cursor to send with the next request.
+    DeltaCursor cursor() const { return cursor_; }
+
+private:
+    DeltaCursor cursor_;
+    std::vector<RegionId> ids_; // the proxy's region numbers, mapped to IDs of the client's registry
+    Arena scratch_{1024};
+};
+
+} // namespace alerts
+
+#endif // ALERTS_DELTA_FEED_H
@@ -0,0 +1,97 @@
+#ifndef ALERTS_DNS_CACHE_H
+#define ALERTS_DNS_CACHE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief Resolves the hosts of the data sources in the background and keeps their addresses, so that a fetch
+ * never waits for DNS.
+ *
+ * Hosts are resolved as soon as they are watched and again every refresh interval, on a thread of the cache.
+ * A failed refresh keeps the previous addresses. HTTP sources pin the cached list into curl, which tries the
+ * addresses in order; the address that last answered is moved to the front, so failover sticks.
+ *
+ * getaddrinfo() cannot be interrupted, so the thread is detached and shares the cache's state: destroying the cache
+ * waits for it at most kStopTimeout, and a thread still resolving then exits when its call returns.
+ */
+class DnsCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// How long the destructor waits for the resolver thread.
+    static constexpr std::chrono::milliseconds kStopTimeout{1000};
+
+    /// Counters over every background resolution.
+    struct Stats {
+        std::uint64_t resolutions = 0; ///< getaddrinfo() calls
+        std::uint64_t failures = 0;    ///< calls that returned no address
+        double total_seconds = 0;      ///< time spent resolving
+        double max_seconds = 0;        ///< slowest resolution
+
+        double mean_seconds() const { return resolutions ? total_seconds / resolutions : 0.0; }
+
+        /// One line for the log, e.g. "3 resolutions, 0 failed, mean 41.2 ms, max 95.0 ms".
+        std::string summary() const;
+    };
+
+    /// The cache shared by the whole process; its thread starts with the first watch().
+    static DnsCache& shared();
+
+    explicit DnsCache(std::chrono::seconds refresh_interval = std::chrono::seconds(300));
+    ~DnsCache();
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    /// Starts resolving a host in the background and keeping it fresh. Thread-safe.
+    void watch(const std::string& host, int port);
+
+    /**
+     * @brief The cached addresses of a host, preferred first. Thread-safe.
+     * @param generation Receives a number that changes whenever the list changes.
+     * @return An empty list if the host has not been resolved yet.
+     */
+    std::vector<std::string> addresses(const std::string& host, int port, std::uint64_t& generation) const;
+
+    /// Moves an address to the front of a host's list, after it has answered. Thread-safe.
+    void prefer(const std::string& host, int port, const std::string& address);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string host;
+        int port;
+        std::vector<std::string> addresses;
+        std::uint64_t generation = 0;
+        Clock::time_point next_refresh;
+    };
+
+    /// What the cache and its thread share; the thread keeps it alive if it outlives the cache.
+    struct State {
+        std::chrono::seconds refresh_interval;
+        std::mutex mutex;
+        std::condition_variable wakeup; ///< new entries and stopping, for the thread; its exit, for the cache
+        std::vector<Entry> entries;
+        Stats stats;
+        bool running = false;
+        bool stopping = false;
+
+        Entry* find(const std::string& host, int port);
+    };
+
+    static void run(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_DNS_CACHE_H
@@ -0,0 +1,133 @@
+#ifndef ALERTS_ENGINE_H
+#define ALERTS_ENGINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "alerts/arena.h"
+#include "alerts/feed_decoder.h"
+#include "alerts/feed_source.h"
+#include "alerts/notifier.h"
+#include "alerts/regions.h"
+#include "alerts/state_store.h"
+
+namespace alerts {
+
+/**
+ * @brief The detection engine: decodes feed responses, tracks region state and dispatches transitions.
+ * Engines share no state, so any number of them can run in one process. An engine is not
+ * thread-safe; feed it from one thread at a time.
+ */
+class Engine {
+public:
+    Engine() = default;
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    /**
+     * @brief Restricts notifications to a region. Without any watched region, all regions are notified.
+     */
+    void watch(const std::string& region);
+
+    /// Adds a notifier; notifiers are called in the order they were added.
+    void add_notifier(std::shared_ptr<Notifier> notifier);
+
+    /**
+     * @brief Processes one raw response of the data source.
+     * @param data The response body.
+     * @param size The body length.
+     * @param time The Unix time of the response.
+     * @return false if the body could not be decoded; the state is then unchanged.
+     */
+    bool feed(const char* data, std::size_t size, std::int64_t time);
+
+    /**
+     * @brief Applies the status of one region as reported by another instance, as if a snapshot had reported
+     * it. Transitions are derived and dispatched as in feed(), so a reading that changes nothing, such as a
+     * duplicate, notifies nothing.
+     * @return true if the alert state of the region changed.
+     */
+    bool apply_reading(const std::string& region, Status status, std::int64_t time);
+
+    /**
+     * @brief Fetches one response from a source and processes it.
+     * @return false if nothing could be fetched or decoded.
+     */
+    bool poll(FeedSource& source);
+
+    /// The delta feed cursor of the bodies fed so far, for the next request; see FeedSource::set_delta_cursor().
+    DeltaCursor delta_cursor() const { return decoder_.delta_cursor(); }
+
+    /**
+     * @brief Tells every notifier that the data has become stale, or fresh again. See Notifier::data_stale().
+     */
+    void report_stale(bool stale, std::chrono::seconds age);
+
+    /**
+     * @brief Waits for every notifier to deliver what it has been handed, for a clean shutdown.
+     * @param deadline When to give up.
+     * @return false if some notifier did not finish in time.
+     */
+    bool drain(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Writes the status and alert state of every region to a file, atomically.
+     * A restarted monitor that loads it does not raise again an alert that was already raised.
+     * @return false and sets error on failure.
+     */
+    bool save_state(const std::string& path, std::string& error) const;
+
+    /**
+     * @brief Writes the state of every region as a binary snapshot file (see binary_snapshot.h), atomically,
+     * for other processes to map.
+     * @return false and sets error on failure.
+     */
+    bool save_binary_snapshot(const std::string& path, std::string& error);
+
+    /**
+     * @brief Restores the state written by save_state().
+     * @return false and sets error if the file exists but cannot be read; a missing file is not an error.
+     */
+    bool load_state(const std::string& path, std::string& error);
+
+    const RegionRegistry& regions() const { return regions_; }
+    const StateStore& state() const { return state_; }
+
+    /// The memory of the current poll cycle, reset at the start of every feed().
+    const Arena& cycle_arena() const { return arena_; }
+
+    /// The transitions of all regions produced by the last successful feed().
+    const std::vector<Transition>& transitions() const { return transitions_; }
+
+    /// Keeps the transitions of all regions in history(), for batch analysis of recorded feeds.
+    void set_keep_history(bool keep) { keep_history_ = keep; }
+
+    /// Every transition since history was enabled or last cleared, oldest first.
+    const std::vector<Transition>& history() const { return history_; }
+    void clear_history() { history_.clear(); }
+
+private:
+    bool watched(RegionId region) const;
+    void dispatch();
+
+    RegionRegistry regions_;
+    Arena arena_;                          // per-cycle memory of the decoder
+    FeedDecoder decoder_;
+    StateStore state_;
+    Snapshot snapshot_;
+    FetchResult fetched_;
+    std::string binary_snapshot_;          // reused by save_binary_snapshot()
+    std::uint64_t binary_sequence_ = 0;
+    std::vector<Transition> transitions_;
+    std::vector<Transition> history_;
+    bool keep_history_ = false;
+    std::vector<std::uint8_t> watch_mask_; // indexed by region ID; empty when everything is watched
+    std::vector<std::shared_ptr<Notifier>> notifiers_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_ENGINE_H
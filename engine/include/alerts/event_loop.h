@@ -0,0 +1,92 @@
+#ifndef ALERTS_EVENT_LOOP_H
+#define ALERTS_EVENT_LOOP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief A single-threaded event loop (epoll) with timers, descriptor watches, signals and cross-thread posting.
+ * Everything except post() and stop() must be called on the thread that runs the loop, or before it runs.
+ */
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = std::uint64_t;
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Calls a function once after a delay.
+     * @return An ID for cancel_timer(); never 0.
+     */
+    TimerId add_timer(Clock::duration delay, Callback callback) { return add_timer_at(Clock::now() + delay, std::move(callback)); }
+    TimerId add_timer_at(Clock::time_point when, Callback callback);
+
+    /// Cancels a pending timer. Unknown or expired IDs, and 0, are ignored.
+    void cancel_timer(TimerId id);
+
+    /**
+     * @brief Calls a function whenever a descriptor is ready.
+     * @param fd The descriptor; the caller keeps ownership.
+     * @param events EPOLLIN, EPOLLOUT, ...
+     * @param callback Receives the ready events.
+     * @return false if the descriptor could not be watched.
+     */
+    bool watch_fd(int fd, std::uint32_t events, std::function<void(std::uint32_t)> callback);
+    bool modify_fd(int fd, std::uint32_t events);
+    void unwatch_fd(int fd);
+
+    /**
+     * @brief Delivers signals through the loop instead of asynchronous handlers.
+     * The signals are blocked in the calling thread, so this must be called before any other thread is
+     * started: threads inherit the signal mask, and a thread with the signals unblocked would receive them.
+     * @return false on failure.
+     */
+    bool watch_signals(const std::vector<int>& signals, std::function<void(int)> callback);
+
+    /// Runs a function on the loop thread. Thread-safe.
+    void post(Callback callback);
+
+    /// Runs the loop until stop() is called.
+    void run();
+
+    /// Makes run() return after the current iteration. Thread-safe.
+    void stop();
+
+private:
+    void wake();
+    void run_posted();
+    void run_due_timers();
+    int next_timeout_ms() const;
+
+    int epoll_fd_;
+    int wake_fd_;
+    int signal_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+
+    TimerId next_timer_id_ = 1;
+    std::multimap<Clock::time_point, TimerId> timer_queue_;
+    std::unordered_map<TimerId, Callback> timers_;
+    std::unordered_map<int, std::shared_ptr<std::function<void(std::uint32_t)>>> watches_;
+    std::function<void(int)> signal_callback_;
+
+    std::mutex posted_mutex_;
+    std::vector<Callback> posted_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_EVENT_LOOP_H
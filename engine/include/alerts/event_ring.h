@@ -0,0 +1,154 @@
+#ifndef ALERTS_EVENT_RING_H
+#define ALERTS_EVENT_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace alerts {
+
+/// Keeps the indices the producer and consumer write on separate cache lines.
+const std::size_t kCacheLine = 64;
+
+/// The smallest power of two not below n (and at least 2).
+inline std::size_t ring_capacity(std::size_t n) {
+    std::size_t capacity = 2;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/**
+ * @brief A bounded lock-free queue for one producer thread and one consumer thread.
+ *
+ * Records are copied in and out of a ring of trivially copyable slots. Each side keeps a cached copy of the
+ * other side's index, so in the common case a push or pop touches no cache line written by the other thread.
+ */
+template <class T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "ring records are copied as bytes");
+
+public:
+    /// @param capacity Rounded up to a power of two.
+    explicit SpscRing(std::size_t capacity)
+        : mask_(ring_capacity(capacity) - 1), slots_(new T[mask_ + 1]) {}
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    /// Producer side. @return false if the ring is full.
+    bool try_push(const T& record) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = record;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side. @return false if the ring is empty.
+    bool try_pop(T& record) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        record = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Whether the ring looked empty; exact only on the consumer thread.
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+private:
+    const std::size_t mask_;
+    const std::unique_ptr<T[]> slots_;
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0}; // next slot to read; written by the consumer
+    std::size_t tail_cache_ = 0;                            // the consumer's copy of tail_
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0}; // next slot to write; written by the producer
+    std::size_t head_cache_ = 0;                            // the producer's copy of head_
+};
+
+/**
+ * @brief A bounded lock-free queue for any number of producer threads and one consumer thread.
+ *
+ * Every slot carries a sequence number that tells whose turn it is (Vyukov's bounded queue): producers claim
+ * a slot with one compare-and-swap on the tail, write it and publish it by bumping its sequence; the consumer
+ * waits for that sequence before reading. A producer preempted between claiming and publishing holds up the
+ * consumer at that slot, but not the other producers.
+ */
+template <class T>
+class MpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "ring records are copied as bytes");
+
+public:
+    /// @param capacity Rounded up to a power of two.
+    explicit MpscRing(std::size_t capacity)
+        : mask_(ring_capacity(capacity) - 1), slots_(new Slot[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    /// Producer side, from any thread. @return false if the ring is full.
+    bool try_push(const T& record) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[tail & mask_];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            std::intptr_t lag = std::intptr_t(sequence) - std::intptr_t(tail);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    slot.record = record;
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // the slot still holds a record from one lap ago
+            } else {
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Consumer side. @return false if the ring is empty, or its next record is not published yet.
+    bool try_pop(T& record) {
+        Slot& slot = slots_[head_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    /// Whether the next record is not available yet; exact only on the consumer thread.
+    bool empty() const { return slots_[head_ & mask_].sequence.load(std::memory_order_acquire) != head_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T record;
+    };
+
+    const std::size_t mask_;
+    const std::unique_ptr<Slot[]> slots_;
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0}; // next slot to claim; shared by the producers
+    alignas(kCacheLine) std::size_t head_ = 0;              // next slot to read; the consumer's own
+};
+
+} // namespace alerts
+
+#endif // ALERTS_EVENT_RING_H
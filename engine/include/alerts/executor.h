@@ -0,0 +1,76 @@
+#ifndef ALERTS_EXECUTOR_H
+#define ALERTS_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief A work-stealing thread pool for CPU-bound tasks, such as decoding the responses of many sources.
+ *
+ * Every worker has its own deque. Tasks submitted from outside the pool are dealt to the deques in turn;
+ * tasks submitted by a task go to its worker's deque. A worker takes its own newest task first, while it is
+ * still in cache, and a worker whose deque is empty steals the oldest task of another, so a burst that lands
+ * on one worker spreads over all of them. Idle workers sleep until a task is submitted.
+ */
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    /// @param threads The number of workers; 0 for one per core.
+    explicit Executor(std::size_t threads = 0);
+    /// Runs the tasks already submitted, then joins the workers.
+    ~Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    std::size_t threads() const { return workers_.size(); }
+
+    /// Queues a task. Thread-safe, and can be called from a task.
+    void submit(Task task);
+
+    /// Blocks until every task submitted so far, and every task they submitted, has run. Not from a task.
+    void wait_idle();
+
+    /// Counters over the pool's lifetime.
+    struct Stats {
+        std::uint64_t executed = 0; ///< tasks run
+        std::uint64_t stolen = 0;   ///< tasks run by another worker than the one they were queued on
+    };
+    Stats stats() const;
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks; // the owner works at the back, thieves take from the front
+    };
+
+    void run(std::size_t index);
+    bool take(std::size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> next_{0};     // the deque for the next task submitted from outside
+    std::atomic<std::size_t> queued_{0};   // tasks in the deques
+    std::atomic<std::size_t> pending_{0};  // tasks queued or running
+    std::atomic<std::size_t> sleepers_{0};
+    std::atomic<std::uint64_t> executed_{0};
+    std::atomic<std::uint64_t> stolen_{0};
+    std::mutex mutex_;                 // for sleeping and waking only
+    std::condition_variable work_;     // idle workers wait here
+    std::condition_variable idle_;     // wait_idle() waits here
+    bool stopping_ = false;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_EXECUTOR_H
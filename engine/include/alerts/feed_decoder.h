@@ -0,0 +1,40 @@
+#ifndef ALERTS_FEED_DECODER_H
+#define ALERTS_FEED_DECODER_H
+
+#include <cstddef>
+#include "alerts/delta_feed.h"
+#include "alerts/regions.h"
+#include "alerts/snapshot.h"
+
+namespace alerts {
+
+/**
+ * @brief Decodes the data source's JSON object ({"<region>": "<status>" | null, ...}) into a snapshot.
+ * The body is scanned in place with JsonObjectScanner; no DOM is built. Bodies in the delta feed format of a
+ * proxy (see delta_feed.h) are applied by a DeltaDecoder instead, and only carry the changed regions.
+ */
+class FeedDecoder {
+public:
+    /**
+     * @brief Decodes one response body.
+     * @param data The body. It does not need to be NUL-terminated.
+     * @param size The body length.
+     * @param regions Region names are resolved to IDs, and new names registered, here.
+     * @param snapshot Receives the readings. Its time is left unchanged.
+     * @param arena Per-cycle memory for unescaped names and parsed delta bodies, needed only while decoding;
+     * without one, the decoder's own buffers are used.
+     * @return false if the body is not a JSON object or a delta that applies; the snapshot is then empty.
+     */
+    bool decode(const char* data, std::size_t size, RegionRegistry& regions, Snapshot& snapshot,
+                Arena* arena = nullptr);
+
+    /// The delta feed cursor to send with the next request; version 0 until a delta body has been applied.
+    DeltaCursor delta_cursor() const { return delta_.cursor(); }
+
+private:
+    DeltaDecoder delta_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_FEED_DECODER_H
@@ -0,0 +1,149 @@
+#ifndef ALERTS_FEED_SOURCE_H
+#define ALERTS_FEED_SOURCE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include "alerts/delta_feed.h"
+#include "alerts/rate_limiter.h"
+
+namespace alerts {
+
+/// A raw response of a feed source.
+struct FetchResult {
+    std::string body;      ///< the response body
+    std::int64_t time = 0; ///< Unix time the body was received or recorded
+};
+
+/**
+ * @brief Where snapshots come from: the upstream API, a mirror or a recording.
+ */
+class FeedSource {
+public:
+    virtual ~FeedSource() = default;
+
+    /**
+     * @brief Retrieves the next response.
+     * @param result Receives the body and its time. The body buffer is reused, so callers
+     * should keep one FetchResult per source.
+     * @return false if nothing could be fetched.
+     */
+    virtual bool fetch(FetchResult& result) = 0;
+
+    /**
+     * @brief Starts retrieving the next response without waiting for it, for callers that poll many sources
+     * from one thread. The default fetches synchronously and calls done before returning.
+     * @param result Receives the body and its time; must stay valid until done is called.
+     * @param done Called with what fetch() would return, on whatever thread finished the fetch; it must not block.
+     */
+    virtual void fetch_async(FetchResult& result, std::function<void(bool)> done) { done(fetch(result)); }
+
+    /// A human-readable name of the source, for log messages.
+    virtual std::string describe() const = 0;
+
+    /**
+     * @brief Makes an in-flight fetch() return false as soon as possible, and every later one immediately, until
+     * reset(). Thread-safe: meant to be called from another thread when polling stops.
+     */
+    virtual void abort() {}
+
+    /// Lets fetches run again after abort(). Call when no fetch is in flight, before polling starts again.
+    virtual void reset() {}
+
+    /**
+     * @brief Sets the delta feed cursor to ask a proxy for the changes since: the one of the engine the bodies are
+     * fed to, after each body (see Engine::delta_cursor()), so a body the engine rejected is asked for again. Call
+     * when no fetch is in flight. Sources that do not speak the delta feed ignore it, the default.
+     */
+    virtual void set_delta_cursor(const DeltaCursor&) {}
+
+    /**
+     * @brief When the source will accept the next fetch(), if it is throttled (by a rate limit or by the
+     * upstream's Retry-After). A time in the past, the default, means now.
+     */
+    virtual std::chrono::steady_clock::time_point next_fetch_allowed() const { return {}; }
+};
+
+/**
+ * @brief Fetches the feed over HTTP(S) with libcurl.
+ * Transfers run on the process-wide HttpClient, so every source shares its connections and TLS sessions,
+ * and concurrent requests to one HTTP/2 host are multiplexed over a single connection. The host is resolved
+ * in the background by the process-wide DnsCache and its addresses are pinned, so fetches do not wait for DNS.
+ *
+ * Only 2xx responses are data. 429 (Too Many Requests) and 503 (Service Unavailable) pause the requests
+ * to that host and port, from every source sharing the rate limiter, for the time given by Retry-After, or
+ * for an exponential backoff (5 s doubling up to 5 min) when there is none; sources on other hosts go on.
+ * While paused, or while the token bucket is empty, fetch() fails immediately without sending a request.
+ *
+ * Requests accept the delta feed of a proxy (see delta_feed.h) and send the cursor given to set_delta_cursor();
+ * until one is given, the proxy answers with a full snapshot.
+ */
+class HttpFeedSource : public FeedSource {
+public:
+    /**
+     * @param url The feed URL; file:// URLs work too and have no status code.
+     * @param limiter The rate limiter, shared by all sources of the process by default.
+     */
+    explicit HttpFeedSource(std::string url, RateLimiter& limiter = RateLimiter::process());
+    ~HttpFeedSource() override;
+    HttpFeedSource(const HttpFeedSource&) = delete;
+    HttpFeedSource& operator=(const HttpFeedSource&) = delete;
+
+    bool fetch(FetchResult& result) override;
+    /// Runs the transfer on the HttpClient's thread and calls done there.
+    void fetch_async(FetchResult& result, std::function<void(bool)> done) override;
+    std::string describe() const override { return url_; }
+    void abort() override { aborted_ = true; }
+    void reset() override { aborted_ = false; }
+    void set_delta_cursor(const DeltaCursor& cursor) override;
+    std::chrono::steady_clock::time_point next_fetch_allowed() const override {
+        return limiter_.next_allowed(origin_);
+    }
+
+private:
+    bool begin_fetch(FetchResult& result); // false if no request may be sent now
+    bool finish_fetch(int code, FetchResult& result);
+    void pin_addresses();
+    void set_request_headers();
+
+    std::string url_;
+    void* curl_; // CURL*, kept out of the header
+    std::atomic<bool> aborted_{false};
+    std::string host_;                  // empty for URLs that are not HTTP(S)
+    int port_ = 0;
+    std::string origin_;                // host:port, or the URL if it has no host; what upstream pauses apply to
+    std::uint64_t pinned_generation_ = 0;
+    void* resolve_list_ = nullptr;      // curl_slist* of the pinned addresses
+    void* headers_ = nullptr;           // curl_slist* of the request headers
+    DeltaCursor delta_cursor_;          // sent with the requests
+    RateLimiter& limiter_;
+    std::chrono::seconds backoff_{0}; // without Retry-After, doubles with every throttled response
+    bool throttled_ = false;          // to log a pause once, not at every skipped fetch
+};
+
+/**
+ * @brief Replays a recording made of "<unix_time>\t<body>" lines.
+ */
+class ReplayFeedSource : public FeedSource {
+public:
+    explicit ReplayFeedSource(const std::string& path);
+
+    /// false if the recording could not be opened.
+    bool good() const { return bool(in_); }
+
+    /// Returns false once the recording is exhausted.
+    bool fetch(FetchResult& result) override;
+    std::string describe() const override { return path_; }
+
+private:
+    std::string path_;
+    std::ifstream in_;
+    std::string line_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_FEED_SOURCE_H
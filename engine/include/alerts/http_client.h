@@ -0,0 +1,90 @@
+#ifndef ALERTS_HTTP_CLIENT_H
+#define ALERTS_HTTP_CLIENT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief Runs the transfers of every HTTP source of the process on one curl multi handle.
+ *
+ * The multi handle owns the connection cache, so requests to the same host reuse one connection and one
+ * TLS session whichever source sends them, and concurrent requests to an HTTP/2 server are multiplexed
+ * as streams of that connection instead of opening one connection each. Transfers run on a thread of the
+ * client; callers block in perform() until theirs is done, or are called back when they start() one.
+ */
+class HttpClient {
+public:
+    /// Counters over every transfer the client has run.
+    struct Stats {
+        std::uint64_t requests = 0;        ///< completed transfers
+        std::uint64_t new_connections = 0; ///< connections opened for them
+        std::uint64_t http2 = 0;           ///< transfers that used HTTP/2
+        double total_seconds = 0;          ///< sum of the transfer times
+        double name_lookup_seconds = 0;    ///< part of it spent waiting for name resolution
+        double max_seconds = 0;            ///< slowest transfer
+
+        /// The share of transfers that did not open a connection.
+        double reuse_ratio() const { return requests ? 1.0 - double(new_connections) / requests : 0.0; }
+        double mean_seconds() const { return requests ? total_seconds / requests : 0.0; }
+
+        /// One line for the log: requests, connections, reuse ratio, latency and time waiting for DNS.
+        std::string summary() const;
+    };
+
+    /// The client shared by the whole process. Also initialises libcurl.
+    static HttpClient& shared();
+
+    HttpClient();
+    ~HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    /**
+     * @brief Runs a transfer to completion. Thread-safe; several transfers run concurrently.
+     * @param easy A configured CURL* easy handle, not in use elsewhere.
+     * @return The CURLcode of the transfer.
+     */
+    int perform(void* easy);
+
+    /**
+     * @brief Starts a transfer and returns at once. Thread-safe.
+     * @param easy A configured CURL* easy handle, not in use elsewhere until done is called.
+     * @param done Called with the CURLcode on the client's thread when the transfer ends; it must not block.
+     */
+    void start(void* easy, std::function<void(int)> done);
+
+    Stats stats() const;
+
+private:
+    struct Transfer {
+        bool done = false;
+        int result = 0;
+        std::function<void(int)> callback; // for start(); the client then owns the transfer
+    };
+
+    void finish(Transfer* transfer, int result, std::vector<Transfer*>& callbacks);
+    void run_callbacks(std::vector<Transfer*>& callbacks);
+
+    void run();
+
+    void* multi_; // CURLM*, kept out of the header
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable done_;
+    std::vector<std::pair<void*, Transfer*>> queued_;
+    std::unordered_map<void*, Transfer*> running_;
+    Stats stats_;
+    bool stopping_ = false;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_HTTP_CLIENT_H
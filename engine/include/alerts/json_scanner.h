@@ -0,0 +1,98 @@
+#ifndef ALERTS_JSON_SCANNER_H
+#define ALERTS_JSON_SCANNER_H
+
+#include <cstddef>
+#include <string>
+#include "alerts/arena.h"
+
+namespace alerts {
+
+/// Type of a JSON value found by the scanner.
+enum class JsonType {
+    String,
+    Number,
+    True,
+    False,
+    Null,
+    Nested, ///< an object or array; it is skipped, not decoded
+};
+
+/// One "key": value member of a JSON object.
+struct JsonMember {
+    const char* key;       ///< unescaped key, not NUL-terminated
+    std::size_t key_size;
+    JsonType type;
+    const char* value;     ///< unescaped string contents, or the literal text of other types
+    std::size_t value_size;
+};
+
+/// Instruction sets the scanner can use to look for the end of a string and for brackets.
+enum class SimdLevel {
+    Scalar, ///< one byte at a time
+    Sse42,  ///< 16 bytes at a time with PCMPESTRI
+    Avx2,   ///< 32 bytes at a time
+};
+
+/// The best level this CPU supports; the scanner uses it unless set_json_simd_level() was called.
+SimdLevel best_json_simd_level();
+
+/// The level the scanner currently uses.
+SimdLevel json_simd_level();
+
+/**
+ * @brief Makes the scanner use a given level, or the best supported one below it. For benchmarks and
+ * comparisons; not thread-safe with respect to scanners running at the time.
+ */
+void set_json_simd_level(SimdLevel level);
+
+/// The name of a level ("scalar", "sse4.2" or "avx2").
+const char* simd_level_name(SimdLevel level);
+
+/**
+ * @brief Iterates over the members of a JSON object without building a DOM.
+ * Keys and string values are returned as views into the input when they contain no escape sequences,
+ * and into an arena or an internal buffer otherwise; either view is valid until the next call to next(), or
+ * until the arena is reset.
+ * Nested objects and arrays are checked for balanced brackets and skipped.
+ * The ends of strings and the brackets of nested values are looked for with SSE4.2 or AVX2 when the CPU has
+ * them (selected at run time), 16 or 32 bytes at a time.
+ */
+class JsonObjectScanner {
+public:
+    /**
+     * @param data The JSON text; it must outlive the scanner.
+     * @param size The text length.
+     * @param arena Where unescaped keys and values are written, so that they stay valid until the arena is
+     * reset rather than until the next call to next(); without one, an internal buffer is used.
+     */
+    JsonObjectScanner(const char* data, std::size_t size, Arena* arena = nullptr);
+
+    /**
+     * @brief Advances to the next member.
+     * @return false at the end of the object, or on a syntax error (see failed()).
+     */
+    bool next(JsonMember& member);
+
+    /// Whether a syntax error was found. After next() returned false with no error, the object was well-formed.
+    bool failed() const { return failed_; }
+
+private:
+    bool fail();
+    void skip_whitespace();
+    bool scan_string(std::string& scratch, const char*& text, std::size_t& size);
+    bool scan_value(JsonMember& member);
+    bool skip_nested();
+
+    const char* pos_;
+    const char* end_;
+    bool started_ = false;
+    bool done_ = false;
+    bool failed_ = false;
+    Arena* arena_;
+    std::string key_scratch_;
+    std::string value_scratch_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_JSON_SCANNER_H
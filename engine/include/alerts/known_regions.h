@@ -0,0 +1,26 @@
+#ifndef ALERTS_KNOWN_REGIONS_H
+#define ALERTS_KNOWN_REGIONS_H
+
+#include <cstddef>
+
+namespace alerts {
+
+/// The number of regions the data source reports: the oblasts, Crimea, Kyiv and Sevastopol.
+const std::size_t kKnownRegionCount = 27;
+
+/**
+ * @brief Looks up a region name among the known regions, by the data source's transliterated name ("Kyiv
+ * Oblast") or the Ukrainian one in UTF-8 ("Київська область").
+ *
+ * The lookup is a perfect hash generated at compile time: the key's length and first and last eight bytes
+ * select one slot, whose name is compared with the key. Both spellings of a region give the same index.
+ * @return The index of the region (0 .. kKnownRegionCount - 1), or -1 if the name is not a known one.
+ */
+int find_known_region(const char* name, std::size_t size);
+
+/// The transliterated name of a known region, or its Ukrainian name in UTF-8.
+const char* known_region_name(int index, bool ukrainian = false);
+
+} // namespace alerts
+
+#endif // ALERTS_KNOWN_REGIONS_H
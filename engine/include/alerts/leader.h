@@ -0,0 +1,123 @@
+#ifndef ALERTS_LEADER_H
+#define ALERTS_LEADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <sys/types.h>
+#include "alerts/event_loop.h"
+#include "alerts/multicast.h"
+
+namespace alerts {
+
+/**
+ * @brief Decides which of several instances polls the data source; the others take its broadcast.
+ * Elections run on an event loop, and the callback is called on the loop thread whenever this instance
+ * becomes the leader or stops being it.
+ */
+class LeaderElection {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~LeaderElection() = default;
+
+    /// Joins the election as a follower. @return false and sets error on failure.
+    virtual bool start(std::string& error) = 0;
+
+    /// Leaves the election, giving up the leadership if this instance has it.
+    virtual void stop() = 0;
+
+    /// Takes a packet the multicast listener accepted; only heartbeat elections use them.
+    virtual void receive(const Packet& packet) { (void)packet; }
+
+    bool leader() const { return leader_; }
+
+    /// Called with true when this instance becomes the leader, and with false when it stops being it.
+    void set_callback(std::function<void(bool)> callback) { on_change_ = std::move(callback); }
+
+protected:
+    void set_leader(bool leader);
+
+private:
+    bool leader_ = false;
+    std::function<void(bool)> on_change_;
+};
+
+/**
+ * @brief An election among the instances on one host: the leader is whoever holds an exclusive lock on a
+ * file.
+ *
+ * The kernel releases the lock when its holder dies, however it dies, so there is no lease to expire. The
+ * leader writes its process ID into the file. Followers watch that process through a pidfd and try the lock
+ * as soon as it exits, so a crash is taken over within a millisecond or so; they also retry on a timer, in
+ * case the process cannot be watched (another PID namespace, or a kernel without pidfd).
+ */
+class FileLease : public LeaderElection {
+public:
+    /**
+     * @param path The lock file, created if needed; every instance on the host must use the same one.
+     * @param retry How often followers try the lock when they cannot watch the leader.
+     */
+    FileLease(EventLoop& loop, std::string path, Clock::duration retry = std::chrono::seconds(1));
+    ~FileLease() override;
+
+    bool start(std::string& error) override;
+    void stop() override;
+
+private:
+    void try_lock();
+    void watch_holder();
+    void unwatch_holder();
+
+    EventLoop& loop_;
+    std::string path_;
+    Clock::duration retry_;
+    int fd_ = -1;
+    int holder_fd_ = -1; // pidfd of the leader being watched
+    pid_t holder_ = 0;
+    EventLoop::TimerId timer_ = 0;
+};
+
+/**
+ * @brief An election among the instances on a LAN, by heartbeats on the multicast group.
+ *
+ * The leader sends a Leader packet every period. A follower that has heard none for `missed` periods, plus
+ * a random fraction of a period so that followers do not all claim at once, takes over and starts sending
+ * them itself. When two leaders hear each other, the one with the lower sender ID steps down. Failover thus
+ * takes between `missed` and `missed + 1` periods.
+ */
+class HeartbeatElection : public LeaderElection {
+public:
+    /**
+     * @param publisher Sends the heartbeats; its sender ID identifies this instance.
+     * @param period The time between two heartbeats of the leader.
+     * @param missed How many heartbeat periods without one before a follower takes over.
+     */
+    HeartbeatElection(EventLoop& loop, MulticastPublisher& publisher,
+                      Clock::duration period = std::chrono::milliseconds(500), int missed = 3);
+    ~HeartbeatElection() override;
+
+    bool start(std::string& error) override;
+    void stop() override;
+    void receive(const Packet& packet) override;
+
+private:
+    void beat();
+    void check();
+    void schedule_check();
+
+    EventLoop& loop_;
+    MulticastPublisher& publisher_;
+    Clock::duration period_;
+    int missed_;
+    bool running_ = false;
+    Clock::time_point heard_;  // the last heartbeat of another leader
+    EventLoop::TimerId timer_ = 0;
+    std::minstd_rand random_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_LEADER_H
@@ -0,0 +1,84 @@
+#ifndef ALERTS_MONITOR_H
+#define ALERTS_MONITOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/feed_source.h"
+#include "alerts/update_phase.h"
+
+namespace alerts {
+
+/**
+ * @brief Polls a feed source at a fixed interval on an event loop and feeds the engine.
+ * Fetches run on a worker thread, so the loop stays responsive (to signals, in particular) while a request
+ * is in flight; decoding and notification happen on the loop thread. Polls can be aligned to the upstream's
+ * own update cadence, so that changes are seen just after they are published.
+ */
+class Monitor {
+public:
+    /**
+     * @param loop The loop that schedules polls and runs the engine.
+     * @param engine The engine to feed; only used on the loop thread.
+     * @param source The feed source; only used on the worker thread, except for abort().
+     * @param interval The time between the starts of two polls.
+     */
+    Monitor(EventLoop& loop, Engine& engine, FeedSource& source, std::chrono::seconds interval);
+    ~Monitor();
+    Monitor(const Monitor&) = delete;
+    Monitor& operator=(const Monitor&) = delete;
+
+    /// Called on the loop thread after every poll, with whether a response was fetched and decoded.
+    void set_poll_callback(std::function<void(bool)> callback) { on_poll_ = std::move(callback); }
+
+    /**
+     * @brief Learns when the upstream publishes its updates and polls just after them, at the same average
+     * rate. Call before start().
+     * @param period The upstream's update period; polls are only aligned if the interval does not exceed it.
+     */
+    void align_to_upstream(std::chrono::seconds period);
+
+    /// Starts polling, or starts again after stop(); the first poll is immediate.
+    void start();
+
+    /**
+     * @brief Stops polling: cancels the next poll, aborts a fetch in flight and joins the worker thread.
+     * Idempotent. Must be called on the loop thread (or after the loop has stopped).
+     */
+    void stop();
+
+private:
+    void request_fetch();
+    void fetch_worker(std::weak_ptr<Monitor*> self);
+    void on_fetched(FetchResult& result, bool fetched);
+
+    EventLoop& loop_;
+    Engine& engine_;
+    FeedSource& source_;
+    std::chrono::seconds interval_;
+    std::function<void(bool)> on_poll_;
+
+    EventLoop::TimerId timer_ = 0;
+    EventLoop::Clock::time_point poll_started_;
+    std::int64_t poll_started_ms_ = 0; // the same, as a Unix time in milliseconds
+    FetchResult fetched_;
+    std::unique_ptr<UpdatePhase> phase_;
+    size_t body_hash_ = 0;
+    bool have_body_ = false;
+    std::shared_ptr<Monitor*> self_; // posted callbacks hold a weak reference, so they are dropped once stopped
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool fetch_requested_ = false;
+    bool stopping_ = false;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_MONITOR_H
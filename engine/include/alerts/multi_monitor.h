@@ -0,0 +1,89 @@
+#ifndef ALERTS_MULTI_MONITOR_H
+#define ALERTS_MULTI_MONITOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/executor.h"
+#include "alerts/feed_source.h"
+
+namespace alerts {
+
+/**
+ * @brief Polls many sources, each into its own engine, from one event loop and one Executor.
+ *
+ * Where a Monitor keeps a fetch thread per source, this schedules every source on the loop and starts its
+ * fetches with FeedSource::fetch_async(), so the network I/O of all of them runs on the HttpClient's thread
+ * instead of a thread each. A fetched body is decoded and applied to the source's engine as a task on the
+ * executor, so hundreds of sources spread over the cores. A source has at most one poll in flight, so its
+ * engine is only ever used by one thread at a time; but engines run on the executor's threads, and notifiers
+ * shared by several engines must accept calls from several threads (a QueuedNotifier with multiple producers,
+ * for instance).
+ */
+class MultiMonitor {
+public:
+    /**
+     * @param loop The loop that schedules the polls.
+     * @param executor The pool that decodes the responses.
+     */
+    MultiMonitor(EventLoop& loop, Executor& executor);
+    ~MultiMonitor();
+    MultiMonitor(const MultiMonitor&) = delete;
+    MultiMonitor& operator=(const MultiMonitor&) = delete;
+
+    /**
+     * @brief Adds a source, polled every interval into its engine. Call before start().
+     * @return The index of the source, as given to the poll callback.
+     */
+    std::size_t add(FeedSource& source, Engine& engine, std::chrono::milliseconds interval);
+
+    /// Called on the loop thread after every poll, with the source's index and whether a response was decoded.
+    void set_poll_callback(std::function<void(std::size_t, bool)> callback) { on_poll_ = std::move(callback); }
+
+    /// Starts polling, or starts again after stop(); the first poll of every source is immediate.
+    void start();
+
+    /**
+     * @brief Stops polling: cancels the next polls, aborts the fetches in flight and waits for the fetches and
+     * decodes still running. Idempotent. Must be called on the loop thread (or after the loop has stopped).
+     */
+    void stop();
+
+    std::size_t size() const { return sources_.size(); }
+
+private:
+    struct Source {
+        FeedSource* source;
+        Engine* engine;
+        std::chrono::milliseconds interval;
+        FetchResult fetched;
+        EventLoop::TimerId timer = 0;
+        EventLoop::Clock::time_point poll_started;
+    };
+
+    void poll(std::size_t index);
+    void on_fetched(std::size_t index, bool fetched);
+    void on_decoded(std::size_t index, bool fetched, bool decoded);
+    void begin_work();
+    void end_work();
+
+    EventLoop& loop_;
+    Executor& executor_;
+    std::vector<std::unique_ptr<Source>> sources_;
+    std::function<void(std::size_t, bool)> on_poll_;
+    std::shared_ptr<MultiMonitor*> self_; // posted callbacks hold a weak reference, so they are dropped once stopped
+
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    std::size_t working_ = 0; // fetches and decodes running off the loop thread
+};
+
+} // namespace alerts
+
+#endif // ALERTS_MULTI_MONITOR_H
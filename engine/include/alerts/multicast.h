@@ -0,0 +1,194 @@
+#ifndef ALERTS_MULTICAST_H
+#define ALERTS_MULTICAST_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+
+/*
+ * Transitions broadcast on a LAN, so that one instance polls the data source and the others learn of its
+ * alerts within a millisecond. A packet is a 32-byte header, the region name and a 16-byte tag:
+ *
+ *   0  "AT", version 2, packet type        8  sender ID (u32)       16  time (i64)
+ *   4  kind, status, name size, 0         12  sequence number (u32) 24  sending time (i64, Unix ms)
+ *                                                                   32  name, then the tag
+ *
+ * Integers are little-endian. The tag is the HMAC-SHA-256 of the rest of the packet under a shared key,
+ * truncated to 16 bytes, so only instances that know the key can raise an alert on the others. Every
+ * sender picks a random ID when it starts and numbers its packets; a listener drops packets that do not
+ * come after the last one it accepted from their sender, and packets sent more than a few seconds ago. A
+ * recorded packet can thus only be replayed within those seconds, to a listener that has not heard from its
+ * sender since it started. Instances need clocks that agree within that window, as NTP keeps them.
+ */
+
+namespace alerts {
+
+/// Where instances on a LAN exchange packets, and the key that signs them.
+struct MulticastOptions {
+    std::string group = "239.255.42.99"; ///< an IPv4 multicast group
+    std::uint16_t port = 5099;
+    std::string interface;               ///< address of the interface to use; empty for the default route
+    int ttl = 1;                         ///< how many routers a packet may cross; 1 keeps it on the LAN
+    std::string key;                     ///< shared secret; instances with another key ignore each other
+    std::chrono::seconds max_age{5};     ///< packets sent longer ago, or stamped this far ahead, are dropped
+};
+
+/**
+ * @brief Parses a "group:port" setting, such as "239.255.42.99:5099", into the options.
+ * @return false and sets error if it is not a multicast address with a port.
+ */
+bool parse_multicast_address(const std::string& text, MulticastOptions& options, std::string& error);
+
+/// Packet types.
+enum class PacketType : std::uint8_t {
+    Transition = 1, ///< an alert was raised or lifted
+    Heartbeat = 2,  ///< the sender has just received good data
+    State = 3,      ///< the current status of a region, for listeners that started late or lost a packet
+    Leader = 4,     ///< the sender is the leader of a heartbeat election (see alerts/leader.h)
+};
+
+/// A decoded packet.
+struct Packet {
+    PacketType type = PacketType::Heartbeat;
+    std::uint32_t sender = 0;
+    std::uint32_t sequence = 0;
+    std::int64_t time = 0;             ///< of the snapshot that caused the transition, or of the last good one
+    TransitionKind kind = TransitionKind::AlertOff;
+    Status status = Status::Unknown;
+    std::string region;                ///< empty for heartbeats
+    std::int64_t sent = 0;             ///< Unix time in milliseconds when the packet was sent; set by send()
+};
+
+const std::size_t kPacketHeaderSize = 32;
+const std::size_t kPacketTagSize = 16;
+const std::size_t kMaxPacketSize = kPacketHeaderSize + 255 + kPacketTagSize;
+
+/**
+ * @brief Encodes and signs a packet.
+ * @param out Room for kMaxPacketSize bytes.
+ * @return The packet size; region names longer than 255 bytes are cut.
+ */
+std::size_t encode_packet(const Packet& packet, const std::string& key, char* out);
+
+/**
+ * @brief Checks the tag of a packet and decodes it.
+ * @return false if the packet is malformed or was not signed with the key.
+ */
+bool decode_packet(const char* data, std::size_t size, const std::string& key, Packet& packet);
+
+/// Where the packets of an engine are sent: the multicast group, or the sessions of a host (see alerts/seat.h).
+class PacketSink {
+public:
+    virtual ~PacketSink() = default;
+
+    /// Sends one packet; its sender, sequence number and sending time are filled in.
+    virtual bool send(Packet& packet) = 0;
+
+    /**
+     * @brief Sends every transition of the engine's last feed, of all regions whether watched or not, then the
+     * state (see publish_state()) and a heartbeat. Call after every good poll.
+     */
+    void publish(const Engine& engine, std::int64_t time);
+
+    /**
+     * @brief Sends the status of every region with a known status, so that listeners catch up with alerts
+     * raised before they started or announced in a packet they lost.
+     */
+    void publish_state(const Engine& engine);
+};
+
+/**
+ * @brief Broadcasts the transitions of an engine, and heartbeats, to the group. Thread-safe.
+ */
+class MulticastPublisher : public PacketSink {
+public:
+    explicit MulticastPublisher(MulticastOptions options);
+    ~MulticastPublisher() override;
+    MulticastPublisher(const MulticastPublisher&) = delete;
+    MulticastPublisher& operator=(const MulticastPublisher&) = delete;
+
+    /// Opens the socket. @return false and sets error on failure.
+    bool open(std::string& error);
+
+    bool send(Packet& packet) override;
+
+    /// The random ID of this sender.
+    std::uint32_t sender() const { return sender_; }
+
+    /// Packets sent so far.
+    std::uint64_t sent() const;
+
+private:
+    MulticastOptions options_;
+    std::uint32_t sender_;
+    mutable std::mutex mutex_;
+    int fd_ = -1;
+    std::uint32_t sequence_ = 0;
+    std::uint64_t sent_ = 0;
+    char buffer_[kMaxPacketSize];
+};
+
+/**
+ * @brief Joins the group on an event loop and applies the transitions and states it receives to an engine, as
+ * readings of the regions (see Engine::apply_reading()), so the engine's own notifiers and watched regions
+ * apply, and a transition already known is not notified twice.
+ * Everything runs on the loop thread.
+ */
+class MulticastListener {
+public:
+    /// Counters over every packet received.
+    struct Stats {
+        std::uint64_t received = 0;
+        std::uint64_t accepted = 0;
+        std::uint64_t rejected = 0; ///< malformed, or not signed with the key
+        std::uint64_t replayed = 0; ///< not newer than the last packet accepted from the same sender
+        std::uint64_t stale = 0;    ///< sent more than max_age ago, or stamped more than max_age ahead
+    };
+
+    MulticastListener(EventLoop& loop, Engine& engine, MulticastOptions options);
+    ~MulticastListener();
+    MulticastListener(const MulticastListener&) = delete;
+    MulticastListener& operator=(const MulticastListener&) = delete;
+
+    /// Joins the group and starts receiving. @return false and sets error on failure.
+    bool start(std::string& error);
+    void stop();
+
+    /// Called for every accepted packet, after a transition has been applied.
+    void set_packet_callback(std::function<void(const Packet&)> callback) { on_packet_ = std::move(callback); }
+
+    const Stats& stats() const { return stats_; }
+
+    /// Senders whose last sequence number is remembered; those silent for twice max_age are forgotten.
+    std::size_t senders() const { return last_sequence_.size(); }
+
+private:
+    /// The last packet accepted from a sender.
+    struct Sequence {
+        std::uint32_t sequence;
+        std::int64_t received; ///< Unix time in ms
+    };
+
+    void receive();
+    void forget_senders(std::int64_t now);
+
+    EventLoop& loop_;
+    Engine& engine_;
+    MulticastOptions options_;
+    int fd_ = -1;
+    std::function<void(const Packet&)> on_packet_;
+    std::unordered_map<std::uint32_t, Sequence> last_sequence_; // by sender
+    std::int64_t forgotten_ = 0;                                 // when forget_senders() last ran, Unix ms
+    Packet packet_;
+    Stats stats_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_MULTICAST_H
@@ -0,0 +1,133 @@
+#ifndef ALERTS_NOTIFIER_H
+#define ALERTS_NOTIFIER_H
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "alerts/snapshot.h"
+
+namespace alerts {
+
+/**
+ * @brief Receives the alert state changes of the watched regions.
+ * Notifiers are called on the thread that feeds the engine and should return quickly.
+ */
+class Notifier {
+public:
+    virtual ~Notifier() = default;
+
+    /**
+     * @brief Called once per transition.
+     * @param transition The state change.
+     * @param region The name of the region.
+     */
+    virtual void notify(const Transition& transition, const std::string& region) = 0;
+
+    /**
+     * @brief Waits until the notifications already handed over have been delivered, for a clean shutdown.
+     * @param deadline When to give up; whatever is still pending is then cancelled.
+     * @return false if the deadline was reached.
+     */
+    virtual bool drain(std::chrono::steady_clock::time_point deadline) { (void)deadline; return true; }
+
+    /**
+     * @brief Called when the data source has not delivered a good snapshot for too long, and when it does again.
+     * Alerts may be missed while the data is stale.
+     * @param stale Whether the data is stale now.
+     * @param age The time since the last good snapshot.
+     */
+    virtual void data_stale(bool stale, std::chrono::seconds age) { (void)stale; (void)age; }
+};
+
+/**
+ * @brief The title and text that tell the user about a transition, in Ukrainian, for dialogs and desktop
+ * notifications.
+ */
+void format_alert_text(TransitionKind kind, const std::string& region, std::string& title, std::string& message);
+
+/**
+ * @brief The title and text that tell the user that the alert data is stale, or fresh again (see
+ * Notifier::data_stale()), in Ukrainian.
+ */
+void format_stale_text(bool stale, std::chrono::seconds age, std::string& title, std::string& message);
+
+/**
+ * @brief Writes one line per transition: "<unix time> ALERT ON|ALERT OFF <region> (<status>)".
+ */
+class LogNotifier : public Notifier {
+public:
+    explicit LogNotifier(std::ostream& out) : out_(out) {}
+
+    void notify(const Transition& transition, const std::string& region) override;
+    bool drain(std::chrono::steady_clock::time_point deadline) override;
+    void data_stale(bool stale, std::chrono::seconds age) override;
+
+private:
+    std::ostream& out_;
+};
+
+/**
+ * @brief Plays a sound file with the 'mpg123' command-line tool in the background.
+ * The player is started directly, without a shell, and the function returns immediately.
+ * @param sound_file The path of the sound file to be played.
+ * @return The process ID of the player, to be reaped with waitpid(), or -1 if it could not be started.
+ * @note This function requires the 'mpg123' command-line tool to be installed on the system.
+ */
+int play_alert_sound(const std::string& sound_file);
+
+/**
+ * @brief Plays one sound when an alert is raised and another when it is lifted.
+ * After preload() the sounds are played from memory, so an alert never waits for the disk. If the PCM player is
+ * installed, preload() also decodes them to WAV, so an alert does not wait for the MP3 decoder either.
+ */
+class SoundNotifier : public Notifier {
+public:
+    /**
+     * @param alert_on The sound played when an alert is raised.
+     * @param alert_off The sound played when an alert is lifted.
+     * @param player The player program, called as "<player> -q <file>"; preload() decodes with
+     * "<player> -q -w <wav> <file>".
+     * @param pcm_player The program that plays the decoded sounds, called as "<pcm_player> -q <wav>"; empty not to
+     * decode.
+     */
+    SoundNotifier(std::string alert_on, std::string alert_off, std::string player = "mpg123",
+                  std::string pcm_player = "aplay");
+    ~SoundNotifier() override;
+    SoundNotifier(const SoundNotifier&) = delete;
+    SoundNotifier& operator=(const SoundNotifier&) = delete;
+
+    /**
+     * @brief Loads both sound files into memory and decodes them. Can run on another thread while the engine is in
+     * use.
+     * @return false if a file could not be loaded; that sound is then played from disk. A sound that could not be
+     * decoded is played from memory by the player.
+     */
+    bool preload();
+
+    void notify(const Transition& transition, const std::string& region) override;
+
+    /// Waits for the players to finish; players still running at the deadline are terminated.
+    bool drain(std::chrono::steady_clock::time_point deadline) override;
+
+private:
+    struct Sound {
+        std::string path;
+        int fd = -1;     // in-memory copy, once preloaded
+        int pcm_fd = -1; // decoded in memory, once preloaded
+    };
+
+    void reap();
+
+    std::mutex mutex_;
+    std::string player_;
+    std::string pcm_player_;
+    Sound alert_on_;
+    Sound alert_off_;
+    std::vector<int> players_; // player processes not reaped yet
+};
+
+} // namespace alerts
+
+#endif // ALERTS_NOTIFIER_H
@@ -0,0 +1,22 @@
+#ifndef ALERTS_PROCESS_STATS_H
+#define ALERTS_PROCESS_STATS_H
+
+namespace alerts {
+
+/// Resource usage of the current process, from /proc/self.
+struct ProcessStats {
+    long rss_kib = -1;  ///< resident set size
+    long hwm_kib = -1;  ///< peak resident set size
+    int threads = -1;   ///< number of threads
+    int fds = -1;       ///< number of open file descriptors
+};
+
+/**
+ * @brief Reads the resource usage of the current process.
+ * Fields that cannot be read (no /proc) are left at -1.
+ */
+ProcessStats read_process_stats();
+
+} // namespace alerts
+
+#endif // ALERTS_PROCESS_STATS_H
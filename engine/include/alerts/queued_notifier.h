@@ -0,0 +1,117 @@
+#ifndef ALERTS_QUEUED_NOTIFIER_H
+#define ALERTS_QUEUED_NOTIFIER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include "alerts/event_ring.h"
+#include "alerts/notifier.h"
+
+namespace alerts {
+
+/// One notification on its way from the engine to a notifier thread.
+struct EventRecord {
+    enum class Kind : std::uint8_t {
+        Transition = 0, ///< a Notifier::notify() call
+        Stale = 1,      ///< Notifier::data_stale(true, ...)
+        Fresh = 2,      ///< Notifier::data_stale(false, ...)
+    };
+
+    Kind kind;
+    TransitionKind transition;
+    Status status;
+    std::uint8_t name_size;     ///< bytes of name in use; longer names are cut at a UTF-8 character boundary
+    RegionId region;            ///< the region ID in the producing engine
+    std::uint16_t reserved;
+    std::int64_t time;          ///< Unix time of the transition, or the age in seconds of stale data
+    std::int64_t enqueued;      ///< steady clock nanoseconds when the record was pushed
+    char name[104];             ///< UTF-8, not NUL-terminated when it fills the field
+};
+
+static_assert(sizeof(EventRecord) == 128, "event records fill two cache lines");
+
+/**
+ * @brief Hands notifications to another notifier on a thread of its own, through a bounded lock-free ring.
+ *
+ * notify() and data_stale() copy the notification into a fixed-size EventRecord and return; they neither
+ * allocate nor take a lock unless the notifier thread is asleep and has to be woken. The thread calls the
+ * wrapped notifier in order, so a slow notifier (a process to spawn, a bus to call) no longer holds up the
+ * engine. With several producers (engines on different threads sharing one notifier) the ring is an MpscRing,
+ * otherwise an SpscRing. When the ring is full the producer waits for room rather than drop a notification.
+ */
+class QueuedNotifier : public Notifier {
+public:
+    /**
+     * @param target The notifier to call on the notifier thread.
+     * @param capacity Records the ring holds, rounded up to a power of two.
+     * @param multiple_producers Whether notify() and data_stale() may be called from several threads at once.
+     */
+    explicit QueuedNotifier(std::shared_ptr<Notifier> target, std::size_t capacity = 1024,
+                            bool multiple_producers = false);
+    /// Stops the thread after it has delivered what is queued.
+    ~QueuedNotifier() override;
+    QueuedNotifier(const QueuedNotifier&) = delete;
+    QueuedNotifier& operator=(const QueuedNotifier&) = delete;
+
+    void notify(const Transition& transition, const std::string& region) override;
+    void data_stale(bool stale, std::chrono::seconds age) override;
+
+    /**
+     * @brief Waits until the queue is empty, then drains the wrapped notifier from the calling thread.
+     * Call it once the producers have stopped, as Engine::drain() is at shutdown.
+     */
+    bool drain(std::chrono::steady_clock::time_point deadline) override;
+
+    /// Delivery statistics, safe to read from any thread.
+    struct Stats {
+        std::uint64_t delivered = 0;      ///< records handed to the wrapped notifier
+        std::uint64_t full_waits = 0;     ///< pushes that found the ring full and had to wait
+        std::int64_t max_latency_ns = 0;  ///< the longest time a record spent in the ring
+        std::int64_t total_latency_ns = 0;
+    };
+    Stats stats() const;
+
+    /**
+     * @brief Called on the notifier thread with every record after it has been delivered, for measurements.
+     * Set it before the first notification.
+     */
+    void set_delivery_callback(std::function<void(const EventRecord&)> callback) {
+        delivered_callback_ = std::move(callback);
+    }
+
+private:
+    void push(EventRecord& record); // stamps the record's enqueue time
+    bool pop(EventRecord& record);
+    void run();
+    void deliver(const EventRecord& record);
+
+    std::shared_ptr<Notifier> target_;
+    std::unique_ptr<SpscRing<EventRecord>> spsc_; // exactly one of the rings is used
+    std::unique_ptr<MpscRing<EventRecord>> mpsc_;
+    std::function<void(const EventRecord&)> delivered_callback_;
+    std::string name_; // the notifier thread's copy of the current record's name
+
+    std::mutex mutex_;                  // only for sleeping and waking
+    std::condition_variable wake_;      // the notifier thread waits for records here
+    std::condition_variable idle_;      // drain() waits for an empty queue here
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> pushed_{0};
+    std::atomic<std::uint64_t> delivered_{0};
+    std::atomic<std::uint64_t> full_waits_{0};
+    std::atomic<std::int64_t> max_latency_ns_{0};
+    std::atomic<std::int64_t> total_latency_ns_{0};
+    std::thread thread_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_QUEUED_NOTIFIER_H
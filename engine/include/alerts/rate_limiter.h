@@ -0,0 +1,65 @@
+#ifndef ALERTS_RATE_LIMITER_H
+#define ALERTS_RATE_LIMITER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace alerts {
+
+/**
+ * @brief A token bucket that limits how often requests are sent to the upstream, plus the pauses that
+ * upstream hosts can impose with Retry-After. Thread-safe.
+ *
+ * All HTTP sources of a process share process() by default, so several monitors (or several offices
+ * behind one address) stay under one quota together. A pause applies to the host that asked for it only,
+ * so a mirror on another host is still polled.
+ */
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// The limiter shared by the whole process; unlimited until set_rate() is called.
+    static RateLimiter& process();
+
+    /**
+     * @brief Sets the sustained rate and the burst size.
+     * @param per_second Requests per second; 0 or less removes the limit.
+     * @param burst How many requests may be sent back to back after a quiet period (at least 1).
+     */
+    void set_rate(double per_second, double burst);
+
+    /**
+     * @brief Takes a token if a request to a host may be sent now.
+     * @param retry_at Set, on failure, to when a request will be allowed.
+     * @param host The host the request is for, e.g. "example.com:443".
+     * @return false if the bucket is empty or the host asked to wait.
+     */
+    bool try_acquire(Clock::time_point& retry_at, const std::string& host = {});
+
+    /// Blocks the requests to a host, or every request if it is empty, until the given time (later calls can only
+    /// extend the pause).
+    void defer_until(Clock::time_point until, const std::string& host = {});
+
+    /// Lifts the pause of a host, or of every host if it is empty, as when the upstream is known to be back.
+    void resume(const std::string& host = {});
+
+    /// When the next request to a host will be allowed; in the past if one is allowed now.
+    Clock::time_point next_allowed(const std::string& host = {});
+
+private:
+    void refill(Clock::time_point now);
+    Clock::time_point deferred_until(const std::string& host, Clock::time_point now);
+
+    std::mutex mutex_;
+    double rate_ = 0;   // tokens per second, 0 for unlimited
+    double burst_ = 1;
+    double tokens_ = 1;
+    Clock::time_point refilled_ = Clock::now();
+    std::map<std::string, Clock::time_point> deferred_; // by host; "" pauses every host
+};
+
+} // namespace alerts
+
+#endif // ALERTS_RATE_LIMITER_H
@@ -0,0 +1,53 @@
+#ifndef ALERTS_REGIONS_H
+#define ALERTS_REGIONS_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "alerts/known_regions.h"
+#include "alerts/status.h"
+
+namespace alerts {
+
+/**
+ * @brief Assigns dense region IDs to region names, in order of first appearance.
+ * Every engine instance has its own registry, so IDs are only meaningful within that instance.
+ * Names of the known regions (see find_known_region()) are resolved through a compile-time perfect hash
+ * rather than the hash map, and both spellings of a known region share one ID, named after the first seen.
+ */
+class RegionRegistry {
+public:
+    /**
+     * @brief Returns the ID of a region, registering the name if it has not been seen before.
+     */
+    RegionId intern(const char* name, std::size_t size);
+    RegionId intern(const std::string& name) { return intern(name.data(), name.size()); }
+
+    RegionRegistry();
+
+    /**
+     * @brief Looks up a region without registering it.
+     * @return true and sets id if the region is known.
+     */
+    bool find(const std::string& name, RegionId& id) const;
+
+    /// The name of a registered region.
+    const std::string& name(RegionId id) const { return names_[id]; }
+
+    /// The number of registered regions. IDs are 0 .. size() - 1.
+    std::size_t size() const { return names_.size(); }
+
+private:
+    static const RegionId kUnassigned = 0xffff;
+
+    RegionId add(const char* name, std::size_t size);
+
+    RegionId known_ids_[kKnownRegionCount]; ///< ID of each known region, or kUnassigned
+    std::unordered_map<std::string, RegionId> ids_; ///< the other names
+    std::vector<std::string> names_;
+    std::string key_; // lookup key buffer
+};
+
+} // namespace alerts
+
+#endif // ALERTS_REGIONS_H
@@ -0,0 +1,135 @@
+#ifndef ALERTS_SEAT_H
+#define ALERTS_SEAT_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/multicast.h"
+
+/*
+ * Delivery to every session logged in on a host. A system-wide instance polls the data source and serves a local
+ * socket; an agent in each session connects to it and notifies its user, on that session's desktop and sound
+ * device, so one fetch feeds all the seats of a shared terminal.
+ *
+ * The socket is a SOCK_SEQPACKET Unix socket, so every message is one packet in the format of alerts/multicast.h.
+ * Only the service can create the socket in its runtime directory, so packets are not signed with a secret (the tag
+ * is computed with an empty key); an agent checks instead that the process serving the socket runs as root or as its
+ * own user.
+ */
+
+namespace alerts {
+
+/**
+ * @brief Serves the agents of a host: every packet sent is delivered to all connected agents, and a new agent is
+ * sent the state of every region as soon as it connects. Everything runs on the loop thread.
+ */
+class SeatServer : public PacketSink {
+public:
+    /// Counters over the agents served.
+    struct Stats {
+        std::uint64_t connected = 0;
+        std::uint64_t dropped = 0; ///< disconnected because they did not take their packets
+    };
+
+    /**
+     * @param engine The engine whose state new agents are sent.
+     * @param path The socket path. A socket already there is removed only if nobody listens on it, as when a previous
+     * instance did not stop cleanly; if one does, start() fails.
+     */
+    SeatServer(EventLoop& loop, const Engine& engine, std::string path);
+    ~SeatServer() override;
+    SeatServer(const SeatServer&) = delete;
+    SeatServer& operator=(const SeatServer&) = delete;
+
+    /// Creates the socket, open to every user, and accepts agents. @return false and sets error on failure.
+    bool start(std::string& error);
+
+    /// Disconnects the agents and removes the socket.
+    void stop();
+
+    /// Sends one packet to every agent. An agent whose socket buffer is full is hung; it is disconnected.
+    bool send(Packet& packet) override;
+
+    /// Agents connected now.
+    std::size_t sessions() const { return agents_.size(); }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    void accept_agents();
+    void drop(int fd);
+
+    EventLoop& loop_;
+    const Engine& engine_;
+    std::string path_;
+    int fd_ = -1;
+    std::vector<int> agents_;
+    std::uint32_t sender_;
+    std::uint32_t sequence_ = 0;
+    char buffer_[kMaxPacketSize];
+    Stats stats_;
+};
+
+/**
+ * @brief Takes the packets of a SeatServer in a user session and applies their transitions and states to an engine,
+ * as MulticastListener does. When the service is not running yet, or restarts, the agent connects again on its own.
+ * Everything runs on the loop thread.
+ */
+class SeatAgent {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Counters since the agent started.
+    struct Stats {
+        std::uint64_t received = 0;
+        std::uint64_t rejected = 0; ///< malformed packets
+        std::uint64_t connects = 0;
+    };
+
+    /**
+     * @param path The socket of the service.
+     * @param retry How long to wait before connecting again.
+     */
+    SeatAgent(EventLoop& loop, Engine& engine, std::string path, Clock::duration retry = std::chrono::seconds(1));
+    ~SeatAgent();
+    SeatAgent(const SeatAgent&) = delete;
+    SeatAgent& operator=(const SeatAgent&) = delete;
+
+    /**
+     * @brief Connects to the service.
+     * @return false and sets error if it cannot be reached now; the agent keeps trying in the background.
+     */
+    bool start(std::string& error);
+    void stop();
+
+    bool connected() const { return fd_ >= 0; }
+
+    /// Called for every packet received, after a transition or state has been applied.
+    void set_packet_callback(std::function<void(const Packet&)> callback) { on_packet_ = std::move(callback); }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    bool connect_service(std::string& error);
+    void receive();
+    void disconnect();
+
+    EventLoop& loop_;
+    Engine& engine_;
+    std::string path_;
+    Clock::duration retry_;
+    bool running_ = false;
+    int fd_ = -1;
+    EventLoop::TimerId timer_ = 0;
+    std::function<void(const Packet&)> on_packet_;
+    Packet packet_;
+    Stats stats_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_SEAT_H
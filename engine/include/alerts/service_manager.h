@@ -0,0 +1,25 @@
+#ifndef ALERTS_SERVICE_MANAGER_H
+#define ALERTS_SERVICE_MANAGER_H
+
+#include <chrono>
+#include <string>
+
+namespace alerts {
+
+/**
+ * @brief Sends a status update to the service manager, as sd_notify() does, without linking libsystemd.
+ * @param state Newline-separated assignments, e.g. "READY=1" or "WATCHDOG=1".
+ * @return false if the process was not started with NOTIFY_SOCKET, or the message could not be sent.
+ */
+bool notify_service_manager(const std::string& state);
+
+/**
+ * @brief The watchdog timeout the service manager expects pings within (WatchdogSec=), as
+ * sd_watchdog_enabled() reports it.
+ * @return Zero if the watchdog is not enabled for this process.
+ */
+std::chrono::microseconds service_watchdog_timeout();
+
+} // namespace alerts
+
+#endif // ALERTS_SERVICE_MANAGER_H
@@ -0,0 +1,43 @@
+#ifndef ALERTS_SHA256_H
+#define ALERTS_SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace alerts {
+
+/**
+ * @brief SHA-256 (FIPS 180-4), incrementally: update() any number of times, then finish().
+ * Used to sign the packets that instances exchange on a LAN, without a dependency on a crypto library.
+ */
+class Sha256 {
+public:
+    static const std::size_t kDigestSize = 32;
+
+    Sha256() { reset(); }
+
+    void reset();
+    void update(const void* data, std::size_t size);
+
+    /// Writes the digest; the object must be reset() before it is used again.
+    void finish(std::uint8_t digest[kDigestSize]);
+
+private:
+    void compress(const std::uint8_t* block);
+
+    std::uint32_t state_[8];
+    std::uint8_t block_[64];
+    std::size_t used_ = 0;   // bytes in block_
+    std::uint64_t length_ = 0; // bytes hashed so far
+};
+
+/**
+ * @brief HMAC-SHA-256 (RFC 2104) of a message under a key of any length.
+ */
+void hmac_sha256(const std::string& key, const void* data, std::size_t size,
+                 std::uint8_t mac[Sha256::kDigestSize]);
+
+} // namespace alerts
+
+#endif // ALERTS_SHA256_H
@@ -0,0 +1,60 @@
+#ifndef ALERTS_SHUTDOWN_H
+#define ALERTS_SHUTDOWN_H
+
+#include <chrono>
+#include <string>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/monitor.h"
+#include "alerts/watchdog.h"
+
+namespace alerts {
+
+/**
+ * @brief Handles SIGTERM, SIGINT and SIGHUP through an event loop and shuts a monitor down cleanly.
+ * On any of them it stops polling (aborting a fetch in flight), lets the notifiers finish what they were
+ * handed for up to the drain timeout, saves the alert state, flushes the logs and stops the loop.
+ * The service manager is told STOPPING=1 first. SIGHUP additionally asks the caller to restart the process once the loop has returned.
+ *
+ * Construct it at the start of main(), before any thread is started: the signals are blocked in the
+ * constructing thread, and threads inherit that mask.
+ */
+class GracefulShutdown {
+public:
+    explicit GracefulShutdown(EventLoop& loop);
+
+    /**
+     * @brief Sets what to shut down. Until this is called, a signal only stops the loop.
+     * @param state_file Where to save the alert state; empty to skip.
+     * @param drain_timeout How long the notifiers may take to deliver what is pending.
+     * @param watchdog A watchdog to stop first, so that draining is not mistaken for a hung loop; may be null.
+     */
+    void attach(Monitor& monitor, Engine& engine, std::string state_file, std::chrono::seconds drain_timeout,
+                Watchdog* watchdog = nullptr);
+
+    /// Runs the shutdown sequence as if the signal had been received. Must be called on the loop thread.
+    void signal(int signal_number);
+
+    /// Whether the loop stopped because of SIGHUP.
+    bool restart_requested() const { return restart_; }
+
+    /**
+     * @brief Replaces the process with a fresh copy of the same program. Only returns on failure.
+     * @param argv The arguments for the new process, usually main()'s argv.
+     */
+    static void reexec(char** argv);
+
+private:
+    EventLoop& loop_;
+    Monitor* monitor_ = nullptr;
+    Engine* engine_ = nullptr;
+    Watchdog* watchdog_ = nullptr;
+    std::string state_file_;
+    std::chrono::seconds drain_timeout_{5};
+    bool shutting_down_ = false;
+    bool restart_ = false;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_SHUTDOWN_H
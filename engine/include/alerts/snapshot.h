@@ -0,0 +1,43 @@
+#ifndef ALERTS_SNAPSHOT_H
+#define ALERTS_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+#include "alerts/status.h"
+
+namespace alerts {
+
+/// The status of one region in a snapshot.
+struct RegionReading {
+    RegionId region;
+    Status status;
+};
+
+/// One decoded response of the data source.
+struct Snapshot {
+    std::int64_t time = 0; ///< Unix time the snapshot was taken
+    std::vector<RegionReading> readings;
+
+    void clear() {
+        time = 0;
+        readings.clear();
+    }
+};
+
+/// Direction of an alert state change.
+enum class TransitionKind : std::uint8_t {
+    AlertOn = 1,  ///< an alert was raised
+    AlertOff = 0, ///< an alert was lifted
+};
+
+/// An alert state change of a region, produced by the state store.
+struct Transition {
+    RegionId region;
+    TransitionKind kind;
+    Status status;     ///< the status that caused the change
+    std::int64_t time; ///< time of the snapshot that caused the change
+};
+
+} // namespace alerts
+
+#endif // ALERTS_SNAPSHOT_H
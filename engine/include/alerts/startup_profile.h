@@ -0,0 +1,48 @@
+#ifndef ALERTS_STARTUP_PROFILE_H
+#define ALERTS_STARTUP_PROFILE_H
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief Times the phases of process startup.
+ * Phases may complete on different threads; each one is logged as it completes, relative to the
+ * creation of the profile, so parallel initialisation can be followed in the log.
+ */
+class StartupProfile {
+public:
+    /**
+     * @brief Starts the clock and logs how long the process took to reach this point after exec
+     * (dynamic linking and static initialisation).
+     * @param log Where phases are reported; it must outlive the profile.
+     */
+    explicit StartupProfile(std::ostream& log);
+
+    /**
+     * @brief Records and logs the completion of a phase. Thread-safe.
+     */
+    void mark(const std::string& phase);
+
+    /// Completed phases with their time since the profile was created, in milliseconds.
+    std::vector<std::pair<std::string, double>> phases() const;
+
+    /// Time from exec to the creation of the profile in milliseconds, or a negative value if unknown.
+    double exec_ms() const { return exec_ms_; }
+
+private:
+    std::ostream& log_;
+    std::chrono::steady_clock::time_point started_;
+    double exec_ms_;
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, double>> phases_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_STARTUP_PROFILE_H
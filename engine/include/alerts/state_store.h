@@ -0,0 +1,58 @@
+#ifndef ALERTS_STATE_STORE_H
+#define ALERTS_STATE_STORE_H
+
+#include <cstdint>
+#include <vector>
+#include "alerts/snapshot.h"
+
+namespace alerts {
+
+/**
+ * @brief Keeps the last known status and the alert state of every region and derives transitions.
+ * An alert is raised when a region reports "full" and lifted when it reports "null" or "no_data";
+ * "partial" keeps the current state.
+ */
+class StateStore {
+public:
+    /**
+     * @brief Applies a snapshot.
+     * @param snapshot The decoded snapshot.
+     * @param transitions Receives the resulting alert state changes; it is not cleared first.
+     */
+    void apply(const Snapshot& snapshot, std::vector<Transition>& transitions);
+
+    /// The last reported status of a region, or Status::Unknown.
+    Status status(RegionId region) const {
+        return region < statuses_.size() ? statuses_[region] : Status::Unknown;
+    }
+
+    /// The Unix time of the snapshot in which the status of a region last changed, or 0.
+    std::int64_t changed_at(RegionId region) const {
+        return region < changed_at_.size() ? changed_at_[region] : 0;
+    }
+
+    /// Whether an alert is currently raised in a region.
+    bool alert_active(RegionId region) const {
+        return region < active_.size() && active_[region];
+    }
+
+    /// Sets the state of a region, as loaded from a saved state file.
+    void restore(RegionId region, Status status, bool alert_active);
+
+    /// Last reported statuses, indexed by region ID.
+    const std::vector<Status>& statuses() const { return statuses_; }
+
+    /// Alert flags (0 or 1), indexed by region ID.
+    const std::vector<std::uint8_t>& active() const { return active_; }
+
+private:
+    void grow(RegionId region);
+
+    std::vector<Status> statuses_;
+    std::vector<std::uint8_t> active_;
+    std::vector<std::int64_t> changed_at_;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_STATE_STORE_H
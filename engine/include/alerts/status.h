@@ -0,0 +1,36 @@
+#ifndef ALERTS_STATUS_H
+#define ALERTS_STATUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace alerts {
+
+/// Identifier of a region within one engine instance.
+using RegionId = std::uint16_t;
+
+/// Alert status of a region as published by the data source.
+enum class Status : std::uint8_t {
+    Null = 0,    ///< no alert ("null" or JSON null)
+    NoData = 1,  ///< the source has no data for the region ("no_data")
+    Partial = 2, ///< alert in part of the region ("partial")
+    Full = 3,    ///< alert in the whole region ("full")
+    Unknown = 4, ///< a value this version does not understand, or not reported yet
+};
+
+/**
+ * @brief Parses a status string from the data source.
+ * @param text The status text, not NUL-terminated.
+ * @param size The length of the text.
+ * @return The matching status, or Status::Unknown.
+ */
+Status parse_status(const char* text, std::size_t size);
+
+/**
+ * @brief Returns the data source spelling of a status ("full", "partial", "no_data", "null" or "unknown").
+ */
+const char* status_name(Status status);
+
+} // namespace alerts
+
+#endif // ALERTS_STATUS_H
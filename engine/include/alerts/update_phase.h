@@ -0,0 +1,77 @@
+#ifndef ALERTS_UPDATE_PHASE_H
+#define ALERTS_UPDATE_PHASE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace alerts {
+
+/**
+ * @brief Learns when the upstream publishes its updates, and schedules polls just after them.
+ *
+ * The upstream refreshes its data every period, at a fixed phase that is unknown to us. A poll that sees a
+ * changed response tells that an update was published since the previous poll; folded modulo the period,
+ * those windows narrow down the update phase (a decayed log-likelihood per phase bin, tolerant of the odd
+ * wrong window). Unchanged responses tell nothing, since the upstream may publish the same data again.
+ *
+ * Polls are kept on a grid of whole fractions of the period, no closer than the poll interval, moved to just
+ * after the estimated phase. Now and then the poll for that grid point is preceded by a probe sent early,
+ * and the next grid point is skipped to keep the rate: whichever of the two short windows sees the change
+ * bounds the phase from above or below. Once the phase is known, a change is seen within a second or two of
+ * its publication instead of half an interval later on average, at the same request rate.
+ *
+ * Times are Unix times in milliseconds, since the upstream's cadence follows the wall clock.
+ */
+class UpdatePhase {
+public:
+    /**
+     * @param period The upstream's update period in milliseconds.
+     * @param resolution The precision of the phase estimate in milliseconds; also the margin kept after the
+     *        expected update.
+     */
+    explicit UpdatePhase(std::int64_t period, std::int64_t resolution = 1000);
+
+    /**
+     * @brief Records a successful poll.
+     * @param time When the request was sent.
+     * @param changed Whether the response differed from the previous one.
+     */
+    void observe(std::int64_t time, bool changed);
+
+    /// Whether the phase is known well enough to probe only rarely.
+    bool locked() const { return locked_; }
+
+    /// The phase polls are aligned to, just after the estimated update, in [0, period) milliseconds.
+    std::int64_t phase() const { return phase_; }
+
+    /**
+     * @brief When to send the next poll.
+     * @param last When the last poll was sent.
+     * @param interval The poll interval in milliseconds. The average rate is at most one poll per interval;
+     *        an interval longer than the period is kept as it is.
+     */
+    std::int64_t next_poll(std::int64_t last, std::int64_t interval);
+
+private:
+    void update_estimate();
+    std::int64_t dither(std::int64_t step);
+
+    std::int64_t period_;
+    std::int64_t resolution_;
+    std::vector<double> weights_; // per phase bin: log-likelihood of the update phase, decayed
+    double observations_ = 0;     // decayed count of informative windows
+    std::int64_t last_time_ = -1;
+    bool locked_ = false;
+    std::int64_t phase_ = 0;
+    std::int64_t spread_;         // width of the phases not ruled out, in milliseconds
+
+    std::uint32_t random_ = 1;    // deterministic dither
+    bool anchored_ = false;       // until an update is observed, polls keep the phase of the first one
+    std::uint64_t polls_ = 0;     // polls at the estimated phase, counted to space the probes
+    std::int64_t probed_ = 0;     // the grid point the last probe was sent early for
+    bool skip_ = false;           // skip a grid point to make up for the probe
+};
+
+} // namespace alerts
+
+#endif // ALERTS_UPDATE_PHASE_H
@@ -0,0 +1,93 @@
+#ifndef ALERTS_WATCHDOG_H
+#define ALERTS_WATCHDOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "alerts/event_loop.h"
+
+namespace alerts {
+
+/**
+ * @brief Watches an event loop and the age of the last good snapshot from a thread of its own.
+ *
+ * A timer on the loop records a heartbeat every check interval (a quarter of the shorter of the hang and stale
+ * timeouts). The watchdog
+ * thread checks it at the same interval, so a loop that stops turning is detected at most one check interval
+ * after the hang timeout has passed since its last heartbeat. While the loop is alive, the watchdog pings the service manager (WATCHDOG=1); once
+ * it is hung the pings stop, so systemd's own watchdog restarts the service even if the hang callback does not.
+ *
+ * Snapshots are reported with data_received(). When none has arrived for the stale timeout, because the
+ * feed stopped updating or a fetch is stuck, the stale callback is called on the loop, and again when
+ * data arrives again.
+ */
+class Watchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param loop The loop to watch.
+     * @param hang_timeout How long the loop may go without a heartbeat. When systemd's watchdog is enabled
+     *        with a shorter timeout, the check interval is shortened to ping it in time.
+     * @param stale_after How long without a good snapshot before the data is considered stale.
+     */
+    Watchdog(EventLoop& loop, Clock::duration hang_timeout, Clock::duration stale_after);
+    ~Watchdog();
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * @brief Called on the loop thread when the data becomes stale, and when it is fresh again.
+     * The callback receives whether the data is stale and the time since the last good snapshot.
+     */
+    void set_stale_callback(std::function<void(bool, Clock::duration)> callback) { on_stale_ = std::move(callback); }
+
+    /**
+     * @brief Called on the watchdog thread when the loop has been hung for the hang timeout, with the
+     * time since its last heartbeat. By default the hang is logged and the process aborts, so that a
+     * supervisor restarts it.
+     */
+    void set_hang_callback(std::function<void(Clock::duration)> callback) { on_hang_ = std::move(callback); }
+
+    /// Records that a good snapshot was received. Thread-safe.
+    void data_received();
+
+    /// Starts the heartbeat and the watchdog thread, and reports READY=1 once the loop runs.
+    void start();
+
+    /// Stops the watchdog thread and the heartbeat. Must be called on the loop thread, or after it has stopped.
+    void stop();
+
+    /// The interval of the heartbeat and of the checks.
+    Clock::duration check_interval() const { return check_interval_; }
+
+private:
+    void heartbeat();
+    void watch(std::weak_ptr<Watchdog*> self);
+
+    EventLoop& loop_;
+    Clock::duration hang_timeout_;
+    Clock::duration stale_after_;
+    Clock::duration check_interval_;
+    bool ping_service_manager_;
+    std::function<void(bool, Clock::duration)> on_stale_;
+    std::function<void(Clock::duration)> on_hang_;
+
+    std::atomic<Clock::rep> last_heartbeat_{0};
+    std::atomic<Clock::rep> last_data_{0};
+    EventLoop::TimerId heartbeat_timer_ = 0;
+    std::shared_ptr<Watchdog*> self_; // posted callbacks hold a weak reference, so they are dropped once stopped
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+};
+
+} // namespace alerts
+
+#endif // ALERTS_WATCHDOG_H
@@ -0,0 +1,130 @@
+#include "alerts/ack_tracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace alerts {
+
+std::string AckTracker::Stats::summary() const {
+    char line[192];
+    std::snprintf(line, sizeof(line), "%llu alerts, %llu acknowledged, %llu lifted unacknowledged, %llu repeats, "
+                  "latency mean %.1f s, max %.1f s", (unsigned long long)raised,
+                  (unsigned long long)acknowledged, (unsigned long long)lifted, (unsigned long long)repeats,
+                  mean_seconds(), std::chrono::duration<double>(max_latency).count());
+    return line;
+}
+
+AckTracker::AckTracker(EventLoop& loop, std::shared_ptr<Notifier> target, Options options)
+    : loop_(loop), target_(std::move(target)), options_(options),
+      self_(std::make_shared<AckTracker*>(this)) {
+    options_.shortest_repeat = std::min(options_.shortest_repeat, options_.repeat_after);
+}
+
+AckTracker::~AckTracker() {
+    self_.reset();
+    for (auto& entry : events_) {
+        loop_.cancel_timer(entry.second.timer);
+    }
+}
+
+void AckTracker::notify(const Transition& transition, const std::string& region) {
+    target_->notify(transition, region);
+    if (transition.kind == TransitionKind::AlertOff) {
+        close(transition.region, false);
+        return;
+    }
+    close(transition.region, false); // raised again without being lifted: the old event is superseded
+    Event& event = events_[transition.region];
+    event.transition = transition;
+    event.region = region;
+    event.raised = Clock::now();
+    event.delay = options_.repeat_after;
+    RegionId id = transition.region;
+    event.timer = loop_.add_timer(event.delay, [this, id] { repeat(id); });
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.raised;
+    ++open_;
+}
+
+void AckTracker::data_stale(bool stale, std::chrono::seconds age) {
+    target_->data_stale(stale, age);
+}
+
+void AckTracker::repeat(RegionId region) {
+    auto it = events_.find(region);
+    if (it == events_.end()) {
+        return;
+    }
+    Event& event = it->second;
+    event.timer = 0;
+    target_->notify(event.transition, event.region);
+    ++event.repeats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.repeats;
+    }
+    if (options_.max_repeats && event.repeats >= options_.max_repeats) {
+        return; // stays open, so a late acknowledgement is still recorded
+    }
+    event.delay = std::max(event.delay / 2, options_.shortest_repeat);
+    event.timer = loop_.add_timer(event.delay, [this, region] { repeat(region); });
+}
+
+void AckTracker::close(RegionId region, bool acknowledged) {
+    auto it = events_.find(region);
+    if (it == events_.end()) {
+        return;
+    }
+    Event event = std::move(it->second);
+    events_.erase(it);
+    loop_.cancel_timer(event.timer);
+    Clock::duration latency = Clock::now() - event.raised;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --open_;
+        if (acknowledged) {
+            ++stats_.acknowledged;
+            stats_.total_latency += latency;
+            stats_.max_latency = std::max(stats_.max_latency, latency);
+        } else {
+            ++stats_.lifted;
+        }
+    }
+    if (acknowledged && on_ack_) {
+        on_ack_(event.transition, latency, event.repeats);
+    }
+}
+
+void AckTracker::acknowledge(const Transition& transition) {
+    std::weak_ptr<AckTracker*> self = self_;
+    loop_.post([self, transition] {
+        auto tracker = self.lock();
+        if (!tracker) {
+            return;
+        }
+        auto it = (*tracker)->events_.find(transition.region);
+        if (it != (*tracker)->events_.end() && it->second.transition.time == transition.time) {
+            (*tracker)->close(transition.region, true);
+        }
+    });
+}
+
+bool AckTracker::drain(std::chrono::steady_clock::time_point deadline) {
+    for (auto& entry : events_) {
+        loop_.cancel_timer(entry.second.timer);
+        entry.second.timer = 0;
+    }
+    return target_->drain(deadline);
+}
+
+AckTracker::Stats AckTracker::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::size_t AckTracker::open() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_;
+}
+
+} // namespace alerts
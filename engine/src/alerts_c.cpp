@@ -0,0 +1,234 @@
+#include "alerts/alerts.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alerts/engine.h"
+
+namespace {
+
+/**
+ * @brief Collects the transitions of watched regions during a feed, for the C callback to be called once the
+ * engine is unlocked.
+ */
+class CallbackNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition& transition, const std::string&) override { pending.push_back(transition); }
+
+    std::vector<alerts::Transition> pending; // of the feed in progress; guarded by the engine's mutex
+};
+
+} // namespace
+
+struct alerts_engine {
+    alerts::Engine engine;
+    std::shared_ptr<CallbackNotifier> notifier = std::make_shared<CallbackNotifier>();
+
+    // Guards the engine's state, the callback and the polling state. It is never held while fetching or while
+    // the callback runs, so the callback may query the engine or replace itself.
+    mutable std::mutex mutex;
+    alerts_transition_cb callback = nullptr;
+    void* user_data = nullptr;
+
+    // Polling thread state; only used after alerts_engine_start_polling().
+    std::thread poller;
+    std::condition_variable wakeup;
+    bool polling = false; // from alerts_engine_start_polling() until the poller is joined
+    bool stopping = false;
+    alerts::FeedSource* source = nullptr; // while the poller runs, so stopping can abort a fetch
+};
+
+namespace {
+
+/**
+ * @brief Feeds the engine under its lock, then calls the callback for every transition of a watched region.
+ * @param poller Whether the polling thread is feeding; any other thread is refused while it polls.
+ * @return the number of transitions, or -1 if the body could not be decoded or the engine is polling.
+ */
+int feed_engine(alerts_engine* engine, const char* data, size_t size, int64_t time, bool poller) {
+    std::unique_lock<std::mutex> lock(engine->mutex);
+    if (engine->polling && !poller) {
+        return -1;
+    }
+    std::vector<alerts::Transition>& collected = engine->notifier->pending;
+    collected.clear();
+    if (!engine->engine.feed(data, size, time)) {
+        return -1;
+    }
+    // Another thread may feed or watch as soon as the lock is released: take the transitions and the names.
+    std::vector<alerts::Transition> pending;
+    pending.swap(collected);
+    std::vector<std::string> names;
+    names.reserve(pending.size());
+    for (const alerts::Transition& transition : pending) {
+        names.push_back(engine->engine.regions().name(transition.region));
+    }
+    alerts_transition_cb callback = engine->callback;
+    void* user_data = engine->user_data;
+    lock.unlock();
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (!callback) {
+            break;
+        }
+        const alerts::Transition& transition = pending[i];
+        alerts_transition t;
+        t.region = names[i].c_str();
+        t.region_id = transition.region;
+        t.kind = uint8_t(transition.kind);
+        t.status = uint8_t(transition.status);
+        t.time = transition.time;
+        callback(&t, user_data);
+    }
+    return int(pending.size());
+}
+
+} // namespace
+
+extern "C" {
+
+unsigned alerts_api_version(void) {
+    return ALERTS_API_VERSION;
+}
+
+alerts_engine* alerts_engine_create(void) {
+    try {
+        alerts_engine* engine = new alerts_engine;
+        engine->engine.add_notifier(engine->notifier);
+        return engine;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void alerts_engine_destroy(alerts_engine* engine) {
+    if (!engine) {
+        return;
+    }
+    alerts_engine_stop_polling(engine);
+    delete engine;
+}
+
+int alerts_engine_watch(alerts_engine* engine, const char* region) {
+    if (!engine || !region) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (engine->polling) {
+        return -1;
+    }
+    try {
+        engine->engine.watch(region);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+void alerts_engine_set_callback(alerts_engine* engine, alerts_transition_cb callback, void* user_data) {
+    if (!engine) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->callback = callback;
+    engine->user_data = user_data;
+}
+
+int alerts_engine_feed(alerts_engine* engine, const char* data, size_t size, int64_t time) {
+    if (!engine || (!data && size)) {
+        return -1;
+    }
+    try {
+        return feed_engine(engine, data, size, time, false);
+    } catch (...) {
+        return -1;
+    }
+}
+
+int alerts_engine_status(const alerts_engine* engine, const char* region) {
+    if (!engine || !region) {
+        return ALERTS_STATUS_UNKNOWN;
+    }
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    alerts::RegionId id;
+    if (!engine->engine.regions().find(region, id)) {
+        return ALERTS_STATUS_UNKNOWN;
+    }
+    return int(engine->engine.state().status(id));
+}
+
+int alerts_engine_alert_active(const alerts_engine* engine, const char* region) {
+    if (!engine || !region) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    alerts::RegionId id;
+    if (!engine->engine.regions().find(region, id)) {
+        return 0;
+    }
+    return engine->engine.state().alert_active(id) ? 1 : 0;
+}
+
+int alerts_engine_start_polling(alerts_engine* engine, const char* url, int interval_seconds) {
+    if (!engine || !url || interval_seconds <= 0) {
+        return -1;
+    }
+    // The poller starts by taking the lock, so it only runs once the flags and the thread object are set.
+    std::lock_guard<std::mutex> guard(engine->mutex);
+    if (engine->polling) {
+        return -1;
+    }
+    try {
+        engine->polling = true;
+        engine->stopping = false;
+        engine->poller = std::thread([engine, source_url = std::string(url), interval_seconds] {
+            alerts::HttpFeedSource source(source_url);
+            alerts::FetchResult fetched;
+            std::unique_lock<std::mutex> lock(engine->mutex);
+            engine->source = &source;
+            while (!engine->stopping) {
+                lock.unlock();
+                if (source.fetch(fetched)) {
+                    try {
+                        feed_engine(engine, fetched.body.data(), fetched.body.size(), fetched.time, true);
+                    } catch (...) {
+                        // Out of memory: try again at the next poll.
+                    }
+                    source.set_delta_cursor(engine->engine.delta_cursor());
+                }
+                lock.lock();
+                engine->wakeup.wait_for(lock, std::chrono::seconds(interval_seconds),
+                                        [engine] { return engine->stopping; });
+            }
+            engine->source = nullptr;
+        });
+        return 0;
+    } catch (...) {
+        engine->polling = false;
+        return -1;
+    }
+}
+
+void alerts_engine_stop_polling(alerts_engine* engine) {
+    if (!engine) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        if (!engine->polling || engine->stopping) {
+            return; // not polling, or another thread is stopping it
+        }
+        engine->stopping = true;
+        if (engine->source) {
+            engine->source->abort(); // a fetch in flight returns at once
+        }
+    }
+    engine->wakeup.notify_all();
+    engine->poller.join();
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->polling = false;
+}
+
+} // extern "C"
@@ -0,0 +1,55 @@
+#include "alerts/arena.h"
+#include <algorithm>
+
+namespace alerts {
+
+Arena::Arena(std::size_t chunk_size) {
+    add_chunk(chunk_size);
+}
+
+Arena::~Arena() {
+    for (char* chunk : chunks_) {
+        ::operator delete(chunk);
+    }
+}
+
+void Arena::add_chunk(std::size_t size) {
+    // operator new returns memory aligned for any fundamental type, which is all allocate() promises.
+    chunks_.push_back(static_cast<char*>(::operator new(size)));
+    chunk_sizes_.push_back(size);
+    data_ = chunks_.back();
+    size_ = size;
+    used_ = 0;
+    ++heap_allocations_;
+}
+
+void* Arena::allocate_slow(std::size_t size, std::size_t alignment) {
+    retired_ += used_;
+    // Doubling alone never leaves a zero-sized first chunk, nor fits an allocation more than twice its size.
+    add_chunk(std::max(size_ * 2, size + alignment));
+    return allocate(size, alignment);
+}
+
+void Arena::reset() {
+    if (chunks_.size() > 1) {
+        std::size_t total = capacity();
+        for (char* chunk : chunks_) {
+            ::operator delete(chunk);
+        }
+        chunks_.clear();
+        chunk_sizes_.clear();
+        add_chunk(total);
+    }
+    used_ = 0;
+    retired_ = 0;
+}
+
+std::size_t Arena::capacity() const {
+    std::size_t total = 0;
+    for (std::size_t size : chunk_sizes_) {
+        total += size;
+    }
+    return total;
+}
+
+} // namespace alerts
@@ -0,0 +1,186 @@
+#include "alerts/binary_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace alerts {
+
+namespace {
+
+const char kMagic[4] = {'A', 'L', 'S', 'S'};
+const std::size_t kNameCapacity = sizeof(BinaryRegionRecord::name);
+
+/// The longest prefix of a name that fits in a record without splitting a UTF-8 character.
+std::size_t fitting_size(const std::string& name) {
+    if (name.size() <= kNameCapacity) {
+        return name.size();
+    }
+    std::size_t size = kNameCapacity;
+    while (size > 0 && (static_cast<unsigned char>(name[size]) & 0xc0) == 0x80) {
+        --size;
+    }
+    return size;
+}
+
+} // namespace
+
+std::size_t encode_binary_snapshot(const RegionRegistry& regions, const StateStore& state, std::int64_t time,
+                                   std::uint64_t sequence, std::string& out) {
+    std::size_t count = regions.size();
+    out.assign(sizeof(BinarySnapshotHeader) + count * sizeof(BinaryRegionRecord), '\0');
+
+    BinarySnapshotHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.byte_order = kBinarySnapshotByteOrder;
+    header.version = kBinarySnapshotVersion;
+    header.header_size = sizeof(BinarySnapshotHeader);
+    header.record_size = sizeof(BinaryRegionRecord);
+    header.name_capacity = kNameCapacity;
+    header.region_count = std::uint32_t(count);
+    header.time = time;
+    header.sequence = sequence;
+    std::memcpy(&out[0], &header, sizeof(header));
+
+    char* records = &out[sizeof(BinarySnapshotHeader)];
+    std::size_t truncated = 0;
+    for (std::size_t id = 0; id < count; ++id) {
+        RegionId region = RegionId(id);
+        BinaryRegionRecord record = {};
+        record.changed_at = state.changed_at(region);
+        record.status = std::uint8_t(state.status(region));
+        record.alert_active = state.alert_active(region) ? 1 : 0;
+        const std::string& name = regions.name(region);
+        record.name_size = std::uint8_t(fitting_size(name));
+        if (record.name_size < name.size()) {
+            record.flags = kBinaryNameTruncated;
+            ++truncated;
+        }
+        std::memcpy(record.name, name.data(), record.name_size);
+        std::memcpy(records + id * sizeof(BinaryRegionRecord), &record, sizeof(record));
+    }
+    return truncated;
+}
+
+bool write_binary_snapshot_file(const std::string& path, const std::string& block, std::string& error) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(block.data(), std::streamsize(block.size()));
+        out.flush();
+        if (!out) {
+            error = "Failed to write snapshot file " + temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = "Failed to replace snapshot file " + path;
+        return false;
+    }
+    return true;
+}
+
+bool BinarySnapshotView::validate(const void* data, std::size_t size, std::string& error) {
+    header_ = nullptr;
+    records_ = nullptr;
+    if (size < sizeof(BinarySnapshotHeader)) {
+        error = "binary snapshot: truncated header";
+        return false;
+    }
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(BinarySnapshotHeader) != 0) {
+        error = "binary snapshot: misaligned buffer";
+        return false;
+    }
+    const BinarySnapshotHeader* header = static_cast<const BinarySnapshotHeader*>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        error = "binary snapshot: bad magic";
+        return false;
+    }
+    if (header->byte_order != kBinarySnapshotByteOrder) {
+        error = "binary snapshot: foreign byte order";
+        return false;
+    }
+    if (header->version != kBinarySnapshotVersion || header->header_size != sizeof(BinarySnapshotHeader) ||
+        header->record_size != sizeof(BinaryRegionRecord) || header->name_capacity != kNameCapacity) {
+        error = "binary snapshot: unsupported format version " + std::to_string(header->version);
+        return false;
+    }
+    if (size != sizeof(BinarySnapshotHeader) + std::uint64_t(header->region_count) * sizeof(BinaryRegionRecord)) {
+        error = "binary snapshot: length does not match the region count";
+        return false;
+    }
+    header_ = header;
+    records_ = reinterpret_cast<const BinaryRegionRecord*>(header + 1);
+    return true;
+}
+
+std::string BinarySnapshotView::name(std::size_t index) const {
+    const BinaryRegionRecord& region = records_[index];
+    return std::string(region.name, std::min<std::size_t>(region.name_size, kNameCapacity));
+}
+
+Status BinarySnapshotView::status(std::size_t index) const {
+    std::uint8_t value = records_[index].status;
+    return value <= std::uint8_t(Status::Unknown) ? Status(value) : Status::Unknown;
+}
+
+void BinarySnapshotView::read(RegionRegistry& regions, Snapshot& snapshot) const {
+    snapshot.readings.clear();
+    snapshot.time = header_ ? header_->time : 0;
+    for (std::size_t index = 0; index < size(); ++index) {
+        const BinaryRegionRecord& region = records_[index];
+        if (name_truncated(index)) {
+            continue;
+        }
+        RegionId id = regions.intern(region.name, std::min<std::size_t>(region.name_size, kNameCapacity));
+        snapshot.readings.push_back({id, status(index)});
+    }
+}
+
+MappedBinarySnapshot::~MappedBinarySnapshot() {
+    unmap();
+}
+
+void MappedBinarySnapshot::unmap() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    view_ = BinarySnapshotView();
+}
+
+bool MappedBinarySnapshot::open(const std::string& path, std::string& error) {
+    unmap();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Failed to open snapshot file " + path;
+        return false;
+    }
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        error = "Failed to read snapshot file " + path;
+        return false;
+    }
+    void* data = mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        error = "Failed to map snapshot file " + path;
+        return false;
+    }
+    data_ = data;
+    size_ = std::size_t(st.st_size);
+    if (!view_.validate(data_, size_, error)) {
+        error = path + ": " + error;
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,85 @@
+#include "alerts/config.h"
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include "alerts/json_scanner.h"
+
+namespace alerts {
+
+bool load_config(const std::string& path, Config& config, std::string& error) {
+    std::ifstream config_file(path, std::ios::binary);
+    if (!config_file) {
+        error = "Failed to open config file: " + path;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(config_file)), std::istreambuf_iterator<char>());
+
+    JsonObjectScanner scanner(text.data(), text.size());
+    JsonMember member;
+    while (scanner.next(member)) {
+        std::string key(member.key, member.key_size);
+        std::string value(member.value, member.value_size);
+        int* number = key == "update_interval" ? &config.update_interval
+                     : key == "drain_timeout" ? &config.drain_timeout
+                     : key == "stale_after" ? &config.stale_after
+                     : key == "watchdog_timeout" ? &config.watchdog_timeout
+                     : key == "max_requests_per_minute" ? &config.max_requests_per_minute
+                     : key == "upstream_period" ? &config.upstream_period
+                     : key == "repeat_after" ? &config.repeat_after
+                     : nullptr;
+        if (number) {
+            if (member.type != JsonType::Number) {
+                error = "Failed to parse config file " + path + ": " + key + " must be a number";
+                return false;
+            }
+            errno = 0;
+            long parsed = std::strtol(value.c_str(), nullptr, 10);
+            bool zero_allowed = number != &config.update_interval && number != &config.watchdog_timeout;
+            if (errno || parsed < 0 || parsed > 86400 || (parsed == 0 && !zero_allowed)) {
+                error = "Failed to parse config file " + path + ": " + key + " is out of range";
+                return false;
+            }
+            *number = int(parsed);
+            continue;
+        }
+        std::string* field = key == "region" ? &config.region
+                           : key == "alert_on" ? &config.alert_on
+                           : key == "alert_off" ? &config.alert_off
+                           : key == "data_url" ? &config.data_url
+                           : key == "state_file" ? &config.state_file
+                           : key == "snapshot_file" ? &config.snapshot_file
+                           : key == "multicast" ? &config.multicast
+                           : key == "multicast_key" ? &config.multicast_key
+                           : key == "multicast_role" ? &config.multicast_role
+                           : key == "leader_lease" ? &config.leader_lease
+                           : key == "seat_socket" ? &config.seat_socket
+                           : nullptr;
+        if (!field) {
+            continue; // unknown settings are ignored, as before
+        }
+        if (member.type != JsonType::String) {
+            error = "Failed to parse config file " + path + ": " + key + " must be a string";
+            return false;
+        }
+        *field = value;
+    }
+    if (scanner.failed()) {
+        error = "Failed to parse config file " + path + ": not a valid JSON object";
+        return false;
+    }
+    if (config.multicast_role != "publish" && config.multicast_role != "listen" && config.multicast_role != "elect") {
+        error = "Failed to parse config file " + path + ": multicast_role must be \"publish\", \"listen\" or \"elect\"";
+        return false;
+    }
+    if (!config.multicast.empty() && config.multicast_key.empty()) {
+        error = "Failed to parse config file " + path + ": multicast needs a multicast_key";
+        return false;
+    }
+    if (config.stale_after == 0) {
+        config.stale_after = 3 * config.update_interval;
+    }
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,276 @@
+#include "alerts/dbus_message.h"
+#include <cstring>
+
+namespace alerts {
+
+namespace {
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+const char kHostEndian = 'l';
+#else
+const char kHostEndian = 'B';
+#endif
+
+/// Header field codes.
+enum : std::uint8_t {
+    kPath = 1,
+    kInterface = 2,
+    kMember = 3,
+    kErrorName = 4,
+    kReplySerial = 5,
+    kDestination = 6,
+    kSender = 7,
+    kSignature = 8,
+};
+
+/// The longest message the specification allows.
+const std::size_t kMaxMessage = std::size_t(1) << 27;
+
+std::uint32_t load_uint32(const char* data, bool swap) {
+    std::uint32_t value;
+    std::memcpy(&value, data, 4);
+    return swap ? __builtin_bswap32(value) : value;
+}
+
+std::size_t align_up(std::size_t at, std::size_t alignment) {
+    return (at + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+void DBusWriter::align(std::size_t alignment) {
+    out_.resize(align_up(out_.size(), alignment), '\0');
+}
+
+void DBusWriter::put_byte(std::uint8_t value) {
+    out_ += char(value);
+}
+
+void DBusWriter::put_uint32(std::uint32_t value) {
+    align(4);
+    out_.append(reinterpret_cast<const char*>(&value), 4);
+}
+
+void DBusWriter::put_string(const char* data, std::size_t size) {
+    put_uint32(std::uint32_t(size));
+    out_.append(data, size);
+    out_ += '\0';
+}
+
+void DBusWriter::put_signature(const char* signature) {
+    std::size_t size = std::strlen(signature);
+    out_ += char(size);
+    out_.append(signature, size + 1);
+}
+
+DBusArray DBusWriter::open_array(std::size_t alignment) {
+    DBusArray array;
+    put_uint32(0);
+    array.length_at = out_.size() - 4;
+    align(alignment);
+    array.start = out_.size();
+    return array;
+}
+
+void DBusWriter::close_array(const DBusArray& array) {
+    std::uint32_t length = std::uint32_t(out_.size() - array.start);
+    std::memcpy(&out_[array.length_at], &length, 4);
+}
+
+void DBusWriter::put_field(std::uint8_t code, const char* signature, const std::string& value) {
+    if (value.empty()) {
+        return;
+    }
+    open_struct();
+    put_byte(code);
+    put_variant(signature);
+    if (signature[0] == 'g') {
+        put_signature(value.c_str());
+    } else {
+        put_string(value);
+    }
+}
+
+void DBusWriter::put_field(std::uint8_t code, std::uint32_t value) {
+    if (value == 0) {
+        return;
+    }
+    open_struct();
+    put_byte(code);
+    put_variant("u");
+    put_uint32(value);
+}
+
+void DBusWriter::start(const DBusHeader& header) {
+    out_.clear();
+    out_ += kHostEndian;
+    out_ += char(header.type);
+    out_ += char(header.flags);
+    out_ += char(1); // protocol version
+    put_uint32(0);   // body length, filled in by finish()
+    put_uint32(header.serial);
+    DBusArray fields = open_array(8);
+    put_field(kPath, "o", header.path);
+    put_field(kInterface, "s", header.interface);
+    put_field(kMember, "s", header.member);
+    put_field(kErrorName, "s", header.error_name);
+    put_field(kReplySerial, header.reply_serial);
+    put_field(kDestination, "s", header.destination);
+    put_field(kSender, "s", header.sender);
+    put_field(kSignature, "g", header.signature);
+    close_array(fields);
+    align(8);
+    body_at_ = out_.size();
+}
+
+const std::string& DBusWriter::finish() {
+    std::uint32_t length = std::uint32_t(out_.size() - body_at_);
+    std::memcpy(&out_[4], &length, 4);
+    return out_;
+}
+
+bool parse_dbus_header(const char* data, std::size_t size, DBusHeader& header, std::size_t& length) {
+    length = 0;
+    if (size < 16) {
+        return size == 0 || data[0] == 'l' || data[0] == 'B';
+    }
+    if ((data[0] != 'l' && data[0] != 'B') || data[3] != 1) {
+        return false;
+    }
+    header.swap = data[0] != kHostEndian;
+    std::uint32_t body_size = load_uint32(data + 4, header.swap);
+    std::uint32_t fields_size = load_uint32(data + 12, header.swap);
+    if (body_size > kMaxMessage || fields_size > kMaxMessage) {
+        return false;
+    }
+    std::size_t body_at = align_up(16 + fields_size, 8);
+    if (size < body_at + body_size) {
+        return true; // incomplete
+    }
+    header.type = DBusType(data[1]);
+    header.flags = std::uint8_t(data[2]);
+    header.serial = load_uint32(data + 8, header.swap);
+    header.reply_serial = 0;
+    for (std::string* field : {&header.path, &header.interface, &header.member, &header.error_name,
+                               &header.destination, &header.sender, &header.signature}) {
+        field->clear();
+    }
+    header.body_at = body_at;
+    header.body_size = body_size;
+
+    // The fields, read as a body that spans them.
+    DBusHeader fields;
+    fields.body_at = 16;
+    fields.body_size = fields_size;
+    fields.swap = header.swap;
+    DBusReader reader(data, fields);
+    while (reader.position() < 16 + fields_size) {
+        std::uint8_t code;
+        std::string signature;
+        if (!reader.open_struct() || !reader.get_byte(code) || !reader.get_signature(signature) ||
+            signature.size() != 1) {
+            return false;
+        }
+        std::uint32_t number = 0;
+        std::string text;
+        bool ok = signature[0] == 'u' ? reader.get_uint32(number)
+                : signature[0] == 'g' ? reader.get_signature(text)
+                : signature[0] == 's' || signature[0] == 'o' ? reader.get_string(text)
+                : false;
+        if (!ok) {
+            return false;
+        }
+        switch (code) {
+        case kPath: header.path = text; break;
+        case kInterface: header.interface = text; break;
+        case kMember: header.member = text; break;
+        case kErrorName: header.error_name = text; break;
+        case kReplySerial: header.reply_serial = number; break;
+        case kDestination: header.destination = text; break;
+        case kSender: header.sender = text; break;
+        case kSignature: header.signature = text; break;
+        default: break; // unknown fields are ignored
+        }
+    }
+    length = body_at + body_size;
+    return true;
+}
+
+bool DBusReader::align(std::size_t alignment) {
+    std::size_t at = align_up(at_, alignment);
+    if (at > end_) {
+        at_ = end_ + 1;
+        return false;
+    }
+    at_ = at;
+    return true;
+}
+
+bool DBusReader::get_byte(std::uint8_t& value) {
+    if (at_ + 1 > end_) {
+        at_ = end_ + 1;
+        return false;
+    }
+    value = std::uint8_t(data_[at_++]);
+    return true;
+}
+
+bool DBusReader::get_uint32(std::uint32_t& value) {
+    if (!align(4) || at_ + 4 > end_) {
+        at_ = end_ + 1;
+        return false;
+    }
+    value = load_uint32(data_ + at_, swap_);
+    at_ += 4;
+    return true;
+}
+
+bool DBusReader::get_int32(std::int32_t& value) {
+    std::uint32_t bits;
+    if (!get_uint32(bits)) {
+        return false;
+    }
+    value = std::int32_t(bits);
+    return true;
+}
+
+bool DBusReader::get_string(std::string& value) {
+    std::uint32_t size;
+    if (!get_uint32(size) || size >= end_ - at_ || data_[at_ + size] != '\0') {
+        at_ = end_ + 1;
+        return false;
+    }
+    value.assign(data_ + at_, size);
+    at_ += size + 1;
+    return true;
+}
+
+bool DBusReader::get_signature(std::string& value) {
+    std::uint8_t size;
+    if (!get_byte(size) || size >= end_ - at_ || data_[at_ + size] != '\0') {
+        at_ = end_ + 1;
+        return false;
+    }
+    value.assign(data_ + at_, size);
+    at_ += size + 1;
+    return true;
+}
+
+bool DBusReader::get_array_size(std::size_t alignment, std::uint32_t& size) {
+    if (!get_uint32(size) || !align(alignment) || size > end_ - at_) {
+        at_ = end_ + 1;
+        return false;
+    }
+    return true;
+}
+
+bool DBusReader::skip(std::size_t size) {
+    if (at_ > end_ || size > end_ - at_) {
+        at_ = end_ + 1;
+        return false;
+    }
+    at_ += size;
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,419 @@
+#include "alerts/dbus_notifier.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace alerts {
+
+namespace {
+
+const char kNotifications[] = "org.freedesktop.Notifications";
+const int kConnectTimeoutMs = 2000;
+
+/// Urgency levels of the Notifications specification.
+const std::uint8_t kNormalUrgency = 1;
+const std::uint8_t kCriticalUrgency = 2;
+
+/// The reason NotificationClosed gives for a notification the user dismissed.
+const std::uint32_t kDismissedByUser = 2;
+
+/// Decodes the %XX escapes of an address value.
+std::string unescape(const std::string& value) {
+    std::string out;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            out += char(std::strtol(value.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            out += value[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Finds the first unix socket in a bus address list ("unix:path=/run/user/1000/bus;...").
+ * @param abstract Set if the name is in the abstract namespace.
+ * @return The socket path or abstract name; empty if there is none.
+ */
+std::string socket_path(const std::string& address, bool& abstract) {
+    std::size_t at = 0;
+    while (at < address.size()) {
+        std::size_t end = address.find(';', at);
+        std::string entry = address.substr(at, end == std::string::npos ? std::string::npos : end - at);
+        at = end == std::string::npos ? address.size() : end + 1;
+        if (entry.compare(0, 5, "unix:") != 0) {
+            continue;
+        }
+        std::size_t key = 5;
+        while (key < entry.size()) {
+            std::size_t comma = entry.find(',', key);
+            std::string pair = entry.substr(key, comma == std::string::npos ? std::string::npos : comma - key);
+            key = comma == std::string::npos ? entry.size() : comma + 1;
+            for (const char* name : {"path=", "abstract="}) {
+                if (pair.compare(0, std::strlen(name), name) == 0) {
+                    abstract = name[0] == 'a';
+                    return unescape(pair.substr(std::strlen(name)));
+                }
+            }
+        }
+    }
+    return "";
+}
+
+int milliseconds_until(std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return left.count() > 0 ? int(left.count()) : 0;
+}
+
+} // namespace
+
+DBusNotifier::DBusNotifier(std::string app_name, std::string address)
+    : app_name_(std::move(app_name)), address_(std::move(address)) {
+    call_.type = DBusType::MethodCall;
+    call_.path = "/org/freedesktop/Notifications";
+    call_.interface = kNotifications;
+    call_.member = "Notify";
+    call_.destination = kNotifications;
+    call_.signature = "susssasa{sv}i";
+}
+
+DBusNotifier::~DBusNotifier() {
+    disconnect();
+}
+
+bool DBusNotifier::connect(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fd_ >= 0 || connect_locked(error);
+}
+
+bool DBusNotifier::connect_locked(std::string& error) {
+    std::string address = address_;
+    if (address.empty()) {
+        const char* session = std::getenv("DBUS_SESSION_BUS_ADDRESS");
+        const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+        address = session ? session : runtime ? std::string("unix:path=") + runtime + "/bus" : "";
+    }
+    bool abstract = false;
+    std::string path = socket_path(address, abstract);
+    sockaddr_un socket_address{};
+    if (path.empty() || path.size() + abstract >= sizeof(socket_address.sun_path)) {
+        error = address.empty() ? "No session bus" : "Unsupported bus address " + address;
+        return false;
+    }
+    socket_address.sun_family = AF_UNIX;
+    std::memcpy(socket_address.sun_path + abstract, path.data(), path.size());
+    socklen_t length = socklen_t(offsetof(sockaddr_un, sun_path) + abstract + path.size() + !abstract);
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&socket_address), length) != 0) {
+        error = "Cannot connect to the bus at " + address + ": " + std::strerror(errno);
+        disconnect();
+        return false;
+    }
+
+    // SASL EXTERNAL: the bus checks the credentials of the socket against the user ID sent in hex.
+    std::string uid = std::to_string(geteuid());
+    std::string auth(1, '\0');
+    auth += "AUTH EXTERNAL ";
+    for (char digit : uid) {
+        auth += "3";
+        auth += digit;
+    }
+    auth += "\r\n";
+    std::string line;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kConnectTimeoutMs);
+    if (send(auth)) {
+        char c;
+        while (line.size() < 512 && (line.size() < 2 || line.compare(line.size() - 2, 2, "\r\n") != 0)) {
+            pollfd ready{fd_, POLLIN, 0};
+            if (poll(&ready, 1, milliseconds_until(deadline)) <= 0 || recv(fd_, &c, 1, 0) != 1) {
+                break;
+            }
+            line += c;
+        }
+    }
+    if (line.compare(0, 3, "OK ") != 0) {
+        error = "The bus at " + address + " did not accept us" + (line.empty() ? "" : ": " + line.substr(0, 64));
+        disconnect();
+        return false;
+    }
+
+    // Every connection has to say Hello before anything else; the reply names the connection.
+    DBusHeader hello;
+    hello.type = DBusType::MethodCall;
+    hello.serial = next_serial_++;
+    hello.path = "/org/freedesktop/DBus";
+    hello.interface = "org.freedesktop.DBus";
+    hello.member = "Hello";
+    hello.destination = "org.freedesktop.DBus";
+    writer_.start(hello);
+    awaited_serial_ = hello.serial;
+    error_name_.clear();
+    if (!send("BEGIN\r\n") || !send(writer_.finish()) || !read_replies(kConnectTimeoutMs) ||
+        awaited_serial_ != 0 || !error_name_.empty()) {
+        error = "The bus at " + address + " did not answer" + (error_name_.empty() ? "" : ": " + error_name_);
+        disconnect();
+        return false;
+    }
+
+    if (on_ack_) {
+        // The service's signals are only routed to connections that ask for them.
+        DBusHeader match;
+        match.type = DBusType::MethodCall;
+        match.serial = next_serial_++;
+        match.path = "/org/freedesktop/DBus";
+        match.interface = "org.freedesktop.DBus";
+        match.member = "AddMatch";
+        match.destination = "org.freedesktop.DBus";
+        match.signature = "s";
+        writer_.start(match);
+        writer_.put_string(std::string("type='signal',interface='") + kNotifications + "'");
+        send(writer_.finish());
+    }
+    if (loop_) {
+        loop_->watch_fd(fd_, EPOLLIN, [this](std::uint32_t) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            read_replies(0);
+        });
+    }
+    return true;
+}
+
+void DBusNotifier::disconnect() {
+    if (fd_ >= 0) {
+        if (loop_) {
+            loop_->unwatch_fd(fd_);
+        }
+        close(fd_);
+    }
+    fd_ = -1;
+    input_.clear();
+    awaited_serial_ = 0;
+    unanswered_.clear(); // their notifications, if shown, are not known; the region's next one stacks
+}
+
+bool DBusNotifier::send(const std::string& message) {
+    const char* data = message.data();
+    std::size_t size = message.size();
+    while (size > 0) {
+        ssize_t n = ::send(fd_, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= std::size_t(n);
+    }
+    return true;
+}
+
+bool DBusNotifier::read_replies(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    char buffer[4096];
+    while (fd_ >= 0) {
+        // Only wait while a reply is awaited; otherwise take what has arrived.
+        pollfd ready{fd_, POLLIN, 0};
+        int result = poll(&ready, 1, awaited_serial_ ? milliseconds_until(deadline) : 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return result == 0;
+        }
+        ssize_t n = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            disconnect();
+            return false;
+        }
+        input_.append(buffer, std::size_t(n));
+        std::size_t at = 0;
+        std::size_t length = 0;
+        while (true) {
+            if (!parse_dbus_header(input_.data() + at, input_.size() - at, reply_, length)) {
+                disconnect();
+                return false;
+            }
+            if (length == 0) {
+                break;
+            }
+            handle(input_.data() + at);
+            at += length;
+        }
+        input_.erase(0, at);
+    }
+    return false;
+}
+
+void DBusNotifier::handle(const char* message) {
+    if (reply_.type == DBusType::Signal) {
+        if (reply_.interface == kNotifications) {
+            handle_signal(message);
+        }
+        return; // others, such as NameAcquired
+    }
+    if (reply_.type != DBusType::MethodReturn && reply_.type != DBusType::Error) {
+        return;
+    }
+    auto call = unanswered_.find(reply_.reply_serial);
+    if (call != unanswered_.end() && reply_.type == DBusType::MethodReturn && reply_.signature == "u") {
+        // Notify returns the ID of the notification, which now shows the region, or the staleness.
+        std::uint32_t id = 0;
+        DBusReader reader(message, reply_);
+        if (reader.get_uint32(id) && call->second.stale) {
+            stale_id_ = id;
+            reported_ = false;
+        } else if (!call->second.stale && id != 0) {
+            const Transition& transition = call->second.transition;
+            std::uint32_t& region_id = ids_[transition.region];
+            if (region_id != id) {
+                shown_.erase(region_id);
+            }
+            region_id = id;
+            shown_[id] = transition;
+            last_id_ = id;
+            reported_ = false;
+        }
+    }
+    if (call != unanswered_.end()) {
+        unanswered_.erase(call);
+    }
+    if (reply_.type == DBusType::Error && !reported_) {
+        std::cerr << "Desktop notification not shown: " << reply_.error_name << std::endl;
+        reported_ = true;
+    }
+    if (reply_.reply_serial == awaited_serial_) {
+        awaited_serial_ = 0;
+        error_name_ = reply_.type == DBusType::Error ? reply_.error_name : std::string();
+    }
+}
+
+void DBusNotifier::handle_signal(const char* message) {
+    DBusReader reader(message, reply_);
+    std::uint32_t id;
+    if (!reader.get_uint32(id)) {
+        return;
+    }
+    if (id == stale_id_ && reply_.member == "NotificationClosed") {
+        stale_id_ = 0;
+        return;
+    }
+    auto shown = shown_.find(id);
+    if (shown == shown_.end()) {
+        return; // about a notification of another client, or one already replaced
+    }
+    Transition transition = shown->second;
+    bool acknowledged = reply_.member == "ActionInvoked";
+    std::uint32_t reason;
+    if (reply_.member == "NotificationClosed" && reader.get_uint32(reason)) {
+        // A closed notification cannot be replaced; the region's next transition gets a new one.
+        shown_.erase(shown);
+        ids_.erase(transition.region);
+        if (last_id_ == id) {
+            last_id_ = 0;
+        }
+        acknowledged = reason == kDismissedByUser;
+    }
+    if (acknowledged && on_ack_ && transition.kind == TransitionKind::AlertOn) {
+        on_ack_(transition);
+    }
+}
+
+void DBusNotifier::notify(const Transition& transition, const std::string& region) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool raised = transition.kind == TransitionKind::AlertOn;
+    format_alert_text(transition.kind, region, title_, message_);
+    Call call;
+    call.transition = transition;
+    send_notify(call, raised, raised ? "dialog-warning" : "dialog-information");
+}
+
+void DBusNotifier::data_stale(bool stale, std::chrono::seconds age) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    format_stale_text(stale, age, title_, message_);
+    Call call;
+    call.stale = true;
+    send_notify(call, stale, stale ? "dialog-error" : "dialog-information");
+}
+
+void DBusNotifier::send_notify(const Call& call, bool urgent, const char* icon) {
+    // Only a raised alert can be acknowledged.
+    bool acknowledgeable = !call.stale && call.transition.kind == TransitionKind::AlertOn && on_ack_;
+    // A connection that broke since the last call is found out by the write; reconnect and try once more.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::string error;
+        if (fd_ < 0 && !connect_locked(error)) {
+            if (!reported_) {
+                std::cerr << "Desktop notification not shown: " << error << std::endl;
+                reported_ = true;
+            }
+            return;
+        }
+        read_replies(0); // the ID of the notification to replace
+        std::uint32_t replaces_id = stale_id_;
+        if (!call.stale) {
+            auto shown = ids_.find(call.transition.region);
+            replaces_id = shown != ids_.end() ? shown->second : 0;
+        }
+
+        call_.serial = next_serial_++;
+        writer_.start(call_);
+        writer_.put_string(app_name_);
+        writer_.put_uint32(replaces_id);
+        writer_.put_string(icon);
+        writer_.put_string(title_);
+        writer_.put_string(message_);
+        DBusArray actions = writer_.open_array(4);
+        if (acknowledgeable) {
+            writer_.put_string("default"); // a click on the notification itself
+            writer_.put_string("Прийнято");
+        }
+        writer_.close_array(actions);
+        DBusArray hints = writer_.open_array(8);
+        writer_.open_struct();
+        writer_.put_string("urgency", 7);
+        writer_.put_variant("y");
+        writer_.put_byte(urgent ? kCriticalUrgency : kNormalUrgency);
+        writer_.close_array(hints);
+        writer_.put_int32(urgent ? 0 : -1); // a raised alert, or stale data, stays until dismissed
+        if (send(writer_.finish())) {
+            awaited_serial_ = call_.serial;
+            unanswered_[call_.serial] = call;
+            ++sent_;
+            return;
+        }
+        disconnect();
+    }
+}
+
+bool DBusNotifier::drain(std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        read_replies(milliseconds_until(deadline));
+    }
+    return awaited_serial_ == 0;
+}
+
+std::uint64_t DBusNotifier::sent() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sent_;
+}
+
+std::uint32_t DBusNotifier::last_id() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_id_;
+}
+
+} // namespace alerts
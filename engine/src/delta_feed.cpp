@@ -0,0 +1,251 @@
+#include "alerts/delta_feed.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace alerts {
+
+const char* const kDeltaContentType = "application/x-alerts-delta";
+
+namespace {
+
+const char kMagic[4] = {'A', 'L', 'D', '1'};
+
+void put_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(char(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(char(value));
+}
+
+/// Bounds-checked reading of a body; every read fails once the end is passed.
+struct Reader {
+    const unsigned char* at;
+    const unsigned char* end;
+
+    bool varint(std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && at < end; shift += 7) {
+            unsigned char byte = *at++;
+            value |= std::uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool bytes(std::size_t size, const char*& data) {
+        if (std::size_t(end - at) < size) {
+            return false;
+        }
+        data = reinterpret_cast<const char*>(at);
+        at += size;
+        return true;
+    }
+};
+
+using Names = ArenaVector<std::pair<const char*, std::size_t>>;
+using Entries = ArenaVector<std::pair<std::uint64_t, Status>>;
+
+/// A parsed body, pointing into the buffer it was read from. Names and entries are only kept if asked for.
+struct Body {
+    DeltaCursor cursor;
+    std::uint64_t base = 0;
+    std::uint64_t first = 0;
+    Names* names = nullptr;
+    Entries* entries = nullptr;
+};
+
+bool parse(const char* data, std::size_t size, Body& body) {
+    if (!DeltaDecoder::is_delta(data, size) || size < sizeof(kMagic) + 4) {
+        return false;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    body.cursor.epoch = std::uint32_t(bytes[4]) | std::uint32_t(bytes[5]) << 8 | std::uint32_t(bytes[6]) << 16 |
+                        std::uint32_t(bytes[7]) << 24;
+    Reader reader{bytes + 8, bytes + size};
+    std::uint64_t count = 0;
+    if (!reader.varint(body.base) || !reader.varint(body.cursor.version) || !reader.varint(body.first) ||
+        !reader.varint(count) || body.cursor.version == 0 || body.base > body.cursor.version) {
+        return false;
+    }
+    if (body.names) {
+        body.names->reserve(std::size_t(std::min<std::uint64_t>(count, size)));
+    }
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t length = 0;
+        const char* name = nullptr;
+        if (!reader.varint(length) || !reader.bytes(length, name)) {
+            return false;
+        }
+        if (body.names) {
+            body.names->emplace_back(name, length);
+        }
+    }
+    if (!reader.varint(count)) {
+        return false;
+    }
+    if (body.entries) {
+        body.entries->reserve(std::size_t(std::min<std::uint64_t>(count, size)));
+    }
+    std::uint64_t next = 0; // the first region an entry may name
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t packed = 0;
+        if (!reader.varint(packed) || (packed & 7) > std::uint64_t(Status::Unknown)) {
+            return false;
+        }
+        std::uint64_t region = next + (packed >> 3);
+        if (region < next || region > 0xffff) {
+            return false;
+        }
+        if (body.entries) {
+            body.entries->emplace_back(region, Status(packed & 7));
+        }
+        next = region + 1;
+    }
+    return reader.at == reader.end;
+}
+
+} // namespace
+
+std::string DeltaCursor::to_string() const {
+    return std::to_string(epoch) + "." + std::to_string(version);
+}
+
+bool DeltaCursor::parse(const std::string& text) {
+    char* dot = nullptr;
+    unsigned long long parsed_epoch = std::strtoull(text.c_str(), &dot, 10);
+    char* end = nullptr;
+    unsigned long long parsed_version = *dot == '.' ? std::strtoull(dot + 1, &end, 10) : 0;
+    if (*dot != '.' || end == dot + 1 || *end || parsed_epoch > 0xffffffffull) {
+        epoch = 0;
+        version = 0;
+        return false;
+    }
+    epoch = std::uint32_t(parsed_epoch);
+    version = parsed_version;
+    return true;
+}
+
+DeltaPublisher::DeltaPublisher() {
+    std::random_device random;
+    epoch_ = std::uint32_t(random()) ^
+             std::uint32_t(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void DeltaPublisher::publish(const Snapshot& snapshot, const RegionRegistry& regions) {
+    std::uint64_t next = version_ + 1;
+    bool changed = false;
+    for (std::size_t id = names_.size(); id < regions.size(); ++id) {
+        names_.push_back(regions.name(RegionId(id)));
+        named_at_.push_back(next);
+        statuses_.push_back(Status::Unknown);
+        changed_at_.push_back(0);
+        changed = true;
+    }
+    for (const RegionReading& reading : snapshot.readings) {
+        if (reading.region < statuses_.size() && statuses_[reading.region] != reading.status) {
+            statuses_[reading.region] = reading.status;
+            changed_at_[reading.region] = next;
+            changed = true;
+        }
+    }
+    if (changed) {
+        version_ = next;
+    }
+}
+
+void DeltaPublisher::encode(const DeltaCursor& since, std::string& out) const {
+    bool full = since.epoch != epoch_ || since.version == 0 || since.version > version_;
+    std::uint64_t base = full ? 0 : since.version;
+    out.assign(kMagic, sizeof(kMagic));
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(char(epoch_ >> shift));
+    }
+    put_varint(out, base);
+    put_varint(out, version_);
+
+    // Names were published in order, so the new ones are a suffix.
+    std::size_t first = std::size_t(std::upper_bound(named_at_.begin(), named_at_.end(), base) - named_at_.begin());
+    put_varint(out, first);
+    put_varint(out, names_.size() - first);
+    for (std::size_t id = first; id < names_.size(); ++id) {
+        put_varint(out, names_[id].size());
+        out += names_[id];
+    }
+
+    std::size_t count = 0;
+    for (std::size_t id = 0; id < statuses_.size(); ++id) {
+        count += changed_at_[id] > base;
+    }
+    put_varint(out, count);
+    std::size_t next = 0;
+    for (std::size_t id = 0; id < statuses_.size(); ++id) {
+        if (changed_at_[id] > base) {
+            put_varint(out, std::uint64_t(id - next) << 3 | std::uint64_t(statuses_[id]));
+            next = id + 1;
+        }
+    }
+}
+
+bool DeltaDecoder::is_delta(const char* data, std::size_t size) {
+    return size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool DeltaDecoder::validate(const char* data, std::size_t size, DeltaCursor& cursor) {
+    Body body;
+    if (!parse(data, size, body)) {
+        return false;
+    }
+    cursor = body.cursor;
+    return true;
+}
+
+bool DeltaDecoder::decode(const char* data, std::size_t size, RegionRegistry& regions, Snapshot& snapshot,
+                          Arena* arena) {
+    snapshot.readings.clear();
+    if (!arena) {
+        scratch_.reset();
+        arena = &scratch_;
+    }
+    Names names{ArenaAllocator<Names::value_type>(*arena)};
+    Entries entries{ArenaAllocator<Entries::value_type>(*arena)};
+    Body body;
+    body.names = &names;
+    body.entries = &entries;
+    if (!parse(data, size, body)) {
+        return false;
+    }
+    // A delta only applies on top of the snapshot it was computed from, and brings the names that follow
+    // the ones already known; a full snapshot starts over.
+    bool full = body.base == 0;
+    if (!full && (body.cursor.epoch != cursor_.epoch || body.base != cursor_.version || body.first != ids_.size())) {
+        return false;
+    }
+    if (full && body.first != 0) {
+        return false;
+    }
+    std::size_t known = full ? names.size() : ids_.size() + names.size();
+    for (const auto& entry : entries) {
+        if (entry.first >= known) {
+            return false;
+        }
+    }
+    if (full) {
+        ids_.clear();
+    }
+    for (const auto& name : names) {
+        ids_.push_back(regions.intern(name.first, name.second));
+    }
+    for (const auto& entry : entries) {
+        snapshot.readings.push_back({ids_[entry.first], entry.second});
+    }
+    cursor_ = body.cursor;
+    return true;
+}
+
+} // namespace alerts
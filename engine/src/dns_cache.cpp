@@ -0,0 +1,170 @@
+#include "alerts/dns_cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+namespace alerts {
+
+namespace {
+
+/// Resolves a host with getaddrinfo(); returns its distinct addresses in the resolver's order.
+std::vector<std::string> resolve(const std::string& host, int port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    addrinfo* results = nullptr;
+    std::vector<std::string> addresses;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+        return addresses;
+    }
+    for (addrinfo* result = results; result; result = result->ai_next) {
+        char text[INET6_ADDRSTRLEN] = "";
+        const void* address = result->ai_family == AF_INET6
+            ? static_cast<const void*>(&reinterpret_cast<sockaddr_in6*>(result->ai_addr)->sin6_addr)
+            : static_cast<const void*>(&reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr);
+        if (inet_ntop(result->ai_family, address, text, sizeof(text)) &&
+            std::find(addresses.begin(), addresses.end(), text) == addresses.end()) {
+            addresses.emplace_back(text);
+        }
+    }
+    freeaddrinfo(results);
+    return addresses;
+}
+
+} // namespace
+
+std::string DnsCache::Stats::summary() const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%llu resolutions, %llu failed, mean %.1f ms, max %.1f ms",
+                  (unsigned long long)resolutions, (unsigned long long)failures, mean_seconds() * 1e3,
+                  max_seconds * 1e3);
+    return line;
+}
+
+DnsCache& DnsCache::shared() {
+    static DnsCache cache;
+    return cache;
+}
+
+DnsCache::DnsCache(std::chrono::seconds refresh_interval) : state_(std::make_shared<State>()) {
+    state_->refresh_interval = refresh_interval;
+}
+
+DnsCache::~DnsCache() {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->stopping = true;
+    state_->wakeup.notify_all();
+    // A thread stuck in getaddrinfo() is left to finish on its own; it only touches the shared state.
+    state_->wakeup.wait_for(lock, kStopTimeout, [this] { return !state_->running; });
+}
+
+DnsCache::Entry* DnsCache::State::find(const std::string& host, int port) {
+    for (Entry& entry : entries) {
+        if (entry.port == port && entry.host == host) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void DnsCache::watch(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->find(host, port)) {
+        return;
+    }
+    Entry entry;
+    entry.host = host;
+    entry.port = port;
+    entry.next_refresh = Clock::now();
+    state_->entries.push_back(std::move(entry));
+    if (!state_->running) {
+        state_->running = true;
+        std::thread(&DnsCache::run, state_).detach();
+    }
+    state_->wakeup.notify_all();
+}
+
+std::vector<std::string> DnsCache::addresses(const std::string& host, int port, std::uint64_t& generation) const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (const Entry* entry = state_->find(host, port)) {
+        generation = entry->generation;
+        return entry->addresses;
+    }
+    generation = 0;
+    return {};
+}
+
+void DnsCache::prefer(const std::string& host, int port, const std::string& address) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    Entry* entry = state_->find(host, port);
+    if (!entry) {
+        return;
+    }
+    auto found = std::find(entry->addresses.begin(), entry->addresses.end(), address);
+    if (found != entry->addresses.end() && found != entry->addresses.begin()) {
+        std::rotate(entry->addresses.begin(), found, found + 1);
+        ++entry->generation;
+    }
+}
+
+DnsCache::Stats DnsCache::stats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->stats;
+}
+
+void DnsCache::run(std::shared_ptr<State> state) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->stopping) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point next = now + state->refresh_interval;
+        for (size_t i = 0; i < state->entries.size() && !state->stopping; ++i) {
+            if (state->entries[i].next_refresh > now) {
+                next = std::min(next, state->entries[i].next_refresh);
+                continue;
+            }
+            std::string host = state->entries[i].host;
+            int port = state->entries[i].port;
+            lock.unlock();
+            auto started = Clock::now();
+            std::vector<std::string> addresses = resolve(host, port);
+            double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+            lock.lock();
+
+            Stats& stats = state->stats;
+            ++stats.resolutions;
+            stats.total_seconds += seconds;
+            stats.max_seconds = std::max(stats.max_seconds, seconds);
+            Entry& entry = state->entries[i]; // entries are only appended, so the index is still valid
+            entry.next_refresh = Clock::now() + state->refresh_interval;
+            next = std::min(next, entry.next_refresh);
+            if (addresses.empty()) {
+                ++stats.failures; // keep the addresses we had
+                continue;
+            }
+            // Keep the preferred address in front if it is still valid.
+            if (!entry.addresses.empty()) {
+                auto preferred = std::find(addresses.begin(), addresses.end(), entry.addresses.front());
+                if (preferred != addresses.end()) {
+                    std::rotate(addresses.begin(), preferred, preferred + 1);
+                }
+            }
+            if (addresses != entry.addresses) {
+                entry.addresses = std::move(addresses);
+                ++entry.generation;
+            }
+        }
+        state->wakeup.wait_until(lock, next, [&state] {
+            Clock::time_point now = Clock::now();
+            return state->stopping || std::any_of(state->entries.begin(), state->entries.end(),
+                                                  [&now](const Entry& entry) { return entry.next_refresh <= now; });
+        });
+    }
+    state->running = false;
+    state->wakeup.notify_all();
+}
+
+} // namespace alerts
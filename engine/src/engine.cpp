@@ -0,0 +1,138 @@
+#include "alerts/engine.h"
+#include "alerts/binary_snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace alerts {
+
+void Engine::watch(const std::string& region) {
+    RegionId id = regions_.intern(region);
+    if (watch_mask_.size() <= id) {
+        watch_mask_.resize(size_t(id) + 1, 0);
+    }
+    watch_mask_[id] = 1;
+}
+
+void Engine::add_notifier(std::shared_ptr<Notifier> notifier) {
+    notifiers_.push_back(std::move(notifier));
+}
+
+bool Engine::watched(RegionId region) const {
+    return watch_mask_.empty() || (region < watch_mask_.size() && watch_mask_[region]);
+}
+
+bool Engine::feed(const char* data, std::size_t size, std::int64_t time) {
+    transitions_.clear();
+    arena_.reset();
+    if (!decoder_.decode(data, size, regions_, snapshot_, &arena_)) {
+        return false;
+    }
+    snapshot_.time = time;
+    state_.apply(snapshot_, transitions_);
+    dispatch();
+    return true;
+}
+
+bool Engine::apply_reading(const std::string& region, Status status, std::int64_t time) {
+    transitions_.clear();
+    snapshot_.clear();
+    snapshot_.time = time;
+    snapshot_.readings.push_back(RegionReading{regions_.intern(region), status});
+    state_.apply(snapshot_, transitions_);
+    dispatch();
+    return !transitions_.empty();
+}
+
+void Engine::dispatch() {
+    if (keep_history_) {
+        history_.insert(history_.end(), transitions_.begin(), transitions_.end());
+    }
+    for (const Transition& transition : transitions_) {
+        if (!watched(transition.region)) {
+            continue;
+        }
+        const std::string& name = regions_.name(transition.region);
+        for (const auto& notifier : notifiers_) {
+            notifier->notify(transition, name);
+        }
+    }
+}
+
+bool Engine::poll(FeedSource& source) {
+    if (!source.fetch(fetched_)) {
+        return false;
+    }
+    bool decoded = feed(fetched_.body.data(), fetched_.body.size(), fetched_.time);
+    source.set_delta_cursor(delta_cursor());
+    if (!decoded) {
+        std::cerr << "Failed to decode data from " << source.describe() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Engine::report_stale(bool stale, std::chrono::seconds age) {
+    for (const auto& notifier : notifiers_) {
+        notifier->data_stale(stale, age);
+    }
+}
+
+bool Engine::drain(std::chrono::steady_clock::time_point deadline) {
+    bool drained = true;
+    for (const auto& notifier : notifiers_) {
+        drained = notifier->drain(deadline) && drained;
+    }
+    return drained;
+}
+
+bool Engine::save_state(const std::string& path, std::string& error) const {
+    // One line per region: name, status, alert flag. Written to a temporary file and renamed, so a crash
+    // never leaves a truncated state file behind.
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        for (size_t id = 0; id < regions_.size() && out; ++id) {
+            RegionId region = RegionId(id);
+            out << regions_.name(region) << '\t' << status_name(state_.status(region)) << '\t'
+                << (state_.alert_active(region) ? 1 : 0) << '\n';
+        }
+        out.flush();
+        if (!out) {
+            error = "Failed to write state file " + temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = "Failed to replace state file " + path;
+        return false;
+    }
+    return true;
+}
+
+bool Engine::save_binary_snapshot(const std::string& path, std::string& error) {
+    encode_binary_snapshot(regions_, state_, snapshot_.time, ++binary_sequence_, binary_snapshot_);
+    return write_binary_snapshot_file(path, binary_snapshot_, error);
+}
+
+bool Engine::load_state(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return true;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t first = line.find('\t');
+        size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+        if (second == std::string::npos) {
+            error = "Malformed line in state file " + path + ": " + line;
+            return false;
+        }
+        RegionId region = regions_.intern(line.data(), first);
+        Status status = parse_status(line.data() + first + 1, second - first - 1);
+        state_.restore(region, status, line.compare(second + 1, std::string::npos, "1") == 0);
+    }
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,192 @@
+#include "alerts/event_loop.h"
+#include <cerrno>
+#include <csignal>
+#include <stdexcept>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+namespace alerts {
+
+EventLoop::EventLoop() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)), wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+        if (wake_fd_ >= 0) close(wake_fd_);
+        throw std::runtime_error("Failed to create the event loop");
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+EventLoop::~EventLoop() {
+    if (signal_fd_ >= 0) {
+        close(signal_fd_);
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+EventLoop::TimerId EventLoop::add_timer_at(Clock::time_point when, Callback callback) {
+    TimerId id = next_timer_id_++;
+    timers_.emplace(id, std::move(callback));
+    timer_queue_.emplace(when, id);
+    return id;
+}
+
+void EventLoop::cancel_timer(TimerId id) {
+    // The queue entry is dropped lazily when it comes due.
+    timers_.erase(id);
+}
+
+bool EventLoop::watch_fd(int fd, std::uint32_t events, std::function<void(std::uint32_t)> callback) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return false;
+    }
+    watches_[fd] = std::make_shared<std::function<void(std::uint32_t)>>(std::move(callback));
+    return true;
+}
+
+bool EventLoop::modify_fd(int fd, std::uint32_t events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::unwatch_fd(int fd) {
+    if (watches_.erase(fd)) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+bool EventLoop::watch_signals(const std::vector<int>& signals, std::function<void(int)> callback) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signal : signals) {
+        sigaddset(&mask, signal);
+    }
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        return false;
+    }
+    int fd = signalfd(signal_fd_, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (fd < 0) {
+        return false;
+    }
+    signal_callback_ = std::move(callback);
+    if (signal_fd_ < 0) {
+        signal_fd_ = fd;
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = signal_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, signal_fd_, &event);
+    }
+    return true;
+}
+
+void EventLoop::post(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(std::move(callback));
+    }
+    wake();
+}
+
+void EventLoop::stop() {
+    stopping_ = true;
+    wake();
+}
+
+void EventLoop::wake() {
+    std::uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void EventLoop::run_posted() {
+    std::uint64_t count;
+    while (read(wake_fd_, &count, sizeof(count)) > 0) {
+    }
+    std::vector<Callback> posted;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted.swap(posted_);
+    }
+    for (Callback& callback : posted) {
+        callback();
+    }
+}
+
+void EventLoop::run_due_timers() {
+    Clock::time_point now = Clock::now();
+    while (!timer_queue_.empty() && timer_queue_.begin()->first <= now) {
+        TimerId id = timer_queue_.begin()->second;
+        timer_queue_.erase(timer_queue_.begin());
+        auto it = timers_.find(id);
+        if (it == timers_.end()) {
+            continue; // cancelled
+        }
+        Callback callback = std::move(it->second);
+        timers_.erase(it);
+        callback();
+    }
+}
+
+int EventLoop::next_timeout_ms() const {
+    // Skip entries of cancelled timers, so they do not cause needless wake-ups.
+    for (const auto& entry : timer_queue_) {
+        if (!timers_.count(entry.second)) {
+            continue;
+        }
+        auto delay = entry.first - Clock::now();
+        if (delay <= Clock::duration::zero()) {
+            return 0;
+        }
+        // Round up, so the loop never wakes just before the timer is due.
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(delay).count();
+        return ms > 3600000 ? 3600000 : int(ms);
+    }
+    return -1;
+}
+
+void EventLoop::run() {
+    stopping_ = false;
+    epoll_event events[16];
+    while (!stopping_) {
+        run_due_timers();
+        if (stopping_) {
+            break;
+        }
+        int count = epoll_wait(epoll_fd_, events, 16, next_timeout_ms());
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < count && !stopping_; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                run_posted();
+            } else if (fd == signal_fd_) {
+                signalfd_siginfo info;
+                while (read(signal_fd_, &info, sizeof(info)) == ssize_t(sizeof(info))) {
+                    if (signal_callback_) {
+                        signal_callback_(int(info.ssi_signo));
+                    }
+                }
+            } else {
+                auto it = watches_.find(fd);
+                if (it != watches_.end()) {
+                    auto callback = it->second; // the callback may unwatch its own descriptor
+                    (*callback)(events[i].events);
+                }
+            }
+        }
+    }
+}
+
+} // namespace alerts
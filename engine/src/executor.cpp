@@ -0,0 +1,117 @@
+#include "alerts/executor.h"
+#include <algorithm>
+#include <utility>
+
+namespace alerts {
+
+namespace {
+
+/// The pool and worker index of the calling thread, when it is a worker.
+thread_local const Executor* t_executor = nullptr;
+thread_local std::size_t t_worker = 0;
+
+} // namespace
+
+Executor::Executor(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new Worker);
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&Executor::run, this, i);
+    }
+}
+
+Executor::~Executor() {
+    wait_idle();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void Executor::submit(Task task) {
+    std::size_t index = t_executor == this ? t_worker
+                                           : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    ++pending_;
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->tasks.push_back(std::move(task));
+        ++queued_;
+    }
+    // queued_ and sleepers_ are sequentially consistent: either this sees the sleeper, or the sleeper sees the task.
+    if (sleepers_ > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work_.notify_one();
+    }
+}
+
+bool Executor::take(std::size_t index, Task& task) {
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < workers_.size(); ++i) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued_;
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::run(std::size_t index) {
+    t_executor = this;
+    t_worker = index;
+    Task task;
+    while (true) {
+        if (take(index, task)) {
+            task();
+            task = nullptr; // release what the task captured before reporting it done
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            if (--pending_ == 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                idle_.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++sleepers_;
+        work_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+        --sleepers_;
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+void Executor::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return pending_ == 0; });
+}
+
+Executor::Stats Executor::stats() const {
+    Stats stats;
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace alerts
@@ -0,0 +1,30 @@
+#include "alerts/feed_decoder.h"
+#include "alerts/json_scanner.h"
+
+namespace alerts {
+
+bool FeedDecoder::decode(const char* data, std::size_t size, RegionRegistry& regions, Snapshot& snapshot,
+                         Arena* arena) {
+    if (DeltaDecoder::is_delta(data, size)) {
+        return delta_.decode(data, size, regions, snapshot, arena);
+    }
+    snapshot.readings.clear();
+    JsonObjectScanner scanner(data, size, arena);
+    JsonMember member;
+    while (scanner.next(member)) {
+        Status status = Status::Unknown;
+        if (member.type == JsonType::Null) {
+            status = Status::Null;
+        } else if (member.type == JsonType::String) {
+            status = parse_status(member.value, member.value_size);
+        }
+        snapshot.readings.push_back({regions.intern(member.key, member.key_size), status});
+    }
+    if (scanner.failed()) {
+        snapshot.readings.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,235 @@
+#include "alerts/feed_source.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+#include <curl/curl.h>
+#include "alerts/delta_feed.h"
+#include "alerts/dns_cache.h"
+#include "alerts/http_client.h"
+
+namespace alerts {
+
+namespace {
+
+/**
+ * @brief WriteCallback function to handle writing data from a callback function.
+ * @param contents void pointer to the data contents
+ * @param size size of each element to be written
+ * @param nmemb number of elements to be written
+ * @param userp void pointer to user data
+ * @return the total size of the data written
+ */
+size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    ((std::string*)userp)->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+/**
+ * @brief Aborts the transfer (with CURLE_ABORTED_BY_CALLBACK) once the source has been aborted.
+ * @param aborted The source's abort flag.
+ */
+int ProgressCallback(void* aborted, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    return static_cast<std::atomic<bool>*>(aborted)->load() ? 1 : 0;
+}
+
+std::int64_t unix_now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+HttpFeedSource::HttpFeedSource(std::string url, RateLimiter& limiter)
+    : url_(std::move(url)), curl_(nullptr), limiter_(limiter) {
+    HttpClient::shared(); // initialises libcurl
+    CURL* curl = curl_easy_init();
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 15L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &aborted_);
+        // Prefer waiting for a connection that can multiplex over opening a parallel one.
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    }
+    curl_ = curl;
+    if (curl_) {
+        set_request_headers();
+    }
+
+    // Start resolving the host now, in the background.
+    if (CURLU* parsed = curl_url()) {
+        char* scheme = nullptr;
+        char* host = nullptr;
+        char* port = nullptr;
+        if (curl_url_set(parsed, CURLUPART_URL, url_.c_str(), 0) == CURLUE_OK &&
+            curl_url_get(parsed, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+            (std::strcmp(scheme, "http") == 0 || std::strcmp(scheme, "https") == 0) &&
+            curl_url_get(parsed, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+            curl_url_get(parsed, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK && host[0] != '[') {
+            host_ = host;
+            port_ = std::atoi(port);
+            DnsCache::shared().watch(host_, port_);
+        }
+        curl_free(scheme);
+        curl_free(host);
+        curl_free(port);
+        curl_url_cleanup(parsed);
+    }
+    origin_ = host_.empty() ? url_ : host_ + ":" + std::to_string(port_);
+}
+
+HttpFeedSource::~HttpFeedSource() {
+    if (curl_) {
+        curl_easy_cleanup(static_cast<CURL*>(curl_));
+    }
+    curl_slist_free_all(static_cast<curl_slist*>(resolve_list_));
+    curl_slist_free_all(static_cast<curl_slist*>(headers_));
+}
+
+void HttpFeedSource::set_request_headers() {
+    // A proxy that speaks the delta feed answers in it; anything else sends JSON as always.
+    curl_slist* list = curl_slist_append(nullptr, (std::string("Accept: application/json, ") + kDeltaContentType).c_str());
+    if (delta_cursor_.version) {
+        list = curl_slist_append(list, ("Alerts-Since: " + delta_cursor_.to_string()).c_str());
+    }
+    curl_easy_setopt(static_cast<CURL*>(curl_), CURLOPT_HTTPHEADER, list);
+    curl_slist_free_all(static_cast<curl_slist*>(headers_));
+    headers_ = list;
+}
+
+void HttpFeedSource::pin_addresses() {
+    std::uint64_t generation = 0;
+    std::vector<std::string> addresses = DnsCache::shared().addresses(host_, port_, generation);
+    if (addresses.empty() || generation == pinned_generation_) {
+        return; // not resolved yet (curl resolves this once itself), or already pinned
+    }
+    // Replace the entry in curl's DNS cache; curl tries the addresses in order.
+    std::string entry = host_ + ":" + std::to_string(port_) + ":";
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        bool ipv6 = addresses[i].find(':') != std::string::npos;
+        entry += (i ? "," : "") + (ipv6 ? "[" + addresses[i] + "]" : addresses[i]);
+    }
+    curl_slist* list = curl_slist_append(nullptr, ("-" + host_ + ":" + std::to_string(port_)).c_str());
+    list = curl_slist_append(list, entry.c_str());
+    curl_easy_setopt(static_cast<CURL*>(curl_), CURLOPT_RESOLVE, list);
+    curl_slist_free_all(static_cast<curl_slist*>(resolve_list_));
+    resolve_list_ = list;
+    pinned_generation_ = generation;
+}
+
+bool HttpFeedSource::fetch(FetchResult& result) {
+    if (!begin_fetch(result)) {
+        return false;
+    }
+    return finish_fetch(HttpClient::shared().perform(curl_), result);
+}
+
+void HttpFeedSource::fetch_async(FetchResult& result, std::function<void(bool)> done) {
+    if (!begin_fetch(result)) {
+        done(false);
+        return;
+    }
+    HttpClient::shared().start(curl_, [this, &result, done](int code) { done(finish_fetch(code, result)); });
+}
+
+bool HttpFeedSource::begin_fetch(FetchResult& result) {
+    result.body.clear();
+    CURL* curl = static_cast<CURL*>(curl_);
+    if (!curl || aborted_) {
+        return false;
+    }
+    std::chrono::steady_clock::time_point retry_at;
+    if (!limiter_.try_acquire(retry_at, origin_)) {
+        if (!throttled_) {
+            throttled_ = true;
+            std::cerr << "Not fetching data from " << url_ << " for "
+                      << std::chrono::ceil<std::chrono::seconds>(retry_at - std::chrono::steady_clock::now()).count()
+                      << " s: rate limited" << std::endl;
+        }
+        return false;
+    }
+    throttled_ = false;
+    if (!host_.empty()) {
+        pin_addresses();
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &result.body);
+    return true;
+}
+
+bool HttpFeedSource::finish_fetch(int code, FetchResult& result) {
+    CURL* curl = static_cast<CURL*>(curl_);
+    CURLcode res = CURLcode(code);
+    result.time = unix_now();
+    if (res == CURLE_ABORTED_BY_CALLBACK) {
+        return false;
+    }
+    if (res != CURLE_OK) {
+        std::cerr << "Failed to fetch data from " << url_ << ": " << curl_easy_strerror(res) << std::endl;
+        return false;
+    }
+    long status = 0; // stays 0 for file:// URLs
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status == 429 || status == 503) {
+        curl_off_t retry_after = 0; // seconds; curl also converts an HTTP date
+        curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retry_after);
+        std::chrono::seconds pause;
+        if (retry_after > 0) {
+            pause = std::chrono::seconds(std::min<curl_off_t>(retry_after, 3600));
+        } else {
+            backoff_ = backoff_.count() ? std::min(backoff_ * 2, std::chrono::seconds(300)) : std::chrono::seconds(5);
+            pause = backoff_;
+        }
+        limiter_.defer_until(std::chrono::steady_clock::now() + pause, origin_);
+        throttled_ = true;
+        std::cerr << "Failed to fetch data from " << url_ << ": HTTP " << status << ", retrying in " << pause.count()
+                  << " s" << std::endl;
+        result.body.clear();
+        return false;
+    }
+    if (status != 0 && (status < 200 || status > 299)) {
+        std::cerr << "Failed to fetch data from " << url_ << ": HTTP " << status << std::endl;
+        result.body.clear();
+        return false;
+    }
+    backoff_ = std::chrono::seconds(0);
+    char* address = nullptr;
+    if (!host_.empty() && curl_easy_getinfo(curl, CURLINFO_PRIMARY_IP, &address) == CURLE_OK && address) {
+        DnsCache::shared().prefer(host_, port_, address);
+    }
+    if (result.body.empty()) {
+        std::cerr << "Failed to fetch data from " << url_ << ": empty response" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void HttpFeedSource::set_delta_cursor(const DeltaCursor& cursor) {
+    if (curl_ && (cursor.epoch != delta_cursor_.epoch || cursor.version != delta_cursor_.version)) {
+        delta_cursor_ = cursor;
+        set_request_headers();
+    }
+}
+
+ReplayFeedSource::ReplayFeedSource(const std::string& path) : path_(path), in_(path, std::ios::binary) {}
+
+bool ReplayFeedSource::fetch(FetchResult& result) {
+    while (std::getline(in_, line_)) {
+        size_t tab = line_.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        result.time = std::strtoll(line_.c_str(), nullptr, 10);
+        result.body.assign(line_, tab + 1, std::string::npos);
+        return true;
+    }
+    return false;
+}
+
+} // namespace alerts
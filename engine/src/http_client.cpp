@@ -0,0 +1,168 @@
+#include "alerts/http_client.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <curl/curl.h>
+
+namespace alerts {
+
+std::string HttpClient::Stats::summary() const {
+    char line[192];
+    std::snprintf(line, sizeof(line), "%llu requests, %llu connection%s (%.1f%% reuse, %llu over HTTP/2), "
+                  "latency mean %.1f ms, max %.1f ms, DNS wait mean %.1f ms", (unsigned long long)requests,
+                  (unsigned long long)new_connections, new_connections == 1 ? "" : "s", reuse_ratio() * 100,
+                  (unsigned long long)http2, mean_seconds() * 1e3, max_seconds * 1e3,
+                  requests ? name_lookup_seconds / requests * 1e3 : 0.0);
+    return line;
+}
+
+HttpClient& HttpClient::shared() {
+    static HttpClient client;
+    return client;
+}
+
+HttpClient::HttpClient() {
+    // curl_global_init() is not thread-safe and must run once per process, before any handle exists.
+    // Registered from here, the cleanup runs after the shared client has been destroyed.
+    static std::once_flag curl_initialized;
+    std::call_once(curl_initialized, [] {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        std::atexit(curl_global_cleanup);
+    });
+    CURLM* multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, long(CURLPIPE_MULTIPLEX));
+    multi_ = multi;
+    thread_ = std::thread(&HttpClient::run, this);
+}
+
+HttpClient::~HttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    thread_.join();
+    curl_multi_cleanup(static_cast<CURLM*>(multi_));
+}
+
+int HttpClient::perform(void* easy) {
+    Transfer transfer;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return CURLE_FAILED_INIT;
+    }
+    queued_.emplace_back(easy, &transfer);
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    done_.wait(lock, [&transfer] { return transfer.done; });
+    return transfer.result;
+}
+
+void HttpClient::start(void* easy, std::function<void(int)> done) {
+    Transfer* transfer = new Transfer;
+    transfer->callback = std::move(done);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            queued_.emplace_back(easy, transfer);
+            curl_multi_wakeup(static_cast<CURLM*>(multi_));
+            return;
+        }
+    }
+    std::vector<Transfer*> callbacks = {transfer};
+    transfer->result = CURLE_FAILED_INIT;
+    run_callbacks(callbacks);
+}
+
+void HttpClient::finish(Transfer* transfer, int result, std::vector<Transfer*>& callbacks) {
+    transfer->result = result;
+    if (transfer->callback) {
+        callbacks.push_back(transfer);
+    } else {
+        transfer->done = true;
+    }
+}
+
+void HttpClient::run_callbacks(std::vector<Transfer*>& callbacks) {
+    for (Transfer* transfer : callbacks) {
+        transfer->callback(transfer->result);
+        delete transfer;
+    }
+    callbacks.clear();
+}
+
+HttpClient::Stats HttpClient::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void HttpClient::run() {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    std::vector<Transfer*> callbacks; // called outside the lock, so they can start the next transfer
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                break;
+            }
+            for (const auto& queued : queued_) {
+                curl_multi_add_handle(multi, static_cast<CURL*>(queued.first));
+                running_.emplace(queued.first, queued.second);
+            }
+            queued_.clear();
+        }
+
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+        int pending = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &pending)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL* easy = message->easy_handle;
+            long connects = 0;
+            long version = 0;
+            curl_off_t microseconds = 0;
+            curl_off_t lookup_microseconds = 0;
+            curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME_T, &lookup_microseconds);
+            curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+            curl_easy_getinfo(easy, CURLINFO_HTTP_VERSION, &version);
+            curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &microseconds);
+            int result = message->data.result;
+            curl_multi_remove_handle(multi, easy);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            double seconds = microseconds / 1e6;
+            ++stats_.requests;
+            stats_.new_connections += connects;
+            stats_.http2 += version == CURL_HTTP_VERSION_2_0;
+            stats_.total_seconds += seconds;
+            stats_.name_lookup_seconds += lookup_microseconds / 1e6;
+            stats_.max_seconds = std::max(stats_.max_seconds, seconds);
+            auto running = running_.find(easy);
+            finish(running->second, result, callbacks);
+            running_.erase(running);
+            done_.notify_all();
+            lock.unlock();
+            run_callbacks(callbacks);
+        }
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+
+    // Fail whatever is still queued or running.
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& running : running_) {
+            curl_multi_remove_handle(multi, static_cast<CURL*>(running.first));
+            queued_.emplace_back(running);
+        }
+        running_.clear();
+        for (auto& queued : queued_) {
+            finish(queued.second, CURLE_FAILED_INIT, callbacks);
+        }
+        queued_.clear();
+        done_.notify_all();
+    }
+    run_callbacks(callbacks);
+}
+
+} // namespace alerts
@@ -0,0 +1,426 @@
+#include "alerts/json_scanner.h"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALERTS_JSON_X86 1
+#endif
+
+namespace alerts {
+
+namespace {
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Reads the four hex digits of a \u escape.
+ * @return The code unit, or -1 if the digits are invalid or missing.
+ */
+long read_hex4(const char* p, const char* end) {
+    if (end - p < 4) {
+        return -1;
+    }
+    long value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = hex_digit(p[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+/// Writes a code point as UTF-8 and advances out past it.
+void put_utf8(char*& out, unsigned long code) {
+    if (code < 0x80) {
+        *out++ = char(code);
+    } else if (code < 0x800) {
+        *out++ = char(0xC0 | (code >> 6));
+        *out++ = char(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *out++ = char(0xE0 | (code >> 12));
+        *out++ = char(0x80 | ((code >> 6) & 0x3F));
+        *out++ = char(0x80 | (code & 0x3F));
+    } else {
+        *out++ = char(0xF0 | (code >> 18));
+        *out++ = char(0x80 | ((code >> 12) & 0x3F));
+        *out++ = char(0x80 | ((code >> 6) & 0x3F));
+        *out++ = char(0x80 | (code & 0x3F));
+    }
+}
+
+bool is_literal_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+// Search kernels. Each returns the first byte in [p, end) that it looks for, or end.
+using FindFn = const char* (*)(const char* p, const char* end);
+
+/// The end of a string's plain run: a quote, a backslash or a control character.
+const char* find_string_special_scalar(const char* p, const char* end) {
+    while (p < end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) {
+        ++p;
+    }
+    return p;
+}
+
+/// The next quote or bracket, outside strings.
+const char* find_structural_scalar(const char* p, const char* end) {
+    while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']') {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef ALERTS_JSON_X86
+
+__attribute__((target("sse4.2")))
+const char* find_string_special_sse42(const char* p, const char* end) {
+    const __m128i ranges = _mm_setr_epi8(0x00, 0x1f, '"', '"', '\\', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int index = _mm_cmpestri(ranges, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16) {
+            return p + index;
+        }
+    }
+    return find_string_special_scalar(p, end);
+}
+
+__attribute__((target("sse4.2")))
+const char* find_structural_sse42(const char* p, const char* end) {
+    const __m128i set = _mm_setr_epi8('"', '{', '}', '[', ']', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int index = _mm_cmpestri(set, 5, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16) {
+            return p + index;
+        }
+    }
+    return find_structural_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* find_string_special_avx2(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1f);
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                                       _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk)); // chunk <= 0x1f
+        unsigned mask = unsigned(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_string_special_sse42(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* find_structural_avx2(const char* p, const char* end) {
+    // '[' and ']' are '{' and '}' without the 0x20 bit, and no other byte is.
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i folded = _mm256_or_si256(chunk, case_bit);
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)));
+        unsigned mask = unsigned(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_structural_sse42(p, end);
+}
+
+#endif // ALERTS_JSON_X86
+
+struct Kernels {
+    SimdLevel level;
+    FindFn string_special;
+    FindFn structural;
+};
+
+Kernels kernels_for(SimdLevel level) {
+#ifdef ALERTS_JSON_X86
+    if (level >= SimdLevel::Avx2 && best_json_simd_level() >= SimdLevel::Avx2) {
+        return {SimdLevel::Avx2, find_string_special_avx2, find_structural_avx2};
+    }
+    if (level >= SimdLevel::Sse42 && best_json_simd_level() >= SimdLevel::Sse42) {
+        return {SimdLevel::Sse42, find_string_special_sse42, find_structural_sse42};
+    }
+#endif
+    (void)level;
+    return {SimdLevel::Scalar, find_string_special_scalar, find_structural_scalar};
+}
+
+// Constant-initialized to the scalar kernels, so scanning during static initialization is safe; the
+// best kernels the CPU supports are installed just after.
+Kernels g_kernels = {SimdLevel::Scalar, find_string_special_scalar, find_structural_scalar};
+const bool g_kernels_selected = (g_kernels = kernels_for(SimdLevel::Avx2), true);
+
+} // namespace
+
+SimdLevel best_json_simd_level() {
+#ifdef ALERTS_JSON_X86
+    static const SimdLevel best = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2
+               : __builtin_cpu_supports("sse4.2") ? SimdLevel::Sse42
+                                                  : SimdLevel::Scalar;
+    }();
+    return best;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel json_simd_level() {
+    return g_kernels.level;
+}
+
+void set_json_simd_level(SimdLevel level) {
+    g_kernels = kernels_for(level);
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse42: return "sse4.2";
+    default: return "scalar";
+    }
+}
+
+JsonObjectScanner::JsonObjectScanner(const char* data, std::size_t size, Arena* arena)
+    : pos_(data), end_(data + size), arena_(arena) {}
+
+bool JsonObjectScanner::fail() {
+    failed_ = true;
+    done_ = true;
+    return false;
+}
+
+void JsonObjectScanner::skip_whitespace() {
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+        ++pos_;
+    }
+}
+
+bool JsonObjectScanner::scan_string(std::string& scratch, const char*& text, std::size_t& size) {
+    // pos_ is just past the opening quote.
+    const char* start = pos_;
+    pos_ = g_kernels.string_special(pos_, end_);
+    if (pos_ >= end_ || static_cast<unsigned char>(*pos_) < 0x20) {
+        return false;
+    }
+    if (*pos_ == '"') {
+        text = start;
+        size = std::size_t(pos_ - start);
+        ++pos_;
+        return true;
+    }
+
+    // Escape sequences. Find the closing quote first: the unescaped text is never longer than the escaped
+    // one, so one buffer of that size, from the arena or the scratch string, holds it.
+    const char* close = pos_;
+    while (close < end_ && *close != '"') {
+        if (*close == '\\' && ++close == end_) {
+            return false;
+        }
+        close = g_kernels.string_special(close + 1, end_);
+    }
+    if (close >= end_) {
+        return false;
+    }
+    char* buffer = nullptr;
+    if (arena_) {
+        buffer = arena_->allocate_array<char>(std::size_t(close - start));
+    } else {
+        scratch.resize(std::size_t(close - start));
+        buffer = &scratch[0];
+    }
+    char* out = buffer + (pos_ - start);
+    std::memcpy(buffer, start, std::size_t(pos_ - start));
+    while (pos_ < close) {
+        char c = *pos_++;
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return false;
+        }
+        if (c != '\\') {
+            *out++ = c;
+            continue;
+        }
+        c = *pos_++; // the search above made sure an escaped character follows
+        switch (c) {
+        case '"': case '\\': case '/': *out++ = c; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u': {
+            long code = read_hex4(pos_, close);
+            if (code < 0) {
+                return false;
+            }
+            pos_ += 4;
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                // A high surrogate must be followed by an escaped low surrogate.
+                long low = (close - pos_ >= 6 && pos_[0] == '\\' && pos_[1] == 'u') ? read_hex4(pos_ + 2, close) : -1;
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                pos_ += 6;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                return false;
+            }
+            put_utf8(out, (unsigned long)code);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    pos_ = close + 1;
+    text = buffer;
+    size = std::size_t(out - buffer);
+    return true;
+}
+
+bool JsonObjectScanner::skip_nested() {
+    // pos_ is at the opening bracket.
+    const char* start = pos_;
+    char stack[64];
+    int depth = 0;
+    while ((pos_ = g_kernels.structural(pos_, end_)) < end_) {
+        char c = *pos_++;
+        if (c == '"') {
+            // Control characters are not checked in skipped strings.
+            while ((pos_ = g_kernels.string_special(pos_, end_)) < end_ && *pos_ != '"') {
+                if (*pos_ == '\\' && ++pos_ == end_) {
+                    return false;
+                }
+                ++pos_;
+            }
+            if (pos_ >= end_) {
+                return false;
+            }
+            ++pos_;
+        } else if (c == '{' || c == '[') {
+            if (depth == int(sizeof(stack))) {
+                return false;
+            }
+            stack[depth++] = c == '{' ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || stack[--depth] != c) {
+                return false;
+            }
+            if (depth == 0) {
+                return pos_ > start;
+            }
+        }
+    }
+    return false;
+}
+
+bool JsonObjectScanner::scan_value(JsonMember& member) {
+    if (pos_ >= end_) {
+        return false;
+    }
+    char c = *pos_;
+    if (c == '"') {
+        ++pos_;
+        member.type = JsonType::String;
+        return scan_string(value_scratch_, member.value, member.value_size);
+    }
+    if (c == '{' || c == '[') {
+        member.type = JsonType::Nested;
+        member.value = pos_;
+        if (!skip_nested()) {
+            return false;
+        }
+        member.value_size = std::size_t(pos_ - member.value);
+        return true;
+    }
+    const char* start = pos_;
+    while (pos_ < end_ && is_literal_char(*pos_)) {
+        ++pos_;
+    }
+    member.value = start;
+    member.value_size = std::size_t(pos_ - start);
+    if (member.value_size == 4 && std::memcmp(start, "null", 4) == 0) {
+        member.type = JsonType::Null;
+    } else if (member.value_size == 4 && std::memcmp(start, "true", 4) == 0) {
+        member.type = JsonType::True;
+    } else if (member.value_size == 5 && std::memcmp(start, "false", 5) == 0) {
+        member.type = JsonType::False;
+    } else if (member.value_size > 0 && (start[0] == '-' || (start[0] >= '0' && start[0] <= '9'))) {
+        member.type = JsonType::Number;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool JsonObjectScanner::next(JsonMember& member) {
+    if (done_) {
+        return false;
+    }
+    skip_whitespace();
+    if (!started_) {
+        started_ = true;
+        if (pos_ >= end_ || *pos_ != '{') {
+            return fail();
+        }
+        ++pos_;
+        skip_whitespace();
+        if (pos_ < end_ && *pos_ == '}') {
+            ++pos_;
+            done_ = true;
+            skip_whitespace();
+            return pos_ == end_ ? false : fail();
+        }
+    } else {
+        if (pos_ < end_ && *pos_ == '}') {
+            ++pos_;
+            done_ = true;
+            skip_whitespace();
+            return pos_ == end_ ? false : fail();
+        }
+        if (pos_ >= end_ || *pos_ != ',') {
+            return fail();
+        }
+        ++pos_;
+        skip_whitespace();
+    }
+
+    if (pos_ >= end_ || *pos_ != '"') {
+        return fail();
+    }
+    ++pos_;
+    if (!scan_string(key_scratch_, member.key, member.key_size)) {
+        return fail();
+    }
+    skip_whitespace();
+    if (pos_ >= end_ || *pos_ != ':') {
+        return fail();
+    }
+    ++pos_;
+    skip_whitespace();
+    if (!scan_value(member)) {
+        return fail();
+    }
+    return true;
+}
+
+} // namespace alerts
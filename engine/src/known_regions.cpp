@@ -0,0 +1,127 @@
+#include "alerts/known_regions.h"
+#include <cstdint>
+#include <cstring>
+
+namespace alerts {
+
+namespace {
+
+struct KnownName {
+    const char* text;
+    int region;
+};
+
+// The data source's transliterated names, in region index order, then the Ukrainian ones.
+constexpr KnownName kNames[] = {
+    {"Crimea", 0}, {"Vinnytsia", 1}, {"Volyn", 2}, {"Dnipropetrovsk", 3}, {"Donetsk", 4}, {"Zhytomyr", 5},
+    {"Zakarpattia", 6}, {"Zaporizhzhia", 7}, {"Ivano-Frankivsk", 8}, {"Kyiv Oblast", 9}, {"Kirovohrad", 10},
+    {"Luhansk", 11}, {"Lviv", 12}, {"Mykolaiv", 13}, {"Odesa", 14}, {"Poltava", 15}, {"Rivne", 16},
+    {"Sumy", 17}, {"Ternopil", 18}, {"Kharkiv", 19}, {"Kherson", 20}, {"Khmelnytskyi", 21}, {"Cherkasy", 22},
+    {"Chernivtsi", 23}, {"Chernihiv", 24}, {"Kyiv", 25}, {"Sevastopol", 26},
+
+    {"Автономна Республіка Крим", 0}, {"Вінницька область", 1}, {"Волинська область", 2},
+    {"Дніпропетровська область", 3}, {"Донецька область", 4}, {"Житомирська область", 5},
+    {"Закарпатська область", 6}, {"Запорізька область", 7}, {"Івано-Франківська область", 8},
+    {"Київська область", 9}, {"Кіровоградська область", 10}, {"Луганська область", 11},
+    {"Львівська область", 12}, {"Миколаївська область", 13}, {"Одеська область", 14},
+    {"Полтавська область", 15}, {"Рівненська область", 16}, {"Сумська область", 17},
+    {"Тернопільська область", 18}, {"Харківська область", 19}, {"Херсонська область", 20},
+    {"Хмельницька область", 21}, {"Черкаська область", 22}, {"Чернівецька область", 23},
+    {"Чернігівська область", 24}, {"м. Київ", 25}, {"м. Севастополь", 26},
+};
+constexpr std::size_t kNameCount = sizeof(kNames) / sizeof(kNames[0]);
+static_assert(kNameCount == 2 * kKnownRegionCount, "every known region has two names");
+
+constexpr std::size_t length(const char* text) {
+    std::size_t size = 0;
+    while (text[size]) {
+        ++size;
+    }
+    return size;
+}
+
+/// Up to eight bytes as a little-endian word.
+constexpr std::uint64_t load_word(const char* data, std::size_t size) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        word |= std::uint64_t(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return word;
+}
+
+const unsigned kSlotBits = 9;
+
+/// The slot of a name from its length and first and last eight bytes (tail is 0 for names of eight bytes or less).
+constexpr std::size_t mix(std::uint64_t head, std::uint64_t tail, std::size_t size, std::uint64_t seed) {
+    std::uint64_t hash = (head ^ seed) * 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ tail ^ size) * 0xff51afd7ed558ccdull;
+    return std::size_t(hash >> (64 - kSlotBits));
+}
+
+constexpr std::size_t slot_of(const char* data, std::size_t size, std::uint64_t seed) {
+    return mix(load_word(data, size < 8 ? size : 8), size > 8 ? load_word(data + size - 8, 8) : 0, size, seed);
+}
+
+struct Table {
+    std::uint64_t seed;
+    std::uint8_t slots[1 << kSlotBits]; ///< name index + 1, or 0 for an empty slot
+    std::uint8_t sizes[kNameCount];
+};
+
+/// Tries seeds until every name has a slot of its own. 54 names in 512 slots need a few dozen tries.
+constexpr Table build_table() {
+    Table table{};
+    for (std::size_t i = 0; i < kNameCount; ++i) {
+        table.sizes[i] = std::uint8_t(length(kNames[i].text));
+    }
+    for (std::uint64_t seed = 1; seed < 10000; ++seed) {
+        for (std::uint8_t& slot : table.slots) {
+            slot = 0;
+        }
+        bool distinct = true;
+        for (std::size_t i = 0; distinct && i < kNameCount; ++i) {
+            std::size_t slot = slot_of(kNames[i].text, table.sizes[i], seed);
+            distinct = table.slots[slot] == 0;
+            table.slots[slot] = std::uint8_t(i + 1);
+        }
+        if (distinct) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    table.seed = 0;
+    return table;
+}
+
+constexpr Table kTable = build_table();
+static_assert(kTable.seed != 0, "no perfect hash seed found for the region names");
+
+} // namespace
+
+int find_known_region(const char* name, std::size_t size) {
+    std::size_t slot = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (size > 8) {
+        // Two unaligned loads instead of the byte loop.
+        std::uint64_t head = 0;
+        std::uint64_t tail = 0;
+        std::memcpy(&head, name, 8);
+        std::memcpy(&tail, name + size - 8, 8);
+        slot = mix(head, tail, size, kTable.seed);
+    } else
+#endif
+    {
+        slot = slot_of(name, size, kTable.seed);
+    }
+    std::uint8_t entry = kTable.slots[slot];
+    if (entry == 0 || kTable.sizes[entry - 1] != size || std::memcmp(kNames[entry - 1].text, name, size) != 0) {
+        return -1;
+    }
+    return kNames[entry - 1].region;
+}
+
+const char* known_region_name(int index, bool ukrainian) {
+    return kNames[ukrainian ? index + int(kKnownRegionCount) : index].text;
+}
+
+} // namespace alerts
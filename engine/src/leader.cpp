@@ -0,0 +1,172 @@
+#include "alerts/leader.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace alerts {
+
+namespace {
+
+/// A descriptor that becomes readable when a process exits, or -1 if the kernel cannot provide one.
+int open_process(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return int(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+} // namespace
+
+void LeaderElection::set_leader(bool leader) {
+    if (leader == leader_) {
+        return;
+    }
+    leader_ = leader;
+    if (on_change_) {
+        on_change_(leader);
+    }
+}
+
+FileLease::FileLease(EventLoop& loop, std::string path, Clock::duration retry)
+    : loop_(loop), path_(std::move(path)), retry_(retry) {}
+
+FileLease::~FileLease() {
+    stop();
+}
+
+bool FileLease::start(std::string& error) {
+    if (fd_ >= 0) {
+        return true;
+    }
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        error = "Cannot open the lease file " + path_ + ": " + std::strerror(errno);
+        return false;
+    }
+    try_lock();
+    return true;
+}
+
+void FileLease::stop() {
+    loop_.cancel_timer(timer_);
+    timer_ = 0;
+    unwatch_holder();
+    if (fd_ >= 0) {
+        close(fd_); // releases the lock
+        fd_ = -1;
+    }
+    set_leader(false);
+}
+
+void FileLease::try_lock() {
+    timer_ = 0;
+    if (flock(fd_, LOCK_EX | LOCK_NB) == 0) {
+        unwatch_holder();
+        std::string pid = std::to_string(getpid()) + "\n";
+        if (ftruncate(fd_, 0) != 0 || pwrite(fd_, pid.data(), pid.size(), 0) != ssize_t(pid.size())) {
+            // Only followers' fast failover depends on it; the lock itself is held.
+        }
+        set_leader(true);
+        return;
+    }
+    watch_holder();
+    timer_ = loop_.add_timer(retry_, [this] { try_lock(); });
+}
+
+void FileLease::watch_holder() {
+    char text[16] = {};
+    ssize_t size = pread(fd_, text, sizeof(text) - 1, 0);
+    pid_t pid = size > 0 ? pid_t(std::strtol(text, nullptr, 10)) : 0;
+    if (pid <= 0 || (pid == holder_ && holder_fd_ >= 0)) {
+        return;
+    }
+    unwatch_holder();
+    holder_ = pid;
+    holder_fd_ = open_process(pid);
+    if (holder_fd_ >= 0 && !loop_.watch_fd(holder_fd_, EPOLLIN, [this](std::uint32_t) {
+            // The leader has exited and its lock is gone: try at once rather than at the next retry.
+            unwatch_holder();
+            loop_.cancel_timer(timer_);
+            try_lock();
+        })) {
+        close(holder_fd_);
+        holder_fd_ = -1;
+    }
+}
+
+void FileLease::unwatch_holder() {
+    if (holder_fd_ >= 0) {
+        loop_.unwatch_fd(holder_fd_);
+        close(holder_fd_);
+    }
+    holder_fd_ = -1;
+    holder_ = 0;
+}
+
+HeartbeatElection::HeartbeatElection(EventLoop& loop, MulticastPublisher& publisher, Clock::duration period,
+                                     int missed)
+    : loop_(loop), publisher_(publisher), period_(period), missed_(missed), random_(publisher.sender()) {}
+
+HeartbeatElection::~HeartbeatElection() {
+    stop();
+}
+
+bool HeartbeatElection::start(std::string&) {
+    if (running_) {
+        return true;
+    }
+    running_ = true;
+    heard_ = Clock::now();
+    schedule_check();
+    return true;
+}
+
+void HeartbeatElection::stop() {
+    running_ = false;
+    loop_.cancel_timer(timer_);
+    timer_ = 0;
+    set_leader(false);
+}
+
+void HeartbeatElection::schedule_check() {
+    std::uniform_int_distribution<Clock::rep> jitter(0, period_.count());
+    timer_ = loop_.add_timer_at(heard_ + missed_ * period_ + Clock::duration(jitter(random_)), [this] { check(); });
+}
+
+void HeartbeatElection::check() {
+    timer_ = 0;
+    if (Clock::now() - heard_ < missed_ * period_) {
+        schedule_check(); // heard from the leader since the check was scheduled
+        return;
+    }
+    set_leader(true);
+    beat();
+}
+
+void HeartbeatElection::beat() {
+    Packet packet;
+    packet.type = PacketType::Leader;
+    publisher_.send(packet);
+    timer_ = loop_.add_timer(period_, [this] { beat(); });
+}
+
+void HeartbeatElection::receive(const Packet& packet) {
+    if (!running_ || packet.type != PacketType::Leader || packet.sender == publisher_.sender()) {
+        return;
+    }
+    heard_ = Clock::now();
+    if (leader() && packet.sender > publisher_.sender()) {
+        loop_.cancel_timer(timer_);
+        set_leader(false);
+        schedule_check();
+    }
+}
+
+} // namespace alerts
@@ -0,0 +1,117 @@
+#include "alerts/monitor.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace alerts {
+
+Monitor::Monitor(EventLoop& loop, Engine& engine, FeedSource& source, std::chrono::seconds interval)
+    : loop_(loop), engine_(engine), source_(source), interval_(interval) {}
+
+Monitor::~Monitor() {
+    stop();
+}
+
+void Monitor::align_to_upstream(std::chrono::seconds period) {
+    phase_.reset(new UpdatePhase(std::chrono::duration_cast<std::chrono::milliseconds>(period).count()));
+}
+
+void Monitor::start() {
+    if (worker_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    source_.reset(); // a stop() aborted it
+    self_ = std::make_shared<Monitor*>(this);
+    worker_ = std::thread(&Monitor::fetch_worker, this, std::weak_ptr<Monitor*>(self_));
+    request_fetch();
+}
+
+void Monitor::stop() {
+    loop_.cancel_timer(timer_);
+    timer_ = 0;
+    self_.reset();
+    if (!worker_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    source_.abort();
+    wakeup_.notify_all();
+    worker_.join();
+}
+
+void Monitor::request_fetch() {
+    timer_ = 0;
+    poll_started_ = EventLoop::Clock::now();
+    poll_started_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fetch_requested_ = true;
+    }
+    wakeup_.notify_one();
+}
+
+void Monitor::fetch_worker(std::weak_ptr<Monitor*> self) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait(lock, [this] { return fetch_requested_ || stopping_; });
+        if (stopping_) {
+            return;
+        }
+        fetch_requested_ = false;
+        lock.unlock();
+
+        // The next fetch is only requested once on_fetched() has run, so the worker and the loop never use
+        // fetched_ at the same time, and its body keeps its capacity from one poll to the next.
+        bool fetched = source_.fetch(fetched_);
+        loop_.post([self, fetched] {
+            if (auto monitor = self.lock()) {
+                (*monitor)->on_fetched((*monitor)->fetched_, fetched);
+            }
+        });
+
+        lock.lock();
+    }
+}
+
+void Monitor::on_fetched(FetchResult& result, bool fetched) {
+    bool decoded = false;
+    if (fetched) {
+        decoded = engine_.feed(result.body.data(), result.body.size(), result.time);
+        source_.set_delta_cursor(engine_.delta_cursor());
+        if (!decoded) {
+            std::cerr << "Failed to decode data from " << source_.describe() << std::endl;
+        }
+    }
+    // Keep the cadence: the next poll starts one interval after this one started, or at the point of the
+    // upstream's cadence nearest to that, unless the source is throttled. A poll that failed because of
+    // throttling is retried as soon as the source allows it.
+    EventLoop::Clock::time_point next = poll_started_ + interval_;
+    if (phase_) {
+        if (decoded) {
+            size_t hash = std::hash<std::string>()(result.body);
+            phase_->observe(poll_started_ms_, have_body_ && hash != body_hash_);
+            body_hash_ = hash;
+            have_body_ = true;
+        }
+        std::int64_t interval_ms = std::chrono::duration_cast<std::chrono::milliseconds>(interval_).count();
+        std::int64_t delay = phase_->next_poll(poll_started_ms_, interval_ms) - poll_started_ms_;
+        next = poll_started_ + std::chrono::milliseconds(delay);
+    }
+    EventLoop::Clock::time_point allowed = source_.next_fetch_allowed();
+    if (!fetched && allowed > EventLoop::Clock::now()) {
+        next = allowed;
+    } else {
+        next = std::max(next, allowed);
+    }
+    timer_ = loop_.add_timer_at(next, [this] { request_fetch(); });
+    if (on_poll_) {
+        on_poll_(decoded);
+    }
+}
+
+} // namespace alerts
@@ -0,0 +1,115 @@
+#include "alerts/multi_monitor.h"
+#include <algorithm>
+#include <iostream>
+
+namespace alerts {
+
+MultiMonitor::MultiMonitor(EventLoop& loop, Executor& executor) : loop_(loop), executor_(executor) {}
+
+MultiMonitor::~MultiMonitor() {
+    stop();
+}
+
+std::size_t MultiMonitor::add(FeedSource& source, Engine& engine, std::chrono::milliseconds interval) {
+    sources_.emplace_back(new Source{&source, &engine, interval, FetchResult(), 0, {}});
+    return sources_.size() - 1;
+}
+
+void MultiMonitor::start() {
+    if (self_) {
+        return;
+    }
+    self_ = std::make_shared<MultiMonitor*>(this);
+    for (auto& source : sources_) {
+        source->source->reset(); // a stop() aborted them
+    }
+    for (std::size_t i = 0; i < sources_.size(); ++i) {
+        poll(i);
+    }
+}
+
+void MultiMonitor::stop() {
+    if (!self_) {
+        return;
+    }
+    self_.reset();
+    for (auto& source : sources_) {
+        loop_.cancel_timer(source->timer);
+        source->timer = 0;
+        source->source->abort();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return working_ == 0; });
+}
+
+void MultiMonitor::begin_work() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++working_;
+}
+
+void MultiMonitor::end_work() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--working_ == 0) {
+        idle_.notify_all();
+    }
+}
+
+void MultiMonitor::poll(std::size_t index) {
+    Source& source = *sources_[index];
+    source.timer = 0;
+    source.poll_started = EventLoop::Clock::now();
+    std::weak_ptr<MultiMonitor*> self = self_;
+    begin_work();
+    // The next poll is only scheduled once this one has been decoded, so the fetch, the decode and the loop
+    // never use source.fetched at the same time.
+    source.source->fetch_async(source.fetched, [this, self, index](bool fetched) {
+        loop_.post([self, index, fetched] {
+            if (auto monitor = self.lock()) {
+                (*monitor)->on_fetched(index, fetched);
+            }
+        });
+        end_work();
+    });
+}
+
+void MultiMonitor::on_fetched(std::size_t index, bool fetched) {
+    if (!fetched) {
+        on_decoded(index, false, false);
+        return;
+    }
+    std::weak_ptr<MultiMonitor*> self = self_;
+    begin_work();
+    executor_.submit([this, self, index] {
+        Source& source = *sources_[index];
+        bool decoded = source.engine->feed(source.fetched.body.data(), source.fetched.body.size(),
+                                           source.fetched.time);
+        source.source->set_delta_cursor(source.engine->delta_cursor());
+        loop_.post([self, index, decoded] {
+            if (auto monitor = self.lock()) {
+                (*monitor)->on_decoded(index, true, decoded);
+            }
+        });
+        end_work();
+    });
+}
+
+void MultiMonitor::on_decoded(std::size_t index, bool fetched, bool decoded) {
+    Source& source = *sources_[index];
+    if (fetched && !decoded) {
+        std::cerr << "Failed to decode data from " << source.source->describe() << std::endl;
+    }
+    // Keep each source's cadence, unless it is throttled; see Monitor::on_fetched().
+    EventLoop::Clock::time_point next = source.poll_started + source.interval;
+    EventLoop::Clock::time_point allowed = source.source->next_fetch_allowed();
+    if (!fetched && allowed > EventLoop::Clock::now()) {
+        next = allowed;
+    } else {
+        next = std::max(next, allowed);
+    }
+    source.timer = loop_.add_timer_at(next, [this, index] { poll(index); });
+    if (on_poll_) {
+        on_poll_(index, decoded);
+    }
+}
+
+} // namespace alerts
@@ -0,0 +1,335 @@
+#include "alerts/multicast.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "alerts/sha256.h"
+
+namespace alerts {
+
+namespace {
+
+const char kMagic[2] = {'A', 'T'};
+const std::uint8_t kVersion = 2;
+
+void put32(char* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = char(value >> (8 * i));
+    }
+}
+
+void put64(char* out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = char(value >> (8 * i));
+    }
+}
+
+std::uint64_t get(const char* in, int size) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < size; ++i) {
+        value |= std::uint64_t(std::uint8_t(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+std::int64_t unix_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// Whether the tag at the end of a packet matches, compared in constant time.
+bool tag_matches(const char* data, std::size_t signed_size, const std::string& key) {
+    std::uint8_t mac[Sha256::kDigestSize];
+    hmac_sha256(key, data, signed_size, mac);
+    std::uint8_t difference = 0;
+    for (std::size_t i = 0; i < kPacketTagSize; ++i) {
+        difference |= mac[i] ^ std::uint8_t(data[signed_size + i]);
+    }
+    return difference == 0;
+}
+
+bool group_address(const MulticastOptions& options, sockaddr_in& address, std::string& error) {
+    address = sockaddr_in{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.group.c_str(), &address.sin_addr) != 1 ||
+        !IN_MULTICAST(ntohl(address.sin_addr.s_addr))) {
+        error = "Not a multicast group: " + options.group;
+        return false;
+    }
+    return true;
+}
+
+bool interface_address(const MulticastOptions& options, in_addr& address, std::string& error) {
+    address.s_addr = htonl(INADDR_ANY);
+    if (!options.interface.empty() && inet_pton(AF_INET, options.interface.c_str(), &address) != 1) {
+        error = "Not an interface address: " + options.interface;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_multicast_address(const std::string& text, MulticastOptions& options, std::string& error) {
+    std::size_t colon = text.rfind(':');
+    char* end = nullptr;
+    long port = colon == std::string::npos ? 0 : std::strtol(text.c_str() + colon + 1, &end, 10);
+    MulticastOptions parsed = options;
+    parsed.group = text.substr(0, colon);
+    sockaddr_in address;
+    if (port <= 0 || port > 65535 || *end != '\0' || !group_address(parsed, address, error)) {
+        error = "Not a multicast group and port: " + text;
+        return false;
+    }
+    options.group = parsed.group;
+    options.port = std::uint16_t(port);
+    return true;
+}
+
+std::size_t encode_packet(const Packet& packet, const std::string& key, char* out) {
+    std::size_t name_size = packet.region.size() < 255 ? packet.region.size() : 255;
+    out[0] = kMagic[0];
+    out[1] = kMagic[1];
+    out[2] = char(kVersion);
+    out[3] = char(packet.type);
+    out[4] = char(packet.kind);
+    out[5] = char(packet.status);
+    out[6] = char(name_size);
+    out[7] = 0;
+    put32(out + 8, packet.sender);
+    put32(out + 12, packet.sequence);
+    put64(out + 16, std::uint64_t(packet.time));
+    put64(out + 24, std::uint64_t(packet.sent));
+    std::memcpy(out + kPacketHeaderSize, packet.region.data(), name_size);
+    std::size_t signed_size = kPacketHeaderSize + name_size;
+    std::uint8_t mac[Sha256::kDigestSize];
+    hmac_sha256(key, out, signed_size, mac);
+    std::memcpy(out + signed_size, mac, kPacketTagSize);
+    return signed_size + kPacketTagSize;
+}
+
+bool decode_packet(const char* data, std::size_t size, const std::string& key, Packet& packet) {
+    if (size < kPacketHeaderSize + kPacketTagSize || data[0] != kMagic[0] || data[1] != kMagic[1] ||
+        std::uint8_t(data[2]) != kVersion) {
+        return false;
+    }
+    std::size_t name_size = std::uint8_t(data[6]);
+    std::size_t signed_size = kPacketHeaderSize + name_size;
+    if (size != signed_size + kPacketTagSize || !tag_matches(data, signed_size, key)) {
+        return false;
+    }
+    std::uint8_t type = std::uint8_t(data[3]);
+    std::uint8_t kind = std::uint8_t(data[4]);
+    std::uint8_t status = std::uint8_t(data[5]);
+    if (type < std::uint8_t(PacketType::Transition) || type > std::uint8_t(PacketType::Leader) || kind > 1 ||
+        status > std::uint8_t(Status::Unknown)) {
+        return false;
+    }
+    packet.type = PacketType(type);
+    packet.kind = TransitionKind(kind);
+    packet.status = Status(status);
+    packet.sender = std::uint32_t(get(data + 8, 4));
+    packet.sequence = std::uint32_t(get(data + 12, 4));
+    packet.time = std::int64_t(get(data + 16, 8));
+    packet.sent = std::int64_t(get(data + 24, 8));
+    packet.region.assign(data + kPacketHeaderSize, name_size);
+    return true;
+}
+
+MulticastPublisher::MulticastPublisher(MulticastOptions options)
+    : options_(std::move(options)), sender_(std::random_device()()) {}
+
+MulticastPublisher::~MulticastPublisher() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool MulticastPublisher::open(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sockaddr_in group;
+    in_addr interface;
+    if (!group_address(options_, group, error) || !interface_address(options_, interface, error)) {
+        return false;
+    }
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    unsigned char ttl = (unsigned char)(options_.ttl);
+    unsigned char loop = 1; // listeners on this host too
+    if (fd_ < 0 || setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0 ||
+        setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0 ||
+        setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) != 0 ||
+        connect(fd_, reinterpret_cast<sockaddr*>(&group), sizeof(group)) != 0) {
+        error = "Cannot send to " + options_.group + ": " + std::strerror(errno);
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool MulticastPublisher::send(Packet& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) {
+        return false;
+    }
+    packet.sender = sender_;
+    packet.sequence = ++sequence_;
+    packet.sent = unix_now_ms();
+    std::size_t size = encode_packet(packet, options_.key, buffer_);
+    if (::send(fd_, buffer_, size, 0) != ssize_t(size)) {
+        return false;
+    }
+    ++sent_;
+    return true;
+}
+
+void PacketSink::publish(const Engine& engine, std::int64_t time) {
+    Packet packet;
+    for (const Transition& transition : engine.transitions()) {
+        packet.type = PacketType::Transition;
+        packet.kind = transition.kind;
+        packet.status = transition.status;
+        packet.time = transition.time;
+        packet.region = engine.regions().name(transition.region);
+        send(packet);
+    }
+    publish_state(engine);
+    packet.type = PacketType::Heartbeat;
+    packet.kind = TransitionKind::AlertOff;
+    packet.status = Status::Unknown;
+    packet.time = time;
+    packet.region.clear();
+    send(packet);
+}
+
+void PacketSink::publish_state(const Engine& engine) {
+    Packet packet;
+    packet.type = PacketType::State;
+    const StateStore& state = engine.state();
+    for (RegionId region = 0; region < state.statuses().size(); ++region) {
+        if (state.status(region) == Status::Unknown) {
+            continue;
+        }
+        bool active = state.alert_active(region);
+        packet.kind = active ? TransitionKind::AlertOn : TransitionKind::AlertOff;
+        // A region in "partial" keeps its alert; a listener that missed the raise must still raise it.
+        packet.status = active ? Status::Full : state.status(region);
+        packet.time = state.changed_at(region);
+        packet.region = engine.regions().name(region);
+        send(packet);
+    }
+}
+
+std::uint64_t MulticastPublisher::sent() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sent_;
+}
+
+MulticastListener::MulticastListener(EventLoop& loop, Engine& engine, MulticastOptions options)
+    : loop_(loop), engine_(engine), options_(std::move(options)) {}
+
+MulticastListener::~MulticastListener() {
+    stop();
+}
+
+bool MulticastListener::start(std::string& error) {
+    if (fd_ >= 0) {
+        return true;
+    }
+    sockaddr_in group;
+    ip_mreq membership{};
+    if (!group_address(options_, group, error) || !interface_address(options_, membership.imr_interface, error)) {
+        return false;
+    }
+    membership.imr_multiaddr = group.sin_addr;
+    // Every instance on the host binds the same port; bound to the group, it receives nothing else.
+    int reuse = 1;
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(fd_, reinterpret_cast<sockaddr*>(&group), sizeof(group)) != 0 ||
+        setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0 ||
+        !loop_.watch_fd(fd_, EPOLLIN, [this](std::uint32_t) { receive(); })) {
+        error = "Cannot join " + options_.group + ": " + std::strerror(errno);
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void MulticastListener::stop() {
+    if (fd_ < 0) {
+        return;
+    }
+    loop_.unwatch_fd(fd_);
+    close(fd_);
+    fd_ = -1;
+}
+
+void MulticastListener::forget_senders(std::int64_t now) {
+    forgotten_ = now;
+    // A packet of a sender silent this long is stale even if stamped max_age ahead, so its sequence is not needed
+    // to refuse a replay. Every publisher restart is a new sender; without this the map would grow for ever.
+    std::int64_t silent = 2 * std::chrono::duration_cast<std::chrono::milliseconds>(options_.max_age).count();
+    for (auto sender = last_sequence_.begin(); sender != last_sequence_.end();) {
+        if (now - sender->second.received > silent) {
+            sender = last_sequence_.erase(sender);
+        } else {
+            ++sender;
+        }
+    }
+}
+
+void MulticastListener::receive() {
+    char buffer[kMaxPacketSize + 1];
+    while (fd_ >= 0) {
+        ssize_t size = recv(fd_, buffer, sizeof(buffer), 0);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // EAGAIN: all read
+        }
+        ++stats_.received;
+        if (!decode_packet(buffer, std::size_t(size), options_.key, packet_)) {
+            ++stats_.rejected;
+            continue;
+        }
+        std::int64_t max_age = std::chrono::duration_cast<std::chrono::milliseconds>(options_.max_age).count();
+        std::int64_t now = unix_now_ms();
+        std::int64_t age = now - packet_.sent;
+        if (age > max_age || age < -max_age) {
+            ++stats_.stale; // recorded earlier, perhaps before this listener started and learned the sequence
+            continue;
+        }
+        auto last = last_sequence_.find(packet_.sender);
+        if (last != last_sequence_.end() && std::int32_t(packet_.sequence - last->second.sequence) <= 0) {
+            ++stats_.replayed;
+            continue;
+        }
+        if (now - forgotten_ >= max_age) {
+            forget_senders(now);
+        }
+        last_sequence_[packet_.sender] = Sequence{packet_.sequence, now};
+        ++stats_.accepted;
+        if (packet_.type == PacketType::Transition || packet_.type == PacketType::State) {
+            // A lifted alert reports the status that lifted it; a raised one reports "full".
+            engine_.apply_reading(packet_.region, packet_.status, packet_.time);
+        }
+        if (on_packet_) {
+            on_packet_(packet_);
+        }
+    }
+}
+
+} // namespace alerts
@@ -0,0 +1,285 @@
+#include "alerts/notifier.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <utility>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace alerts {
+
+namespace {
+
+/// The path by which a child process opens a descriptor it inherited.
+std::string inherited_path(int fd) {
+    return "/proc/self/fd/" + std::to_string(fd);
+}
+
+/**
+ * @brief Starts a program, looked up in PATH, without a shell.
+ * @param args The program and its arguments.
+ * @param inherit Descriptors the program must inherit (its arguments refer to them).
+ * @return The process ID, or -1.
+ */
+int spawn_program(std::vector<std::string> args, std::initializer_list<int> inherit) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    for (int fd : inherit) {
+        // dup2() onto itself clears FD_CLOEXEC in the child only.
+        posix_spawn_file_actions_adddup2(&actions, fd, fd);
+    }
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    pid_t pid = -1;
+    int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return error == 0 ? int(pid) : -1;
+}
+
+/// Whether a program can be found in PATH, or at its path if it has one.
+bool in_path(const std::string& program) {
+    if (program.find('/') != std::string::npos) {
+        return access(program.c_str(), X_OK) == 0;
+    }
+    const char* path = std::getenv("PATH");
+    std::string dirs = path ? path : "/usr/bin:/bin";
+    for (size_t start = 0; start <= dirs.size();) {
+        size_t end = std::min(dirs.find(':', start), dirs.size());
+        std::string dir = end > start ? dirs.substr(start, end - start) : ".";
+        if (access((dir + "/" + program).c_str(), X_OK) == 0) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+/**
+ * @brief Decodes a sound into a WAV file in memory, with "<player> -q -w <wav> <file>".
+ * @param sound_fd The memory file holding the sound.
+ * @return The memory file descriptor (close-on-exec), or -1 if the player failed or wrote no samples.
+ */
+int decode_into_memory(const std::string& player, int sound_fd) {
+    int out = memfd_create("alert-sound-pcm", MFD_CLOEXEC);
+    if (out < 0) {
+        return -1;
+    }
+    int pid = spawn_program({ player, "-q", "-w", inherited_path(out), inherited_path(sound_fd) }, { out, sound_fd });
+    int status = 0;
+    while (pid > 0 && waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    struct stat decoded;
+    const off_t wav_header = 44;
+    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || fstat(out, &decoded) != 0 ||
+        decoded.st_size <= wav_header) {
+        close(out);
+        return -1;
+    }
+    return out;
+}
+
+/**
+ * @brief Writes a whole buffer, retrying after short writes and signals.
+ */
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Copies a file into an anonymous memory file.
+ * @return The memory file descriptor (close-on-exec), or -1.
+ */
+int load_into_memory(const std::string& path) {
+    int in = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return -1;
+    }
+    int out = memfd_create("alert-sound", MFD_CLOEXEC);
+    bool ok = out >= 0;
+    char buffer[1 << 16];
+    while (ok) {
+        ssize_t n = read(in, buffer, sizeof(buffer));
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        ok = write_all(out, buffer, size_t(n));
+    }
+    close(in);
+    if (!ok && out >= 0) {
+        close(out);
+        return -1;
+    }
+    return out;
+}
+
+} // namespace
+
+void format_alert_text(TransitionKind kind, const std::string& region, std::string& title, std::string& message) {
+    if (kind == TransitionKind::AlertOn) {
+        title = "ВСІ В УКРИТТЯ!!!";
+        message = "Увага! Повітряна тривога в регіоні: " + region + "!";
+    } else {
+        title = "МОЖНА ПОВЕРТАТИСЬ НА РОБОЧІ МІСЦЯ!";
+        message = "Відбій повітряної тривоги в регіоні: " + region + "!";
+    }
+}
+
+void format_stale_text(bool stale, std::chrono::seconds age, std::string& title, std::string& message) {
+    if (stale) {
+        title = "НЕМАЄ СВІЖИХ ДАНИХ ПРО ТРИВОГИ!";
+        message = "Дані не оновлювались " + std::to_string(age.count()) + " с. Тривогу може бути пропущено!";
+    } else {
+        title = "Дані про тривоги знову надходять";
+        message = "Дані оновились після перерви у " + std::to_string(age.count()) + " с.";
+    }
+}
+
+void LogNotifier::notify(const Transition& transition, const std::string& region) {
+    out_ << transition.time << (transition.kind == TransitionKind::AlertOn ? " ALERT ON " : " ALERT OFF ")
+         << region << " (" << status_name(transition.status) << ")" << std::endl;
+}
+
+void LogNotifier::data_stale(bool stale, std::chrono::seconds age) {
+    out_ << std::time(nullptr) << (stale ? " DATA STALE" : " DATA FRESH") << " (last update " << age.count()
+         << " s ago)" << std::endl;
+}
+
+bool LogNotifier::drain(std::chrono::steady_clock::time_point) {
+    out_.flush();
+    return bool(out_);
+}
+
+int play_alert_sound(const std::string& sound_file) {
+    return spawn_program({ "mpg123", "-q", sound_file }, {});
+}
+
+SoundNotifier::SoundNotifier(std::string alert_on, std::string alert_off, std::string player, std::string pcm_player)
+    : player_(std::move(player)), pcm_player_(std::move(pcm_player)) {
+    alert_on_.path = std::move(alert_on);
+    alert_off_.path = std::move(alert_off);
+}
+
+SoundNotifier::~SoundNotifier() {
+    reap();
+    for (Sound* sound : { &alert_on_, &alert_off_ }) {
+        for (int fd : { sound->fd, sound->pcm_fd }) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+}
+
+bool SoundNotifier::preload() {
+    std::string player;
+    std::string pcm_player;
+    std::string on_path;
+    std::string off_path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        player = player_;
+        pcm_player = pcm_player_;
+        on_path = alert_on_.path;
+        off_path = alert_off_.path;
+    }
+    // Load and decode without holding the lock, so a notification in the meantime is not delayed.
+    Sound on;
+    Sound off;
+    on.fd = load_into_memory(on_path);
+    off.fd = load_into_memory(off_path);
+    if (!pcm_player.empty() && in_path(pcm_player)) {
+        for (Sound* sound : { &on, &off }) {
+            sound->pcm_fd = sound->fd >= 0 ? decode_into_memory(player, sound->fd) : -1;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto loaded : { std::make_pair(&alert_on_, &on), std::make_pair(&alert_off_, &off) }) {
+        if (loaded.second->fd < 0) {
+            continue;
+        }
+        for (int fd : { loaded.first->fd, loaded.first->pcm_fd }) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        loaded.first->fd = loaded.second->fd;
+        loaded.first->pcm_fd = loaded.second->pcm_fd;
+    }
+    return on.fd >= 0 && off.fd >= 0;
+}
+
+void SoundNotifier::reap() {
+    for (size_t i = 0; i < players_.size();) {
+        if (waitpid(players_[i], nullptr, WNOHANG) != 0) {
+            players_[i] = players_.back();
+            players_.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void SoundNotifier::notify(const Transition& transition, const std::string&) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reap();
+    const Sound& sound = transition.kind == TransitionKind::AlertOn ? alert_on_ : alert_off_;
+    // Through /proc the player opens its own description of the memory file, with its own offset,
+    // so overlapping players do not interfere.
+    int pid = sound.pcm_fd >= 0 ? spawn_program({ pcm_player_, "-q", inherited_path(sound.pcm_fd) }, { sound.pcm_fd })
+              : sound.fd >= 0   ? spawn_program({ player_, "-q", inherited_path(sound.fd) }, { sound.fd })
+                                : spawn_program({ player_, "-q", sound.path }, {});
+    if (pid > 0) {
+        players_.push_back(pid);
+    }
+}
+
+bool SoundNotifier::drain(std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (true) {
+        reap();
+        if (players_.empty()) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (int pid : players_) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    players_.clear();
+    return false;
+}
+
+} // namespace alerts
+
@@ -0,0 +1,35 @@
+#include "alerts/process_stats.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <dirent.h>
+
+namespace alerts {
+
+ProcessStats read_process_stats() {
+    ProcessStats stats;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        const char* text = line.c_str();
+        if (std::strncmp(text, "VmRSS:", 6) == 0) {
+            stats.rss_kib = std::strtol(text + 6, nullptr, 10);
+        } else if (std::strncmp(text, "VmHWM:", 6) == 0) {
+            stats.hwm_kib = std::strtol(text + 6, nullptr, 10);
+        } else if (std::strncmp(text, "Threads:", 8) == 0) {
+            stats.threads = int(std::strtol(text + 8, nullptr, 10));
+        }
+    }
+    if (DIR* dir = opendir("/proc/self/fd")) {
+        int count = 0;
+        while (dirent* entry = readdir(dir)) {
+            count += entry->d_name[0] != '.';
+        }
+        closedir(dir);
+        stats.fds = count - 1; // the descriptor of the directory stream itself
+    }
+    return stats;
+}
+
+} // namespace alerts
@@ -0,0 +1,174 @@
+#include "alerts/queued_notifier.h"
+#include <algorithm>
+#include <cstring>
+
+namespace alerts {
+
+namespace {
+
+/// Pops to try before the notifier thread goes to sleep on an empty ring.
+const int kSpinsBeforeSleep = 64;
+
+std::int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+QueuedNotifier::QueuedNotifier(std::shared_ptr<Notifier> target, std::size_t capacity, bool multiple_producers)
+    : target_(std::move(target)) {
+    if (multiple_producers) {
+        mpsc_.reset(new MpscRing<EventRecord>(capacity));
+    } else {
+        spsc_.reset(new SpscRing<EventRecord>(capacity));
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+QueuedNotifier::~QueuedNotifier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void QueuedNotifier::notify(const Transition& transition, const std::string& region) {
+    EventRecord record;
+    record.kind = EventRecord::Kind::Transition;
+    record.transition = transition.kind;
+    record.status = transition.status;
+    record.region = transition.region;
+    record.reserved = 0;
+    record.time = transition.time;
+    std::size_t size = std::min(region.size(), sizeof(record.name));
+    if (size < region.size()) {
+        while (size > 0 && (static_cast<unsigned char>(region[size]) & 0xc0) == 0x80) {
+            --size;
+        }
+    }
+    record.name_size = std::uint8_t(size);
+    std::memcpy(record.name, region.data(), size);
+    push(record);
+}
+
+void QueuedNotifier::data_stale(bool stale, std::chrono::seconds age) {
+    EventRecord record;
+    record.kind = stale ? EventRecord::Kind::Stale : EventRecord::Kind::Fresh;
+    record.transition = TransitionKind::AlertOff;
+    record.status = Status::Null;
+    record.name_size = 0;
+    record.region = 0;
+    record.reserved = 0;
+    record.time = age.count();
+    push(record);
+}
+
+void QueuedNotifier::push(EventRecord& record) {
+    record.enqueued = steady_now_ns();
+    bool pushed = spsc_ ? spsc_->try_push(record) : mpsc_->try_push(record);
+    if (!pushed) {
+        ++full_waits_;
+        do {
+            std::this_thread::yield();
+        } while (!(spsc_ ? spsc_->try_push(record) : mpsc_->try_push(record)));
+    }
+    ++pushed_;
+    // Orders the push before reading sleeping_; the notifier thread does the converse before it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+bool QueuedNotifier::pop(EventRecord& record) {
+    return spsc_ ? spsc_->try_pop(record) : mpsc_->try_pop(record);
+}
+
+void QueuedNotifier::run() {
+    EventRecord record;
+    while (true) {
+        bool popped = false;
+        for (int spin = 0; spin < kSpinsBeforeSleep && !(popped = pop(record)); ++spin) {
+            std::this_thread::yield();
+        }
+        if (popped) {
+            deliver(record);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pop(record)) {
+            sleeping_.store(false, std::memory_order_relaxed);
+            lock.unlock();
+            deliver(record);
+            continue;
+        }
+        if (stopping_) {
+            break;
+        }
+        idle_.notify_all();
+        // A producer that saw sleeping_ notifies under the lock, so the wake-up cannot be missed, and an idle
+        // thread sleeps until there is work.
+        wake_.wait(lock);
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+    idle_.notify_all();
+}
+
+void QueuedNotifier::deliver(const EventRecord& record) {
+    switch (record.kind) {
+    case EventRecord::Kind::Transition: {
+        Transition transition;
+        transition.region = record.region;
+        transition.kind = record.transition;
+        transition.status = record.status;
+        transition.time = record.time;
+        name_.assign(record.name, record.name_size);
+        target_->notify(transition, name_);
+        break;
+    }
+    case EventRecord::Kind::Stale:
+    case EventRecord::Kind::Fresh:
+        target_->data_stale(record.kind == EventRecord::Kind::Stale, std::chrono::seconds(record.time));
+        break;
+    }
+    std::int64_t latency = steady_now_ns() - record.enqueued;
+    total_latency_ns_.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > max_latency_ns_.load(std::memory_order_relaxed)) {
+        max_latency_ns_.store(latency, std::memory_order_relaxed);
+    }
+    if (delivered_callback_) {
+        delivered_callback_(record);
+    }
+    delivered_.fetch_add(1, std::memory_order_release);
+}
+
+bool QueuedNotifier::drain(std::chrono::steady_clock::time_point deadline) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.notify_one();
+        bool empty = idle_.wait_until(lock, deadline, [this] {
+            return delivered_.load(std::memory_order_acquire) >= pushed_.load(std::memory_order_acquire);
+        });
+        if (!empty) {
+            return false;
+        }
+    }
+    return target_->drain(deadline);
+}
+
+QueuedNotifier::Stats QueuedNotifier::stats() const {
+    Stats stats;
+    stats.delivered = delivered_.load(std::memory_order_acquire);
+    stats.full_waits = full_waits_.load(std::memory_order_relaxed);
+    stats.max_latency_ns = max_latency_ns_.load(std::memory_order_relaxed);
+    stats.total_latency_ns = total_latency_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace alerts
@@ -0,0 +1,91 @@
+#include "alerts/rate_limiter.h"
+#include <algorithm>
+
+namespace alerts {
+
+RateLimiter& RateLimiter::process() {
+    static RateLimiter limiter;
+    return limiter;
+}
+
+void RateLimiter::set_rate(double per_second, double burst) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_ = per_second > 0 ? per_second : 0;
+    burst_ = std::max(burst, 1.0);
+    tokens_ = burst_;
+    refilled_ = Clock::now();
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    if (now > refilled_) {
+        tokens_ = std::min(burst_, tokens_ + std::chrono::duration<double>(now - refilled_).count() * rate_);
+        refilled_ = now;
+    }
+}
+
+RateLimiter::Clock::time_point RateLimiter::deferred_until(const std::string& host, Clock::time_point now) {
+    Clock::time_point until;
+    for (auto it = deferred_.begin(); it != deferred_.end();) {
+        if (it->second <= now) {
+            it = deferred_.erase(it); // over
+        } else {
+            if (it->first.empty() || it->first == host) {
+                until = std::max(until, it->second);
+            }
+            ++it;
+        }
+    }
+    return until;
+}
+
+bool RateLimiter::try_acquire(Clock::time_point& retry_at, const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Clock::time_point deferred = deferred_until(host, now);
+    if (now < deferred) {
+        retry_at = deferred;
+        return false;
+    }
+    if (rate_ == 0) {
+        return true;
+    }
+    refill(now);
+    if (tokens_ < 1) {
+        retry_at = now + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((1 - tokens_) / rate_));
+        return false;
+    }
+    tokens_ -= 1;
+    return true;
+}
+
+void RateLimiter::defer_until(Clock::time_point until, const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point& deferred = deferred_[host];
+    deferred = std::max(deferred, until);
+}
+
+void RateLimiter::resume(const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (host.empty()) {
+        deferred_.clear();
+    } else {
+        deferred_.erase(host);
+    }
+}
+
+RateLimiter::Clock::time_point RateLimiter::next_allowed(const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Clock::time_point allowed = deferred_until(host, now);
+    if (rate_ > 0) {
+        refill(now);
+        if (tokens_ < 1) {
+            allowed = std::max(allowed, now + std::chrono::duration_cast<Clock::duration>(
+                                                  std::chrono::duration<double>((1 - tokens_) / rate_)));
+        }
+    }
+    return allowed;
+}
+
+} // namespace alerts
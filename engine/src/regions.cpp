@@ -0,0 +1,49 @@
+#include "alerts/regions.h"
+
+namespace alerts {
+
+RegionRegistry::RegionRegistry() {
+    for (RegionId& id : known_ids_) {
+        id = kUnassigned;
+    }
+}
+
+RegionId RegionRegistry::add(const char* name, std::size_t size) {
+    RegionId id = RegionId(names_.size());
+    names_.emplace_back(name, size);
+    return id;
+}
+
+RegionId RegionRegistry::intern(const char* name, std::size_t size) {
+    int known = find_known_region(name, size);
+    if (known >= 0) {
+        if (known_ids_[known] == kUnassigned) {
+            known_ids_[known] = add(name, size);
+        }
+        return known_ids_[known];
+    }
+    key_.assign(name, size); // reused, so looking up a long name does not allocate
+    auto it = ids_.find(key_);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    RegionId id = add(name, size);
+    ids_.emplace(key_, id);
+    return id;
+}
+
+bool RegionRegistry::find(const std::string& name, RegionId& id) const {
+    int known = find_known_region(name.data(), name.size());
+    if (known >= 0) {
+        id = known_ids_[known];
+        return id != kUnassigned;
+    }
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+} // namespace alerts
@@ -0,0 +1,260 @@
+#include "alerts/seat.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace alerts {
+
+namespace {
+
+const std::string kNoKey;
+
+bool socket_address(const std::string& path, sockaddr_un& address, std::string& error) {
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "Not a socket path: " + path;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/**
+ * @brief Removes a socket left at a path by a service that did not stop cleanly. @return false and sets error if the
+ * socket is still served, or cannot be probed.
+ */
+bool remove_stale(const std::string& path, const sockaddr_un& address, std::string& error) {
+    int probe = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        error = "Cannot serve " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    int result = connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    int connect_error = errno;
+    close(probe);
+    if (result == 0) {
+        error = "Cannot serve " + path + ": another instance is serving it";
+        return false;
+    }
+    if (connect_error != ECONNREFUSED) {
+        error = "Cannot tell whether " + path + " is served: " + std::strerror(connect_error);
+        return false;
+    }
+    unlink(path.c_str()); // nobody listens: left by an instance that did not stop cleanly
+    return true;
+}
+
+} // namespace
+
+SeatServer::SeatServer(EventLoop& loop, const Engine& engine, std::string path)
+    : loop_(loop), engine_(engine), path_(std::move(path)), sender_(std::random_device()()) {}
+
+SeatServer::~SeatServer() {
+    stop();
+}
+
+bool SeatServer::start(std::string& error) {
+    if (fd_ >= 0) {
+        return true;
+    }
+    sockaddr_un address;
+    if (!socket_address(path_, address, error)) {
+        return false;
+    }
+    struct stat existing;
+    if (lstat(path_.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode) && !remove_stale(path_, address, error)) {
+        return false;
+    }
+    fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(path_.c_str(), 0666) != 0 || listen(fd_, 64) != 0 ||
+        !loop_.watch_fd(fd_, EPOLLIN, [this](std::uint32_t) { accept_agents(); })) {
+        error = "Cannot serve " + path_ + ": " + std::strerror(errno);
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void SeatServer::stop() {
+    while (!agents_.empty()) {
+        drop(agents_.back());
+    }
+    if (fd_ < 0) {
+        return;
+    }
+    loop_.unwatch_fd(fd_);
+    close(fd_);
+    fd_ = -1;
+    unlink(path_.c_str());
+}
+
+void SeatServer::accept_agents() {
+    bool accepted = false;
+    for (;;) {
+        int agent = accept4(fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (agent < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        // Agents send nothing; readiness only tells that one has gone.
+        if (!loop_.watch_fd(agent, EPOLLIN, [this, agent](std::uint32_t) {
+                char byte;
+                ssize_t size = recv(agent, &byte, 1, MSG_DONTWAIT);
+                if (size == 0 || (size < 0 && errno != EAGAIN && errno != EINTR)) {
+                    drop(agent);
+                }
+            })) {
+            close(agent);
+            continue;
+        }
+        agents_.push_back(agent);
+        ++stats_.connected;
+        accepted = true;
+    }
+    if (accepted) {
+        // The agents already connected take the same statuses again, which changes nothing for them.
+        publish_state(engine_);
+    }
+}
+
+void SeatServer::drop(int fd) {
+    for (std::size_t i = 0; i < agents_.size(); ++i) {
+        if (agents_[i] == fd) {
+            agents_[i] = agents_.back();
+            agents_.pop_back();
+            loop_.unwatch_fd(fd);
+            close(fd);
+            return;
+        }
+    }
+}
+
+bool SeatServer::send(Packet& packet) {
+    packet.sender = sender_;
+    packet.sequence = ++sequence_;
+    packet.sent = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::size_t size = encode_packet(packet, kNoKey, buffer_);
+    for (std::size_t i = 0; i < agents_.size();) {
+        int agent = agents_[i];
+        if (::send(agent, buffer_, size, MSG_DONTWAIT | MSG_NOSIGNAL) == ssize_t(size)) {
+            ++i;
+            continue;
+        }
+        if (errno == EAGAIN) {
+            ++stats_.dropped;
+        }
+        drop(agent); // the last agent takes its place
+    }
+    return true;
+}
+
+SeatAgent::SeatAgent(EventLoop& loop, Engine& engine, std::string path, Clock::duration retry)
+    : loop_(loop), engine_(engine), path_(std::move(path)), retry_(retry) {}
+
+SeatAgent::~SeatAgent() {
+    stop();
+}
+
+bool SeatAgent::start(std::string& error) {
+    if (running_) {
+        return true;
+    }
+    running_ = true;
+    if (connect_service(error)) {
+        return true;
+    }
+    disconnect();
+    return false;
+}
+
+void SeatAgent::stop() {
+    running_ = false;
+    loop_.cancel_timer(timer_);
+    timer_ = 0;
+    disconnect();
+}
+
+bool SeatAgent::connect_service(std::string& error) {
+    sockaddr_un address;
+    if (!socket_address(path_, address, error)) {
+        return false;
+    }
+    fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        error = "Cannot connect to " + path_ + ": " + std::strerror(errno);
+        return false;
+    }
+    ucred peer{};
+    socklen_t size = sizeof(peer);
+    if (getsockopt(fd_, SOL_SOCKET, SO_PEERCRED, &peer, &size) != 0 || (peer.uid != 0 && peer.uid != getuid())) {
+        error = path_ + " is served by neither root nor this user";
+        return false;
+    }
+    if (!loop_.watch_fd(fd_, EPOLLIN, [this](std::uint32_t) { receive(); })) {
+        error = "Cannot watch " + path_;
+        return false;
+    }
+    ++stats_.connects;
+    return true;
+}
+
+void SeatAgent::disconnect() {
+    if (fd_ >= 0) {
+        loop_.unwatch_fd(fd_);
+        close(fd_);
+        fd_ = -1;
+    }
+    if (running_ && timer_ == 0) {
+        timer_ = loop_.add_timer(retry_, [this] {
+            timer_ = 0;
+            std::string error;
+            if (!connect_service(error)) {
+                disconnect();
+            }
+        });
+    }
+}
+
+void SeatAgent::receive() {
+    char buffer[kMaxPacketSize + 1];
+    while (fd_ >= 0) {
+        ssize_t size = recv(fd_, buffer, sizeof(buffer), 0);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && errno == EAGAIN) {
+            return;
+        }
+        if (size <= 0) {
+            disconnect(); // the service stopped; it is reached again when it is back
+            return;
+        }
+        ++stats_.received;
+        if (!decode_packet(buffer, std::size_t(size), kNoKey, packet_)) {
+            ++stats_.rejected;
+            continue;
+        }
+        if (packet_.type == PacketType::Transition || packet_.type == PacketType::State) {
+            engine_.apply_reading(packet_.region, packet_.status, packet_.time);
+        }
+        if (on_packet_) {
+            on_packet_(packet_);
+        }
+    }
+}
+
+} // namespace alerts
@@ -0,0 +1,50 @@
+#include "alerts/service_manager.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace alerts {
+
+bool notify_service_manager(const std::string& state) {
+    const char* path = std::getenv("NOTIFY_SOCKET");
+    if (!path || (path[0] != '/' && path[0] != '@')) {
+        return false;
+    }
+    size_t length = std::strlen(path);
+    sockaddr_un address = {};
+    if (length >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path, length);
+    if (path[0] == '@') {
+        address.sun_path[0] = '\0'; // abstract namespace
+    }
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t sent = sendto(fd, state.data(), state.size(), MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&address),
+                          socklen_t(offsetof(sockaddr_un, sun_path) + length));
+    close(fd);
+    return sent == ssize_t(state.size());
+}
+
+std::chrono::microseconds service_watchdog_timeout() {
+    const char* usec = std::getenv("WATCHDOG_USEC");
+    if (!usec) {
+        return std::chrono::microseconds(0);
+    }
+    // WATCHDOG_PID, when set, names the process the watchdog is meant for.
+    const char* pid = std::getenv("WATCHDOG_PID");
+    if (pid && std::strtol(pid, nullptr, 10) != long(getpid())) {
+        return std::chrono::microseconds(0);
+    }
+    long long timeout = std::strtoll(usec, nullptr, 10);
+    return std::chrono::microseconds(timeout > 0 ? timeout : 0);
+}
+
+} // namespace alerts
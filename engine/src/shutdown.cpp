@@ -0,0 +1,70 @@
+#include "alerts/shutdown.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include "alerts/service_manager.h"
+#include <pthread.h>
+#include <unistd.h>
+
+namespace alerts {
+
+GracefulShutdown::GracefulShutdown(EventLoop& loop) : loop_(loop) {
+    if (!loop_.watch_signals({SIGTERM, SIGINT, SIGHUP}, [this](int signal_number) { signal(signal_number); })) {
+        std::cerr << "Failed to watch termination signals; the monitor will not shut down cleanly" << std::endl;
+    }
+}
+
+void GracefulShutdown::attach(Monitor& monitor, Engine& engine, std::string state_file,
+                              std::chrono::seconds drain_timeout, Watchdog* watchdog) {
+    monitor_ = &monitor;
+    watchdog_ = watchdog;
+    engine_ = &engine;
+    state_file_ = std::move(state_file);
+    drain_timeout_ = drain_timeout;
+}
+
+void GracefulShutdown::signal(int signal_number) {
+    if (signal_number == SIGHUP) {
+        restart_ = true;
+    }
+    if (shutting_down_) {
+        return;
+    }
+    shutting_down_ = true;
+    std::cerr << "Received " << strsignal(signal_number) << ", shutting down" << std::endl;
+
+    notify_service_manager("STOPPING=1");
+    if (watchdog_) {
+        watchdog_->stop();
+    }
+    if (monitor_) {
+        monitor_->stop();
+    }
+    if (engine_) {
+        if (!engine_->drain(std::chrono::steady_clock::now() + drain_timeout_)) {
+            std::cerr << "Pending notifications were cancelled after " << drain_timeout_.count() << " s" << std::endl;
+        }
+        std::string error;
+        if (!state_file_.empty() && !engine_->save_state(state_file_, error)) {
+            std::cerr << error << std::endl;
+        }
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    loop_.stop();
+}
+
+void GracefulShutdown::reexec(char** argv) {
+    // The new image inherits the signal mask; unblock the signals the loop was handling.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+    execv("/proc/self/exe", argv);
+    std::cerr << "Failed to restart: " << std::strerror(errno) << std::endl;
+}
+
+} // namespace alerts
@@ -0,0 +1,70 @@
+#include "alerts/startup_profile.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace alerts {
+
+namespace {
+
+/**
+ * @brief Returns the time since this process was exec'd, from /proc, in milliseconds.
+ * The kernel records the start time in clock ticks, so the resolution is 1/CLK_TCK (usually 10 ms).
+ * @return The elapsed time, or a negative value if /proc is not available.
+ */
+double ms_since_exec() {
+    std::ifstream stat_file("/proc/self/stat");
+    std::ifstream uptime_file("/proc/uptime");
+    std::string stat;
+    double uptime = 0;
+    if (!std::getline(stat_file, stat) || !(uptime_file >> uptime)) {
+        return -1;
+    }
+    // The command name may contain spaces; the remaining fields start after its closing ')'.
+    size_t paren = stat.rfind(')');
+    if (paren == std::string::npos) {
+        return -1;
+    }
+    std::istringstream fields(stat.substr(paren + 2));
+    std::string field;
+    unsigned long long start_ticks = 0;
+    for (int i = 3; i <= 22 && fields >> field; ++i) {
+        if (i == 22) {
+            start_ticks = std::strtoull(field.c_str(), nullptr, 10);
+        }
+    }
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (!start_ticks || ticks <= 0) {
+        return -1;
+    }
+    return (uptime - double(start_ticks) / double(ticks)) * 1000.0;
+}
+
+} // namespace
+
+StartupProfile::StartupProfile(std::ostream& log)
+    : log_(log), started_(std::chrono::steady_clock::now()), exec_ms_(ms_since_exec()) {
+    if (exec_ms_ >= 0) {
+        std::ostringstream line;
+        line << "[startup] main() reached " << std::fixed << std::setprecision(0) << exec_ms_ << " ms after exec";
+        log_ << line.str() << std::endl;
+    }
+}
+
+void StartupProfile::mark(const std::string& phase) {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    phases_.emplace_back(phase, ms);
+    std::ostringstream line;
+    line << "[startup] +" << std::fixed << std::setprecision(1) << ms << " ms: " << phase;
+    log_ << line.str() << std::endl;
+}
+
+std::vector<std::pair<std::string, double>> StartupProfile::phases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return phases_;
+}
+
+} // namespace alerts
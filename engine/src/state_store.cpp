@@ -0,0 +1,39 @@
+#include "alerts/state_store.h"
+
+namespace alerts {
+
+void StateStore::grow(RegionId region) {
+    statuses_.resize(size_t(region) + 1, Status::Unknown);
+    active_.resize(size_t(region) + 1, 0);
+    changed_at_.resize(size_t(region) + 1, 0);
+}
+
+void StateStore::restore(RegionId region, Status status, bool alert_active) {
+    if (region >= statuses_.size()) {
+        grow(region);
+    }
+    statuses_[region] = status;
+    active_[region] = alert_active ? 1 : 0;
+}
+
+void StateStore::apply(const Snapshot& snapshot, std::vector<Transition>& transitions) {
+    for (const RegionReading& reading : snapshot.readings) {
+        if (reading.region >= statuses_.size()) {
+            grow(reading.region);
+        }
+        if (statuses_[reading.region] != reading.status) {
+            statuses_[reading.region] = reading.status;
+            changed_at_[reading.region] = snapshot.time;
+        }
+        std::uint8_t& active = active_[reading.region];
+        if (!active && reading.status == Status::Full) {
+            active = 1;
+            transitions.push_back({reading.region, TransitionKind::AlertOn, reading.status, snapshot.time});
+        } else if (active && (reading.status == Status::Null || reading.status == Status::NoData)) {
+            active = 0;
+            transitions.push_back({reading.region, TransitionKind::AlertOff, reading.status, snapshot.time});
+        }
+    }
+}
+
+} // namespace alerts
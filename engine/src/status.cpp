@@ -0,0 +1,31 @@
+#include "alerts/status.h"
+#include <cstring>
+
+namespace alerts {
+
+Status parse_status(const char* text, std::size_t size) {
+    switch (size) {
+    case 4:
+        if (std::memcmp(text, "full", 4) == 0) return Status::Full;
+        if (std::memcmp(text, "null", 4) == 0) return Status::Null;
+        break;
+    case 7:
+        if (std::memcmp(text, "partial", 7) == 0) return Status::Partial;
+        if (std::memcmp(text, "no_data", 7) == 0) return Status::NoData;
+        break;
+    }
+    return Status::Unknown;
+}
+
+const char* status_name(Status status) {
+    switch (status) {
+    case Status::Null: return "null";
+    case Status::NoData: return "no_data";
+    case Status::Partial: return "partial";
+    case Status::Full: return "full";
+    case Status::Unknown: break;
+    }
+    return "unknown";
+}
+
+} // namespace alerts
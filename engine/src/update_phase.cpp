@@ -0,0 +1,128 @@
+#include "alerts/update_phase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace alerts {
+
+namespace {
+
+const double kDecay = 0.95;           // weight kept by older windows at every new one
+const double kMinObservations = 4;    // informative windows needed to call the phase known
+const double kOutlier = 0.05;         // probability that a window is wrong (upstream jitter, clock steps)
+const double kCredible = 3.0;         // log-likelihood below the best at which a phase is ruled out
+const std::uint64_t kProbeLearning = 2; // a probe every other poll while learning
+const std::uint64_t kProbeLocked = 64;  // then every sixty-fourth, to follow a drifting upstream
+
+std::int64_t modulo(std::int64_t value, std::int64_t divisor) {
+    std::int64_t result = value % divisor;
+    return result < 0 ? result + divisor : result;
+}
+
+} // namespace
+
+UpdatePhase::UpdatePhase(std::int64_t period, std::int64_t resolution)
+    : period_(std::max<std::int64_t>(period, 1)),
+      resolution_(std::max<std::int64_t>(std::min(resolution, period_), 1)),
+      weights_(size_t((period_ + resolution_ - 1) / resolution_), 0.0),
+      spread_(period_) {}
+
+void UpdatePhase::observe(std::int64_t time, bool changed) {
+    std::int64_t previous = last_time_;
+    last_time_ = time;
+    // A window of a whole period or more covers every phase, and says nothing.
+    if (!changed || previous < 0 || time <= previous || time - previous >= period_) {
+        return;
+    }
+    // The update was published in (previous, time]: every phase in the window is equally likely, and a
+    // phase outside it is only possible if the window was wrong.
+    size_t bins = weights_.size();
+    size_t first = size_t(modulo(previous, period_) / resolution_);
+    size_t last = size_t(modulo(time - 1, period_) / resolution_);
+    size_t inside = (last + bins - first) % bins + 1;
+    double in_window = std::log((1 - kOutlier) / inside);
+    double outside = std::log(kOutlier / bins);
+    for (double& weight : weights_) {
+        weight = weight * kDecay + outside;
+    }
+    for (size_t bin = first;; bin = (bin + 1) % bins) {
+        weights_[bin] += in_window - outside;
+        if (bin == last) {
+            break;
+        }
+    }
+    observations_ = observations_ * kDecay + 1;
+    update_estimate();
+}
+
+void UpdatePhase::update_estimate() {
+    // The phases that no window rules out form a run of bins around the best one. Polls go just after the
+    // end of the run, which covers the upstream's jitter as well; the width of the run is what is still in
+    // doubt, and how far the probes reach.
+    size_t bins = weights_.size();
+    size_t best = size_t(std::max_element(weights_.begin(), weights_.end()) - weights_.begin());
+    double threshold = weights_[best] - kCredible;
+    size_t end = best;
+    size_t width = 1;
+    for (; width < bins && weights_[(end + 1) % bins] >= threshold; ++width) {
+        end = (end + 1) % bins;
+    }
+    for (size_t start = best; width < bins && weights_[(start + bins - 1) % bins] >= threshold; ++width) {
+        start = (start + bins - 1) % bins;
+    }
+    phase_ = modulo(std::int64_t(end + 1) * resolution_, period_);
+    spread_ = std::int64_t(width) * resolution_;
+    // Locked once the run is narrow: probes are then rare, and only follow a drifting upstream.
+    locked_ = observations_ >= kMinObservations && spread_ <= period_ / 8;
+}
+
+std::int64_t UpdatePhase::dither(std::int64_t step) {
+    random_ = random_ * 1664525u + 1013904223u;
+    // Probes reach across the phases still in doubt, and at least a couple of bins.
+    std::int64_t range = std::max<std::int64_t>(std::min(std::max(spread_, 2 * resolution_), step - 1), 1);
+    return 1 + std::int64_t(random_ >> 8) % range;
+}
+
+std::int64_t UpdatePhase::next_poll(std::int64_t last, std::int64_t interval) {
+    if (!anchored_) {
+        anchored_ = true;
+        phase_ = modulo(last, period_);
+    }
+    // After a probe, the poll it was early for: between them, the two windows tell whether the update came
+    // before the probe or after it. The poll after that is skipped to keep the average rate.
+    if (probed_ > last) {
+        std::int64_t target = probed_;
+        probed_ = 0;
+        skip_ = true;
+        return target;
+    }
+    // Polls stay on a grid of whole fractions of the period, never closer than the interval; a poll
+    // interval longer than the period leaves nothing to align to.
+    if (interval > period_) {
+        return last + interval;
+    }
+    std::int64_t step = period_ / (period_ / std::max<std::int64_t>(interval, 1));
+    std::int64_t next = last + step;
+    if (skip_) {
+        skip_ = false;
+        next += step;
+    }
+    // The grid point nearest to one step after the last poll: just after the expected update once it
+    // has been estimated, and in step with the first poll until then.
+    std::int64_t aligned = next - modulo(next - phase_, step);
+    if (next - aligned > step / 2 || aligned <= last) {
+        aligned += step;
+    }
+    // Probe early for the grid point at the estimated phase now and then; the other grid points have nothing
+    // to tell.
+    if (modulo(aligned - phase_, period_) == 0 && ++polls_ % (locked_ ? kProbeLocked : kProbeLearning) == 0) {
+        probed_ = aligned;
+        std::int64_t probe = aligned - dither(step);
+        if (probe > last) {
+            return probe;
+        }
+        probed_ = 0;
+    }
+    return aligned;
+}
+
+} // namespace alerts
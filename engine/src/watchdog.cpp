@@ -0,0 +1,112 @@
+#include "alerts/watchdog.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include "alerts/service_manager.h"
+
+namespace alerts {
+
+namespace {
+
+Watchdog::Clock::rep now_ticks() {
+    return Watchdog::Clock::now().time_since_epoch().count();
+}
+
+std::chrono::duration<double> seconds(Watchdog::Clock::duration duration) {
+    return std::chrono::duration<double>(duration);
+}
+
+} // namespace
+
+Watchdog::Watchdog(EventLoop& loop, Clock::duration hang_timeout, Clock::duration stale_after)
+    : loop_(loop), hang_timeout_(hang_timeout), stale_after_(stale_after),
+      check_interval_(std::min(hang_timeout, stale_after) / 4) {
+    // systemd recommends pinging at half its timeout.
+    Clock::duration service_timeout = service_watchdog_timeout();
+    ping_service_manager_ = service_timeout.count() > 0;
+    if (ping_service_manager_ && service_timeout / 2 < check_interval_) {
+        check_interval_ = service_timeout / 2;
+    }
+}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::data_received() {
+    last_data_ = now_ticks();
+}
+
+void Watchdog::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    last_heartbeat_ = now_ticks();
+    last_data_ = now_ticks();
+    stopping_ = false;
+    self_ = std::make_shared<Watchdog*>(this);
+    heartbeat_timer_ = loop_.add_timer(check_interval_, [this] { heartbeat(); });
+    loop_.post([] { notify_service_manager("READY=1"); });
+    thread_ = std::thread(&Watchdog::watch, this, std::weak_ptr<Watchdog*>(self_));
+}
+
+void Watchdog::stop() {
+    loop_.cancel_timer(heartbeat_timer_);
+    heartbeat_timer_ = 0;
+    self_.reset();
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    thread_.join();
+}
+
+void Watchdog::heartbeat() {
+    last_heartbeat_ = now_ticks();
+    heartbeat_timer_ = loop_.add_timer(check_interval_, [this] { heartbeat(); });
+}
+
+void Watchdog::watch(std::weak_ptr<Watchdog*> self) {
+    bool hung = false;
+    bool stale = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wakeup_.wait_for(lock, check_interval_, [this] { return stopping_; })) {
+        Clock::rep now = now_ticks();
+        Clock::duration since_heartbeat(now - last_heartbeat_);
+        if (since_heartbeat < hang_timeout_) {
+            if (hung) {
+                std::cerr << "Event loop recovered" << std::endl;
+            }
+            hung = false;
+            if (ping_service_manager_) {
+                notify_service_manager("WATCHDOG=1");
+            }
+        } else if (!hung) {
+            hung = true;
+            if (on_hang_) {
+                on_hang_(since_heartbeat);
+            } else {
+                std::cerr << "Event loop hung for " << seconds(since_heartbeat).count() << " s, aborting" << std::endl;
+                std::abort();
+            }
+        }
+
+        Clock::duration since_data(now - last_data_);
+        if ((since_data >= stale_after_) != stale) {
+            stale = !stale;
+            bool is_stale = stale;
+            loop_.post([self, is_stale, since_data] {
+                auto watchdog = self.lock();
+                if (watchdog && (*watchdog)->on_stale_) {
+                    (*watchdog)->on_stale_(is_stale, since_data);
+                }
+            });
+        }
+    }
+}
+
+} // namespace alerts
@@ -1,2 +1,9 @@
 #!/bin/bash
-g++ main.cpp -o alert_service `pkg-config --cflags --libs gtkmm-3.0 gstreamer-1.0 gstreamermm-1.0 libcurl jsoncpp` -pthread -std=c++11
+# Builds the optimised release binary. Pass "pgo" to build the profile-guided variant.
+set -e
+cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+if [ "$1" = "pgo" ]; then
+    cmake --build build --target pgo
+else
+    cmake --build build -j"$(nproc)"
+fi
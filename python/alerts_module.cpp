@@ -0,0 +1,387 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <cstddef>
+#include <new>
+#include "alerts/engine.h"
+
+/*
+ * Python bindings of the alerts engine, for batch analysis of recorded feeds.
+ *
+ * Region states, alert flags and transitions are exposed through the buffer
+ * protocol directly from the engine's own vectors, so
+ *
+ *     numpy.frombuffer(engine.states, dtype=numpy.uint8)
+ *     numpy.frombuffer(engine.transitions, dtype=alerts.TRANSITION_DTYPE)
+ *
+ * copy nothing. As with bytearray, the engine cannot be fed while such views
+ * are alive, since feeding may reallocate the vectors behind them. replay()
+ * feeds without the GIL; until it returns, the engine refuses every other
+ * call from any thread.
+ */
+
+namespace {
+
+static_assert(sizeof(alerts::Status) == 1, "Status must be exposed as uint8");
+static_assert(sizeof(alerts::Transition) == 16, "TRANSITION_FORMAT must match alerts::Transition");
+static_assert(offsetof(alerts::Transition, region) == 0, "TRANSITION_FORMAT must match alerts::Transition");
+static_assert(offsetof(alerts::Transition, kind) == 2, "TRANSITION_FORMAT must match alerts::Transition");
+static_assert(offsetof(alerts::Transition, status) == 3, "TRANSITION_FORMAT must match alerts::Transition");
+static_assert(offsetof(alerts::Transition, time) == 8, "TRANSITION_FORMAT must match alerts::Transition");
+
+// PEP 3118 layout of alerts::Transition.
+char kTransitionFormat[] = "T{H:region:B:kind:B:status:4x:q:time:}";
+char kByteFormat[] = "B";
+
+struct EngineObject {
+    PyObject_HEAD
+    alerts::Engine* engine;
+    Py_ssize_t exports; // live buffer views into the engine
+    bool busy;          // replay() is feeding it without the GIL
+};
+
+enum class ArrayKind { States, Alerts, Transitions };
+
+struct ArrayObject {
+    PyObject_HEAD
+    EngineObject* owner;
+    ArrayKind kind;
+};
+
+// Filled in by PyInit_alerts(), which also sets the headers as PyVarObject_HEAD_INIT(nullptr, 0) would.
+PyTypeObject ArrayType = {};
+PyTypeObject EngineType = {};
+
+/**
+ * @brief Raises RuntimeError and returns false if replay() is feeding the engine on another thread.
+ */
+bool check_not_busy(EngineObject* self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "the engine is replaying a recording on another thread");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Raises BufferError and returns false if views into the engine are alive, or RuntimeError if it is busy.
+ */
+bool check_not_exported(EngineObject* self) {
+    if (!check_not_busy(self)) {
+        return false;
+    }
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError,
+                        "cannot feed the engine while views of its states or transitions exist");
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// alerts.Array: a zero-copy view of one of the engine's vectors.
+
+int Array_getbuffer(PyObject* obj, Py_buffer* view, int flags) {
+    ArrayObject* self = reinterpret_cast<ArrayObject*>(obj);
+    static char empty = 0;
+    if (self->owner->busy) {
+        PyErr_SetString(PyExc_BufferError, "cannot export a view while the engine is replaying a recording");
+        return -1;
+    }
+    const alerts::Engine& engine = *self->owner->engine;
+    void* data = nullptr;
+    Py_ssize_t count = 0;
+    Py_ssize_t itemsize = 1;
+    char* format = kByteFormat;
+    switch (self->kind) {
+    case ArrayKind::States:
+        data = const_cast<alerts::Status*>(engine.state().statuses().data());
+        count = Py_ssize_t(engine.state().statuses().size());
+        break;
+    case ArrayKind::Alerts:
+        data = const_cast<std::uint8_t*>(engine.state().active().data());
+        count = Py_ssize_t(engine.state().active().size());
+        break;
+    case ArrayKind::Transitions:
+        data = const_cast<alerts::Transition*>(engine.history().data());
+        count = Py_ssize_t(engine.history().size());
+        itemsize = Py_ssize_t(sizeof(alerts::Transition));
+        format = kTransitionFormat;
+        break;
+    }
+    if (PyBuffer_FillInfo(view, obj, data ? data : &empty, count * itemsize, 1, flags) < 0) {
+        return -1;
+    }
+    // PyBuffer_FillInfo describes plain bytes; describe the records when asked to.
+    view->itemsize = itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? format : nullptr;
+    if (flags & PyBUF_ND) {
+        view->ndim = 1;
+        view->shape = reinterpret_cast<Py_ssize_t*>(PyMem_Malloc(2 * sizeof(Py_ssize_t)));
+        if (!view->shape) {
+            PyBuffer_Release(view);
+            PyErr_NoMemory();
+            return -1;
+        }
+        view->shape[0] = count;
+        view->internal = view->shape;
+        if (flags & PyBUF_STRIDES) {
+            view->strides = view->shape + 1;
+            view->strides[0] = itemsize;
+        }
+    }
+    ++self->owner->exports;
+    return 0;
+}
+
+void Array_releasebuffer(PyObject* obj, Py_buffer* view) {
+    ArrayObject* self = reinterpret_cast<ArrayObject*>(obj);
+    PyMem_Free(view->internal);
+    --self->owner->exports;
+}
+
+Py_ssize_t Array_length(PyObject* obj) {
+    ArrayObject* self = reinterpret_cast<ArrayObject*>(obj);
+    if (!check_not_busy(self->owner)) {
+        return -1;
+    }
+    const alerts::Engine& engine = *self->owner->engine;
+    switch (self->kind) {
+    case ArrayKind::States: return Py_ssize_t(engine.state().statuses().size());
+    case ArrayKind::Alerts: return Py_ssize_t(engine.state().active().size());
+    case ArrayKind::Transitions: return Py_ssize_t(engine.history().size());
+    }
+    return 0;
+}
+
+void Array_dealloc(PyObject* obj) {
+    ArrayObject* self = reinterpret_cast<ArrayObject*>(obj);
+    Py_XDECREF(self->owner);
+    Py_TYPE(obj)->tp_free(obj);
+}
+
+PyBufferProcs Array_as_buffer = { Array_getbuffer, Array_releasebuffer };
+PySequenceMethods Array_as_sequence = {};
+
+PyObject* make_array(EngineObject* owner, ArrayKind kind) {
+    ArrayObject* array = PyObject_New(ArrayObject, &ArrayType);
+    if (!array) {
+        return nullptr;
+    }
+    Py_INCREF(owner);
+    array->owner = owner;
+    array->kind = kind;
+    return reinterpret_cast<PyObject*>(array);
+}
+
+// ---------------------------------------------------------------------------
+// alerts.Engine
+
+PyObject* Engine_new(PyTypeObject* type, PyObject*, PyObject*) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(type->tp_alloc(type, 0));
+    if (!self) {
+        return nullptr;
+    }
+    self->engine = new (std::nothrow) alerts::Engine;
+    if (!self->engine) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    self->engine->set_keep_history(true);
+    self->exports = 0;
+    self->busy = false;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void Engine_dealloc(PyObject* obj) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    delete self->engine;
+    Py_TYPE(obj)->tp_free(obj);
+}
+
+PyObject* Engine_watch(PyObject* obj, PyObject* args) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    const char* region = nullptr;
+    Py_ssize_t size = 0;
+    if (!PyArg_ParseTuple(args, "s#:watch", &region, &size) || !check_not_exported(self)) {
+        return nullptr;
+    }
+    self->engine->watch(std::string(region, size_t(size)));
+    Py_RETURN_NONE;
+}
+
+PyObject* Engine_feed(PyObject* obj, PyObject* args) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    Py_buffer body;
+    long long time = 0;
+    if (!PyArg_ParseTuple(args, "y*L:feed", &body, &time)) {
+        return nullptr;
+    }
+    if (!check_not_exported(self)) {
+        PyBuffer_Release(&body);
+        return nullptr;
+    }
+    bool decoded = self->engine->feed(static_cast<const char*>(body.buf), size_t(body.len), time);
+    PyBuffer_Release(&body);
+    if (!decoded) {
+        PyErr_SetString(PyExc_ValueError, "the feed body is not a JSON object");
+        return nullptr;
+    }
+    return PyLong_FromSize_t(self->engine->transitions().size());
+}
+
+PyObject* Engine_replay(PyObject* obj, PyObject* args) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    PyObject* path_object = nullptr;
+    if (!PyArg_ParseTuple(args, "O&:replay", PyUnicode_FSConverter, &path_object)) {
+        return nullptr;
+    }
+    std::string path = PyBytes_AS_STRING(path_object);
+    Py_DECREF(path_object);
+    if (!check_not_exported(self)) {
+        return nullptr;
+    }
+
+    alerts::ReplayFeedSource source(path);
+    if (!source.good()) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, path.c_str());
+    }
+    size_t replayed = 0;
+    size_t failed = 0;
+    // No view can be taken while busy, so the check above still holds when the GIL is taken back.
+    self->busy = true;
+    Py_BEGIN_ALLOW_THREADS
+    alerts::FetchResult fetched;
+    while (source.fetch(fetched)) {
+        if (!self->engine->feed(fetched.body.data(), fetched.body.size(), fetched.time)) {
+            ++failed;
+        }
+        ++replayed;
+    }
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    if (failed) {
+        PyErr_Format(PyExc_ValueError, "%zu of %zu snapshots in %s could not be decoded",
+                     failed, replayed, path.c_str());
+        return nullptr;
+    }
+    return PyLong_FromSize_t(replayed);
+}
+
+PyObject* Engine_clear_transitions(PyObject* obj, PyObject*) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    if (!check_not_exported(self)) {
+        return nullptr;
+    }
+    self->engine->clear_history();
+    Py_RETURN_NONE;
+}
+
+PyObject* Engine_get_regions(PyObject* obj, void*) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(obj);
+    if (!check_not_busy(self)) {
+        return nullptr;
+    }
+    const alerts::RegionRegistry& regions = self->engine->regions();
+    PyObject* names = PyTuple_New(Py_ssize_t(regions.size()));
+    if (!names) {
+        return nullptr;
+    }
+    for (size_t id = 0; id < regions.size(); ++id) {
+        const std::string& name = regions.name(alerts::RegionId(id));
+        PyObject* item = PyUnicode_DecodeUTF8(name.data(), Py_ssize_t(name.size()), "replace");
+        if (!item) {
+            Py_DECREF(names);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(names, Py_ssize_t(id), item);
+    }
+    return names;
+}
+
+PyObject* Engine_get_states(PyObject* obj, void*) {
+    return make_array(reinterpret_cast<EngineObject*>(obj), ArrayKind::States);
+}
+
+PyObject* Engine_get_alerts(PyObject* obj, void*) {
+    return make_array(reinterpret_cast<EngineObject*>(obj), ArrayKind::Alerts);
+}
+
+PyObject* Engine_get_transitions(PyObject* obj, void*) {
+    return make_array(reinterpret_cast<EngineObject*>(obj), ArrayKind::Transitions);
+}
+
+PyMethodDef Engine_methods[] = {
+    {"watch", Engine_watch, METH_VARARGS,
+     "watch(region)\n--\n\nRegister a region so it gets an ID before it appears in the feed."},
+    {"feed", Engine_feed, METH_VARARGS,
+     "feed(body, time)\n--\n\nProcess one response body; returns the number of transitions."},
+    {"replay", Engine_replay, METH_VARARGS,
+     "replay(path)\n--\n\nProcess a whole recording; returns the number of snapshots."},
+    {"clear_transitions", Engine_clear_transitions, METH_NOARGS,
+     "clear_transitions()\n--\n\nForget the recorded transitions."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef Engine_getset[] = {
+    {"regions", Engine_get_regions, nullptr, "Region names, indexed by region ID.", nullptr},
+    {"states", Engine_get_states, nullptr, "Last status of every region (uint8), indexed by region ID.", nullptr},
+    {"alerts", Engine_get_alerts, nullptr, "Alert flag of every region (uint8), indexed by region ID.", nullptr},
+    {"transitions", Engine_get_transitions, nullptr, "Every transition so far, as TRANSITION_DTYPE records.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyModuleDef alerts_module = {
+    PyModuleDef_HEAD_INIT, "alerts",
+    "Batch analysis of recorded alert feeds with the alerts engine.",
+    -1, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_alerts(void) {
+    Array_as_sequence.sq_length = Array_length;
+
+    ArrayType.ob_base = PyVarObject{PyObject_HEAD_INIT(nullptr) 0};
+    ArrayType.tp_name = "alerts.Array";
+    ArrayType.tp_basicsize = sizeof(ArrayObject);
+    ArrayType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ArrayType.tp_doc = "Zero-copy view of an engine array; use memoryview() or numpy.frombuffer().";
+    ArrayType.tp_dealloc = Array_dealloc;
+    ArrayType.tp_as_buffer = &Array_as_buffer;
+    ArrayType.tp_as_sequence = &Array_as_sequence;
+
+    EngineType.ob_base = PyVarObject{PyObject_HEAD_INIT(nullptr) 0};
+    EngineType.tp_name = "alerts.Engine";
+    EngineType.tp_basicsize = sizeof(EngineObject);
+    EngineType.tp_flags = Py_TPFLAGS_DEFAULT;
+    EngineType.tp_doc = "Engine()\n--\n\nAn independent instance of the detection engine.";
+    EngineType.tp_new = Engine_new;
+    EngineType.tp_dealloc = Engine_dealloc;
+    EngineType.tp_methods = Engine_methods;
+    EngineType.tp_getset = Engine_getset;
+
+    if (PyType_Ready(&ArrayType) < 0 || PyType_Ready(&EngineType) < 0) {
+        return nullptr;
+    }
+    PyObject* module = PyModule_Create(&alerts_module);
+    if (!module) {
+        return nullptr;
+    }
+    Py_INCREF(&EngineType);
+    if (PyModule_AddObject(module, "Engine", reinterpret_cast<PyObject*>(&EngineType)) < 0 ||
+        PyModule_AddStringConstant(module, "TRANSITION_FORMAT", kTransitionFormat) < 0 ||
+        PyModule_AddObject(module, "TRANSITION_DTYPE",
+                           Py_BuildValue("[(ss)(ss)(ss)(ss)(ss)]", "region", "<u2", "kind", "u1",
+                                         "status", "u1", "_pad", "V4", "time", "<i8")) < 0 ||
+        PyModule_AddIntConstant(module, "STATUS_NULL", int(alerts::Status::Null)) < 0 ||
+        PyModule_AddIntConstant(module, "STATUS_NO_DATA", int(alerts::Status::NoData)) < 0 ||
+        PyModule_AddIntConstant(module, "STATUS_PARTIAL", int(alerts::Status::Partial)) < 0 ||
+        PyModule_AddIntConstant(module, "STATUS_FULL", int(alerts::Status::Full)) < 0 ||
+        PyModule_AddIntConstant(module, "STATUS_UNKNOWN", int(alerts::Status::Unknown)) < 0 ||
+        PyModule_AddIntConstant(module, "ALERT_OFF", int(alerts::TransitionKind::AlertOff)) < 0 ||
+        PyModule_AddIntConstant(module, "ALERT_ON", int(alerts::TransitionKind::AlertOn)) < 0) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
@@ -0,0 +1,384 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include "alerts/engine.h"
+#include "alerts/event_loop.h"
+#include "alerts/feed_source.h"
+#include "alerts/monitor.h"
+#include "alerts/process_stats.h"
+#include "alerts/queued_notifier.h"
+#include "alerts/update_phase.h"
+#include "stub_server.h"
+#include "synthetic_feed.h"
+
+/*
+ * Feed replay harness.
+ *
+ * A recording is a text file with one upstream snapshot per line:
+ *
+ *     <unix_time>\t<json body>
+ *
+ * Replaying a recording runs every snapshot through the alerts engine, as the
+ * monitor does, without network access or sleeping, and reports the
+ * throughput. `--synthesize` writes a deterministic recording that the
+ * profile-guided build uses as its training workload, `--soak` checks
+ * that resource usage stays flat over weeks of accelerated feed data, and
+ * `--phase` compares poll schedules against a simulated upstream.
+ */
+
+namespace {
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <recording> [--region <name>] [--repeat <n>]\n"
+              << "       " << argv0 << " --synthesize <recording> [--seconds <n>] [--interval <n>] [--seed <n>]\n"
+              << "       " << argv0 << " --soak [--weeks <n>] [--interval <n>] [--region <name>] [--rss-slack <KiB>]\n"
+              << "       " << argv0 << " --phase [--days <n>] [--interval <n>] [--period <n>] [--offset <n>] [--seed <n>]\n";
+}
+
+/**
+ * @brief Counts the transitions that reach the notifiers.
+ */
+class CountingNotifier : public alerts::Notifier {
+public:
+    void notify(const alerts::Transition&, const std::string&) override { ++count; }
+    size_t count = 0;
+};
+
+/**
+ * @brief Soak test: serves weeks of synthetic feed data from a local stub server and polls it, as fast as
+ * possible, with a Monitor and an HttpFeedSource, as the service does. Transitions go to the log notifier, and to
+ * the sound notifier through a QueuedNotifier; sounds are "played" with /bin/true, so every transition still spawns
+ * and reaps a player process. The monitor is stopped and started again at every sample, so its worker thread and
+ * the source's transfers are set up anew. Checks that RSS, thread count and descriptor count stay flat: the first
+ * tenth of the run is a warm-up, and every later sample is compared with the state after it.
+ * @param weeks The simulated time span.
+ * @param interval The simulated time between snapshots in seconds.
+ * @param region The watched region, or an empty string for all regions.
+ * @param rss_slack_kib How much RSS may grow after the warm-up.
+ * @return 0 if resource usage stayed flat, 3 otherwise.
+ */
+int soak(long weeks, long interval, const std::string& region, long rss_slack_kib) {
+    const long snapshots = weeks * 7 * 86400 / interval;
+    const long samples = 100;
+    const long sample_every = snapshots / samples > 0 ? snapshots / samples : 1;
+
+    alerts::tools::SyntheticFeed feed(interval, 1);
+    alerts::FetchResult served; // only used on the server thread
+    alerts::tools::StubServer server("");
+    server.set_handler([&](const std::string&) {
+        feed.next(served);
+        return served.body;
+    });
+
+    alerts::EventLoop loop;
+    alerts::Engine engine;
+    auto sounds = std::make_shared<alerts::SoundNotifier>("/dev/null", "/dev/null", "true");
+    sounds->preload();
+    std::ofstream log("/dev/null");
+    auto counter = std::make_shared<CountingNotifier>();
+    engine.add_notifier(std::make_shared<alerts::QueuedNotifier>(sounds));
+    engine.add_notifier(std::make_shared<alerts::LogNotifier>(log));
+    engine.add_notifier(counter);
+    if (!region.empty()) {
+        engine.watch(region);
+    }
+    alerts::HttpFeedSource source(server.url());
+    alerts::Monitor monitor(loop, engine, source, std::chrono::seconds(0));
+
+    std::cout << "soak: " << weeks << " weeks, " << snapshots << " snapshots\n"
+              << "  progress    RSS KiB  threads  fds  transitions\n";
+    alerts::ProcessStats baseline;
+    alerts::ProcessStats worst;
+    long polls = 0;
+    long failed = 0;
+    monitor.set_poll_callback([&](bool decoded) {
+        ++polls;
+        failed += !decoded;
+        if (polls % sample_every != 0 && polls != snapshots) {
+            return;
+        }
+        alerts::ProcessStats stats = alerts::read_process_stats();
+        long percent = polls * 100 / snapshots;
+        if (percent % 10 == 0) {
+            std::cout << "  " << std::setw(7) << percent << "%" << std::setw(11) << stats.rss_kib
+                      << std::setw(9) << stats.threads << std::setw(5) << stats.fds
+                      << std::setw(13) << counter->count << "\n";
+        }
+        if (polls <= snapshots / 10) {
+            baseline = stats;
+            worst = stats;
+        } else {
+            worst.rss_kib = std::max(worst.rss_kib, stats.rss_kib);
+            worst.threads = std::max(worst.threads, stats.threads);
+            worst.fds = std::max(worst.fds, stats.fds);
+        }
+        monitor.stop();
+        if (polls < snapshots) {
+            monitor.start();
+        } else {
+            loop.stop();
+        }
+    });
+    auto started = std::chrono::steady_clock::now();
+    monitor.start();
+    loop.run();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    engine.drain(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+
+    bool flat = true;
+    if (failed != 0) {
+        std::cout << "FAIL: " << failed << " of " << polls << " polls were not fetched and decoded\n";
+        flat = false;
+    }
+    if (worst.rss_kib - baseline.rss_kib > rss_slack_kib) {
+        std::cout << "FAIL: RSS grew by " << worst.rss_kib - baseline.rss_kib << " KiB after warm-up (allowed "
+                  << rss_slack_kib << " KiB)\n";
+        flat = false;
+    }
+    if (worst.threads != baseline.threads) {
+        std::cout << "FAIL: thread count grew from " << baseline.threads << " to " << worst.threads << "\n";
+        flat = false;
+    }
+    if (worst.fds != baseline.fds) {
+        std::cout << "FAIL: descriptor count grew from " << baseline.fds << " to " << worst.fds << "\n";
+        flat = false;
+    }
+    std::cout << (flat ? "PASS" : "FAIL") << ": " << counter->count << " transitions in " << elapsed
+              << " s, peak RSS " << alerts::read_process_stats().hwm_kib << " KiB\n";
+    return flat ? 0 : 3;
+}
+
+/// Detection latency and request rate of one poll schedule.
+struct ScheduleResult {
+    std::vector<double> latencies; ///< seconds from the publication of a change to the poll that saw it
+    long polls = 0;
+    long locked_polls = 0;          ///< polls sent while UpdatePhase was locked
+};
+
+/**
+ * @brief Phase simulation: an upstream publishes a synthetic snapshot every period, at a fixed offset into the
+ * period plus up to 2 s of jitter, and the monitor polls it every interval, either at a cadence that depends on
+ * when it was started or with UpdatePhase. Both schedules run from 20 different start times over the same
+ * feed, in simulated time, and the detection latency and request rate of each are reported.
+ * @return 0, or 4 if the aligned schedule was not faster or sent more requests.
+ */
+int phase_simulation(long days, long interval, long period, long offset, unsigned seed) {
+    const std::int64_t start = 1672531200000;
+    const std::int64_t end = start + std::int64_t(days) * 86400000;
+    std::mt19937 rng(seed);
+
+    // The upstream: publication times and a content ID that changes with the body.
+    std::vector<std::int64_t> published;
+    std::vector<long> content;
+    alerts::tools::SyntheticFeed feed(period, seed);
+    alerts::FetchResult snapshot;
+    std::string previous;
+    for (std::int64_t tick = start + offset * 1000; tick < end; tick += period * 1000) {
+        feed.next(snapshot);
+        published.push_back(tick + std::int64_t(rng() % 2000));
+        content.push_back(content.empty() ? 0 : content.back() + (snapshot.body != previous));
+        previous.swap(snapshot.body);
+    }
+
+    auto run = [&](std::int64_t first_poll, bool aligned, ScheduleResult& result) {
+        alerts::UpdatePhase phase(period * 1000);
+        size_t visible = 0;   // index of the last snapshot published before the current poll
+        size_t next_change = 1;
+        long seen = -1;
+        for (std::int64_t poll = first_poll; poll < end;) {
+            while (visible + 1 < published.size() && published[visible + 1] <= poll) {
+                ++visible;
+            }
+            if (poll >= published[0]) {
+                for (; next_change <= visible; ++next_change) {
+                    if (content[next_change] != content[next_change - 1]) {
+                        result.latencies.push_back((poll - published[next_change]) / 1000.0);
+                    }
+                }
+            }
+            ++result.polls;
+            result.locked_polls += phase.locked();
+            bool changed = seen >= 0 && content[visible] != seen;
+            seen = content[visible];
+            if (aligned) {
+                phase.observe(poll, changed);
+                poll = phase.next_poll(poll, interval * 1000);
+            } else {
+                poll += interval * 1000;
+            }
+        }
+    };
+
+    ScheduleResult fixed;
+    ScheduleResult aligned;
+    for (int run_index = 0; run_index < 20; ++run_index) {
+        std::int64_t first_poll = start + std::int64_t(rng() % (std::uint64_t(period) * 1000));
+        run(first_poll, false, fixed);
+        run(first_poll, true, aligned);
+    }
+
+    auto print = [&](const char* name, ScheduleResult& result) {
+        std::sort(result.latencies.begin(), result.latencies.end());
+        double mean = 0;
+        for (double latency : result.latencies) {
+            mean += latency;
+        }
+        mean /= result.latencies.size();
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << mean << " s mean" << std::setw(9)
+                  << result.latencies[result.latencies.size() / 2] << " s p50" << std::setw(9)
+                  << result.latencies[result.latencies.size() * 95 / 100] << " s p95" << std::setw(10)
+                  << result.polls * 3600.0 / (20.0 * days * 86400) << " polls/h" << std::setw(7)
+                  << std::setprecision(1) << 100.0 * result.locked_polls / result.polls << "% aligned\n";
+        return mean;
+    };
+    std::cout << "upstream: every " << period << " s at +" << offset << " s (+0..2 s jitter); polls every "
+              << interval << " s; " << days << " days x 20 start times\n";
+    double fixed_mean = print("fixed cadence", fixed);
+    double aligned_mean = print("aligned (UpdatePhase)", aligned);
+    bool ok = aligned_mean < fixed_mean && aligned.polls <= fixed.polls + 20;
+    std::cout << (ok ? "PASS" : "FAIL") << ": mean detection latency " << std::setprecision(2)
+              << fixed_mean << " s -> " << aligned_mean << " s\n";
+    return ok ? 0 : 4;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string recording;
+    std::string synthesize_path;
+    bool soak_test = false;
+    bool phase_test = false;
+    long days = 7;
+    long period = 0;
+    long offset = 37;
+    long weeks = 4;
+    long rss_slack_kib = 1024;
+    std::string region;
+    long seconds = 86400;
+    long interval = 60;
+    unsigned seed = 1;
+    int repeat = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--soak") {
+            soak_test = true;
+        } else if (arg == "--phase") {
+            phase_test = true;
+        } else if (arg == "--days" && has_value) {
+            days = std::atol(argv[++i]);
+        } else if (arg == "--period" && has_value) {
+            period = std::atol(argv[++i]);
+        } else if (arg == "--offset" && has_value) {
+            offset = std::atol(argv[++i]);
+        } else if (arg == "--weeks" && has_value) {
+            weeks = std::atol(argv[++i]);
+        } else if (arg == "--rss-slack" && has_value) {
+            rss_slack_kib = std::atol(argv[++i]);
+        } else if (arg == "--synthesize" && has_value) {
+            synthesize_path = argv[++i];
+        } else if (arg == "--seconds" && has_value) {
+            seconds = std::atol(argv[++i]);
+        } else if (arg == "--interval" && has_value) {
+            interval = std::atol(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = unsigned(std::atol(argv[++i]));
+        } else if (arg == "--region" && has_value) {
+            region = argv[++i];
+        } else if (arg == "--repeat" && has_value) {
+            repeat = std::atoi(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-' && recording.empty()) {
+            recording = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (soak_test) {
+        if (interval <= 0 || weeks <= 0) {
+            std::cerr << "--weeks and --interval must be positive\n";
+            return 1;
+        }
+        return soak(weeks, interval, region, rss_slack_kib);
+    }
+
+    if (phase_test) {
+        period = period ? period : interval;
+        if (interval <= 0 || days <= 0 || period <= 0 || offset < 0) {
+            std::cerr << "--days, --interval and --period must be positive\n";
+            return 1;
+        }
+        if (interval > period) {
+            std::cerr << "--interval must not exceed --period: there is nothing to align to\n";
+            return 1;
+        }
+        return phase_simulation(days, interval, period, offset % period, seed);
+    }
+
+    if (!synthesize_path.empty()) {
+        if (interval <= 0 || seconds <= 0) {
+            std::cerr << "--seconds and --interval must be positive\n";
+            return 1;
+        }
+        if (!alerts::tools::write_recording(synthesize_path,
+                                            alerts::tools::synthesize_feed(seconds, interval, seed))) {
+            std::cerr << "Failed to write " << synthesize_path << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<alerts::FetchResult> snapshots;
+    if (!alerts::tools::read_recording(recording, snapshots)) {
+        std::cerr << "Failed to open recording: " << recording << "\n";
+        return 1;
+    }
+
+    size_t replayed = 0;
+    size_t bytes = 0;
+    size_t decode_errors = 0;
+    size_t transitions = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < repeat; ++pass) {
+        alerts::Engine engine;
+        auto counter = std::make_shared<CountingNotifier>();
+        engine.add_notifier(counter);
+        if (!region.empty()) {
+            engine.watch(region);
+        }
+        for (const auto& snapshot : snapshots) {
+            if (!engine.feed(snapshot.body.data(), snapshot.body.size(), snapshot.time)) {
+                ++decode_errors;
+            }
+            ++replayed;
+            bytes += snapshot.body.size();
+        }
+        transitions += counter->count;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "snapshots:     " << replayed << "\n"
+              << "transitions:   " << transitions << "\n"
+              << "decode errors: " << decode_errors << "\n"
+              << "elapsed:       " << elapsed << " s\n";
+    if (replayed && elapsed > 0) {
+        std::cout << "per snapshot:  " << elapsed * 1e9 / replayed << " ns\n"
+                  << "throughput:    " << bytes / elapsed / (1 << 20) << " MiB/s\n";
+    }
+    return decode_errors ? 2 : 0;
+}
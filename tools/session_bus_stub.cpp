@@ -0,0 +1,287 @@
+#include "session_bus_stub.h"
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "alerts/dbus_message.h"
+
+namespace alerts {
+namespace tools {
+
+namespace {
+
+/// A client connection: the bytes received so far, and whether it is past authentication.
+struct Connection {
+    std::string input;
+    bool authenticated = false;
+    bool signals = false; // whether it called AddMatch
+    std::string name; // the unique name given by Hello
+};
+
+void send_all(int fd, const std::string& data) {
+    (void)!send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+}
+
+/// Reads a Notify call's arguments (susssasa{sv}i).
+bool read_notify(const char* message, const DBusHeader& header, SessionBusStub::Notification& notification) {
+    DBusReader reader(message, header);
+    std::string icon;
+    std::uint32_t size;
+    if (!reader.get_string(notification.app_name) || !reader.get_uint32(notification.replaces_id) ||
+        !reader.get_string(icon) || !reader.get_string(notification.summary) ||
+        !reader.get_string(notification.body) || !reader.get_array_size(4, size)) {
+        return false;
+    }
+    std::size_t end = reader.position() + size;
+    while (reader.position() < end) {
+        std::string action;
+        if (!reader.get_string(action)) {
+            return false;
+        }
+        notification.actions.push_back(action);
+    }
+    if (!reader.get_array_size(8, size)) {
+        return false;
+    }
+    end = reader.position() + size;
+    while (reader.position() < end) {
+        std::string key;
+        std::string signature;
+        if (!reader.open_struct() || !reader.get_string(key) || !reader.get_signature(signature)) {
+            return false;
+        }
+        std::uint8_t byte = 0;
+        std::uint32_t number = 0;
+        std::string text;
+        if (signature == "y") {
+            if (!reader.get_byte(byte)) {
+                return false;
+            }
+            if (key == "urgency") {
+                notification.urgency = byte;
+            }
+        } else if (signature == "s") {
+            if (!reader.get_string(text)) {
+                return false;
+            }
+        } else if (signature != "u" && signature != "i" && signature != "b") {
+            return false;
+        } else if (!reader.get_uint32(number)) {
+            return false;
+        }
+    }
+    return reader.get_int32(notification.expire_timeout);
+}
+
+} // namespace
+
+SessionBusStub::SessionBusStub()
+    : listen_fd_(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)), stop_fd_(eventfd(0, EFD_CLOEXEC)),
+      wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    char directory[] = "/tmp/alerts-bus-XXXXXX";
+    directory_ = mkdtemp(directory) ? directory : "/tmp";
+    path_ = directory_ + "/bus";
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+    bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    listen(listen_fd_, 128);
+    thread_ = std::thread(&SessionBusStub::run, this);
+}
+
+SessionBusStub::~SessionBusStub() {
+    uint64_t one = 1;
+    (void)!write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+    close(stop_fd_);
+    close(wake_fd_);
+    close(listen_fd_);
+    unlink(path_.c_str());
+    rmdir(directory_.c_str());
+}
+
+std::vector<SessionBusStub::Notification> SessionBusStub::notifications() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return notifications_;
+}
+
+void SessionBusStub::invoke_action(std::uint32_t id, const std::string& key) {
+    DBusHeader header;
+    header.type = DBusType::Signal;
+    header.path = "/org/freedesktop/Notifications";
+    header.interface = "org.freedesktop.Notifications";
+    header.member = "ActionInvoked";
+    header.signature = "us";
+    DBusWriter writer;
+    std::lock_guard<std::mutex> lock(mutex_);
+    header.serial = signal_serial_++;
+    writer.start(header);
+    writer.put_uint32(id);
+    writer.put_string(key);
+    queue_signal(writer.finish());
+}
+
+void SessionBusStub::close_notification(std::uint32_t id, std::uint32_t reason) {
+    DBusHeader header;
+    header.type = DBusType::Signal;
+    header.path = "/org/freedesktop/Notifications";
+    header.interface = "org.freedesktop.Notifications";
+    header.member = "NotificationClosed";
+    header.signature = "uu";
+    DBusWriter writer;
+    std::lock_guard<std::mutex> lock(mutex_);
+    header.serial = signal_serial_++;
+    writer.start(header);
+    writer.put_uint32(id);
+    writer.put_uint32(reason);
+    queue_signal(writer.finish());
+}
+
+void SessionBusStub::queue_signal(const std::string& message) {
+    signals_.push_back(message);
+    uint64_t one = 1;
+    (void)!write(wake_fd_, &one, sizeof(one));
+}
+
+void SessionBusStub::run() {
+    std::map<int, Connection> connections;
+    char buffer[4096];
+    std::uint32_t serial = 1u << 24; // apart from the serials of the signals raised by hand
+    std::uint32_t next_id = 1;
+    std::size_t next_name = 1;
+    DBusWriter writer;
+    DBusHeader call;
+    while (true) {
+        std::vector<pollfd> fds = {{stop_fd_, POLLIN, 0}, {listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        for (auto& entry : connections) {
+            fds.push_back({entry.first, POLLIN, 0});
+        }
+        poll(fds.data(), fds.size(), -1);
+        if (fds[0].revents) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                connections[fd];
+                ++connections_;
+            }
+        }
+        if (fds[2].revents & POLLIN) {
+            uint64_t count;
+            (void)!read(wake_fd_, &count, sizeof(count));
+            std::vector<std::string> signals;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                signals.swap(signals_);
+            }
+            for (const std::string& message : signals) {
+                for (auto& entry : connections) {
+                    if (entry.second.signals) {
+                        send_all(entry.first, message);
+                    }
+                }
+            }
+        }
+        for (std::size_t i = 3; i < fds.size(); ++i) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            int fd = fds[i].fd;
+            Connection& connection = connections[fd];
+            ssize_t size = read(fd, buffer, sizeof(buffer));
+            if (size <= 0) {
+                close(fd);
+                connections.erase(fd);
+                continue;
+            }
+            connection.input.append(buffer, size);
+
+            // Authentication: text lines until BEGIN; the first byte of the connection is a NUL.
+            std::size_t end;
+            while (!connection.authenticated && (end = connection.input.find("\r\n")) != std::string::npos) {
+                std::string line = connection.input.substr(0, end);
+                connection.input.erase(0, end + 2);
+                if (!line.empty() && line[0] == '\0') {
+                    line.erase(0, 1);
+                }
+                if (line.compare(0, 13, "AUTH EXTERNAL") == 0) {
+                    send_all(fd, "OK 0123456789abcdef0123456789abcdef\r\n");
+                } else if (line == "BEGIN") {
+                    connection.authenticated = true;
+                } else {
+                    send_all(fd, "ERROR\r\n");
+                }
+            }
+            if (!connection.authenticated) {
+                continue;
+            }
+
+            std::size_t at = 0;
+            std::size_t length = 0;
+            bool valid;
+            while ((valid = parse_dbus_header(connection.input.data() + at, connection.input.size() - at, call,
+                                              length)) && length > 0) {
+                const char* message = connection.input.data() + at;
+                at += length;
+                ++messages_;
+                if (call.type != DBusType::MethodCall) {
+                    continue;
+                }
+                DBusHeader reply;
+                reply.type = DBusType::MethodReturn;
+                reply.serial = serial++;
+                reply.reply_serial = call.serial;
+                reply.sender = "org.freedesktop.DBus";
+                if (call.member == "Hello") {
+                    connection.name = ":1." + std::to_string(next_name++);
+                    reply.destination = connection.name;
+                    reply.signature = "s";
+                    writer.start(reply);
+                    writer.put_string(connection.name);
+                    send_all(fd, writer.finish());
+                    continue;
+                }
+                reply.destination = connection.name;
+                if (call.member == "AddMatch") {
+                    connection.signals = true;
+                    writer.start(reply);
+                    send_all(fd, writer.finish());
+                    continue;
+                }
+                Notification notification;
+                if (call.member == "Notify" && call.interface == "org.freedesktop.Notifications" &&
+                    read_notify(message, call, notification)) {
+                    notification.id = notification.replaces_id ? notification.replaces_id : next_id++;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        notifications_.push_back(notification);
+                    }
+                    reply.signature = "u";
+                    writer.start(reply);
+                    writer.put_uint32(notification.id);
+                } else {
+                    reply.type = DBusType::Error;
+                    reply.error_name = "org.freedesktop.DBus.Error.UnknownMethod";
+                    writer.start(reply);
+                }
+                send_all(fd, writer.finish());
+            }
+            connection.input.erase(0, at);
+            if (!valid) {
+                close(fd);
+                connections.erase(fd);
+            }
+        }
+    }
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+}
+
+} // namespace tools
+} // namespace alerts
@@ -0,0 +1,81 @@
+#ifndef ALERTS_TOOLS_SESSION_BUS_STUB_H
+#define ALERTS_TOOLS_SESSION_BUS_STUB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace alerts {
+namespace tools {
+
+/**
+ * @brief A stand-in for a D-Bus session bus with a notification daemon on it, for benchmarks of desktop
+ * notifications on machines without a desktop. It listens on a unix socket in a private directory, accepts
+ * the EXTERNAL authentication, answers Hello, and answers Notify as a notification daemon does, remembering
+ * every notification. AddMatch is accepted, and the daemon's signals can be raised by hand, as if the user
+ * clicked or dismissed a notification; they go to the connections that asked for signals. Any other call
+ * gets an UnknownMethod error. It runs on its own thread from construction to destruction.
+ */
+class SessionBusStub {
+public:
+    /// A notification as the daemon received it.
+    struct Notification {
+        std::uint32_t id = 0;           ///< the ID it was given: replaces_id, or a new one
+        std::uint32_t replaces_id = 0;
+        std::string app_name;
+        std::string summary;
+        std::string body;
+        std::uint8_t urgency = 1;
+        std::int32_t expire_timeout = -1;
+        std::vector<std::string> actions; ///< keys and labels
+    };
+
+    SessionBusStub();
+    ~SessionBusStub();
+    SessionBusStub(const SessionBusStub&) = delete;
+    SessionBusStub& operator=(const SessionBusStub&) = delete;
+
+    /// The bus address to connect to, "unix:path=...".
+    std::string address() const { return "unix:path=" + path_; }
+
+    /// The notifications received so far, in order.
+    std::vector<Notification> notifications() const;
+
+    /// Connections accepted so far.
+    std::size_t connections() const { return connections_; }
+
+    /// Messages received on all connections so far.
+    std::size_t messages() const { return messages_; }
+
+    /// Sends ActionInvoked, as when the user clicks an action of a notification.
+    void invoke_action(std::uint32_t id, const std::string& key);
+
+    /// Sends NotificationClosed; reason 2 is a dismissal by the user.
+    void close_notification(std::uint32_t id, std::uint32_t reason);
+
+private:
+    void run();
+    void queue_signal(const std::string& message);
+
+    std::string directory_;
+    std::string path_;
+    int listen_fd_;
+    int stop_fd_;
+    int wake_fd_;
+    std::atomic<std::size_t> connections_{0};
+    std::atomic<std::size_t> messages_{0};
+    mutable std::mutex mutex_;
+    std::vector<Notification> notifications_;
+    std::vector<std::string> signals_; // waiting to be sent by the bus thread
+    std::uint32_t signal_serial_ = 1;
+    std::thread thread_;
+};
+
+} // namespace tools
+} // namespace alerts
+
+#endif // ALERTS_TOOLS_SESSION_BUS_STUB_H
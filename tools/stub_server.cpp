@@ -0,0 +1,157 @@
+#include "stub_server.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace alerts {
+namespace tools {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string response(int status, const std::string& headers, const std::string& body) {
+    const char* reason = status == 200   ? "OK"
+                         : status == 404 ? "Not Found"
+                         : status == 429 ? "Too Many Requests"
+                         : status == 503 ? "Service Unavailable"
+                                         : "Status";
+    return "HTTP/1.1 " + std::to_string(status) + " " + reason +
+           "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n" +
+           headers + "\r\n" + body;
+}
+
+/// A request to answer, and when.
+struct Pending {
+    Clock::time_point due;
+    std::string head;
+};
+
+/// A client connection: the bytes received so far, and its pending requests in order.
+struct Connection {
+    std::string input;
+    std::vector<Pending> pending;
+};
+
+} // namespace
+
+StubServer::StubServer(std::string body, std::chrono::milliseconds delay)
+    : response_(response(200, {}, body)),
+      delay_(delay),
+      listen_fd_(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)),
+      stop_fd_(eventfd(0, EFD_CLOEXEC)) {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), length);
+    listen(listen_fd_, 128);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&StubServer::run, this);
+}
+
+StubServer::~StubServer() {
+    uint64_t one = 1;
+    (void)!write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+    close(stop_fd_);
+    close(listen_fd_);
+}
+
+std::string StubServer::url() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/";
+}
+
+void StubServer::script(int status, const std::string& headers, const std::string& body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    script_.push_back(response(status, headers, body));
+}
+
+void StubServer::set_handler(std::function<std::string(const std::string& head)> handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handler_ = std::move(handler);
+}
+
+void StubServer::run() {
+    std::map<int, Connection> connections;
+    char buffer[4096];
+    while (true) {
+        std::vector<pollfd> fds = {{stop_fd_, POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+        Clock::time_point now = Clock::now();
+        int timeout = -1;
+        for (auto& entry : connections) {
+            fds.push_back({entry.first, POLLIN, 0});
+            for (const Pending& pending : entry.second.pending) {
+                int wait = int(std::chrono::ceil<std::chrono::milliseconds>(pending.due - now).count());
+                timeout = timeout < 0 ? std::max(wait, 0) : std::min(timeout, std::max(wait, 0));
+            }
+        }
+        poll(fds.data(), fds.size(), timeout);
+        if (fds[0].revents) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                connections[fd];
+                ++connections_;
+            }
+        }
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            Connection& connection = connections[fds[i].fd];
+            ssize_t size = read(fds[i].fd, buffer, sizeof(buffer));
+            if (size <= 0) {
+                close(fds[i].fd);
+                connections.erase(fds[i].fd);
+                continue;
+            }
+            connection.input.append(buffer, size);
+            size_t end;
+            while ((end = connection.input.find("\r\n\r\n")) != std::string::npos) {
+                connection.pending.push_back({Clock::now() + delay_, connection.input.substr(0, end)});
+                connection.input.erase(0, end + 4);
+            }
+        }
+        // Answer the requests that are due, in order.
+        now = Clock::now();
+        for (auto& entry : connections) {
+            auto& pending = entry.second.pending;
+            while (!pending.empty() && pending.front().due <= now) {
+                std::string head = std::move(pending.front().head);
+                pending.erase(pending.begin());
+                std::string scripted;
+                std::function<std::string(const std::string&)> handler;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!script_.empty()) {
+                        scripted.swap(script_.front());
+                        script_.pop_front();
+                    }
+                    handler = handler_;
+                }
+                if (scripted.empty() && handler) {
+                    scripted = response(200, {}, handler(head));
+                }
+                const std::string& answer = scripted.empty() ? response_ : scripted;
+                (void)!send(entry.first, answer.data(), answer.size(), MSG_NOSIGNAL);
+                ++requests_;
+            }
+        }
+    }
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+}
+
+} // namespace tools
+} // namespace alerts
@@ -0,0 +1,77 @@
+#ifndef ALERTS_TOOLS_STUB_SERVER_H
+#define ALERTS_TOOLS_STUB_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace alerts {
+namespace tools {
+
+/**
+ * @brief A minimal HTTP/1.1 server on 127.0.0.1 that answers every GET with the same body, for benchmarks
+ * that need a local data source. Connections are kept alive, and responses can be delayed to stand in for
+ * a remote upstream. Other responses can be scripted for the next requests, to check how clients handle
+ * errors and throttling. It runs on its own thread from construction to destruction.
+ */
+class StubServer {
+public:
+    /**
+     * @param body The response body.
+     * @param delay How long to wait before answering each request.
+     */
+    explicit StubServer(std::string body, std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+    ~StubServer();
+    StubServer(const StubServer&) = delete;
+    StubServer& operator=(const StubServer&) = delete;
+
+    /// The URL to fetch, e.g. "http://127.0.0.1:40123/".
+    std::string url() const;
+
+    /// Connections accepted so far.
+    size_t connections() const { return connections_; }
+
+    /// Requests answered so far.
+    size_t requests() const { return requests_; }
+
+    /**
+     * @brief Answers the next request not scripted yet with another response; the body is answered again
+     * once the script is used up. Thread-safe.
+     * @param status The status code, e.g. 429.
+     * @param headers Extra header lines, each ending in "\r\n", e.g. "Retry-After: 2\r\n".
+     * @param body The response body.
+     */
+    void script(int status, const std::string& headers = {}, const std::string& body = {});
+
+    /**
+     * @brief Answers every request that is not scripted with the body the handler returns for it, instead of the
+     * fixed body. The handler is called on the server thread; set it before the first request.
+     * @param handler Takes the request head: the request line and the header lines, without the blank line.
+     */
+    void set_handler(std::function<std::string(const std::string& head)> handler);
+
+private:
+    void run();
+
+    std::string response_;
+    std::function<std::string(const std::string&)> handler_;
+    std::mutex mutex_;
+    std::deque<std::string> script_;
+    std::chrono::milliseconds delay_;
+    int listen_fd_;
+    int stop_fd_;
+    int port_ = 0;
+    std::atomic<size_t> connections_{0};
+    std::atomic<size_t> requests_{0};
+    std::thread thread_;
+};
+
+} // namespace tools
+} // namespace alerts
+
+#endif // ALERTS_TOOLS_STUB_SERVER_H
@@ -0,0 +1,78 @@
+#include "synthetic_feed.h"
+#include <fstream>
+
+namespace alerts {
+namespace tools {
+
+const char* const kRegionNames[] = {
+    "Crimea", "Vinnytsia", "Volyn", "Dnipropetrovsk", "Donetsk", "Zhytomyr",
+    "Zakarpattia", "Zaporizhzhia", "Ivano-Frankivsk", "Kyiv Oblast", "Kirovohrad",
+    "Luhansk", "Lviv", "Mykolaiv", "Odesa", "Poltava", "Rivne", "Sumy", "Ternopil",
+    "Kharkiv", "Kherson", "Khmelnytskyi", "Cherkasy", "Chernivtsi", "Chernihiv",
+    "Kyiv", "Sevastopol",
+};
+const size_t kRegionCount = sizeof(kRegionNames) / sizeof(kRegionNames[0]);
+
+namespace {
+
+const char* const kStatuses[] = { "\"full\"", "\"partial\"", "\"no_data\"", "null" };
+
+} // namespace
+
+SyntheticFeed::SyntheticFeed(long interval, unsigned seed)
+    : interval_(interval), time_(1672531200), // 2023-01-01T00:00:00Z
+      rng_(seed), state_(kRegionCount, 3) {}
+
+void SyntheticFeed::next(FetchResult& snapshot) {
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> pick(0, 3);
+    snapshot.time = time_;
+    time_ += interval_;
+    snapshot.body = "{";
+    for (size_t i = 0; i < kRegionCount; ++i) {
+        if (percent(rng_) < 3) {
+            state_[i] = pick(rng_);
+        }
+        snapshot.body += i ? ",\"" : "\"";
+        snapshot.body += kRegionNames[i];
+        snapshot.body += "\":";
+        snapshot.body += kStatuses[state_[i]];
+    }
+    snapshot.body += "}";
+}
+
+std::vector<FetchResult> synthesize_feed(long seconds, long interval, unsigned seed) {
+    std::vector<FetchResult> snapshots;
+    SyntheticFeed feed(interval, seed);
+    for (long t = 0; t < seconds; t += interval) {
+        snapshots.emplace_back();
+        feed.next(snapshots.back());
+    }
+    return snapshots;
+}
+
+bool write_recording(const std::string& path, const std::vector<FetchResult>& snapshots) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    for (const auto& snapshot : snapshots) {
+        out << snapshot.time << '\t' << snapshot.body << '\n';
+    }
+    return bool(out);
+}
+
+bool read_recording(const std::string& path, std::vector<FetchResult>& snapshots) {
+    ReplayFeedSource source(path);
+    if (!source.good()) {
+        return false;
+    }
+    FetchResult fetched;
+    while (source.fetch(fetched)) {
+        snapshots.push_back(fetched);
+    }
+    return true;
+}
+
+} // namespace tools
+} // namespace alerts
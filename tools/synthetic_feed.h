@@ -0,0 +1,64 @@
+#ifndef ALERTS_TOOLS_SYNTHETIC_FEED_H
+#define ALERTS_TOOLS_SYNTHETIC_FEED_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "alerts/feed_source.h"
+
+namespace alerts {
+namespace tools {
+
+/// Region keys as published by https://sirens.in.ua/api/v1/
+extern const char* const kRegionNames[];
+extern const size_t kRegionCount;
+
+/**
+ * @brief Generates a deterministic synthetic feed one snapshot at a time, for workloads too long to keep in memory.
+ * Every region follows a simple Markov chain: most snapshots keep the previous status,
+ * and alerts are raised and lifted often enough to exercise every transition path.
+ */
+class SyntheticFeed {
+public:
+    /**
+     * @param interval The time between snapshots in seconds.
+     * @param seed The random seed, so that the same arguments always give the same feed.
+     */
+    SyntheticFeed(long interval, unsigned seed);
+
+    /// Produces the next snapshot.
+    void next(FetchResult& snapshot);
+
+private:
+    long interval_;
+    std::int64_t time_;
+    std::mt19937 rng_;
+    std::vector<int> state_;
+};
+
+/**
+ * @brief Generates a deterministic synthetic feed in memory, as SyntheticFeed does.
+ * @param seconds The time span in seconds.
+ * @param interval The time between snapshots in seconds.
+ * @param seed The random seed, so that the same arguments always give the same feed.
+ * @return One response body per snapshot, with its Unix time.
+ */
+std::vector<FetchResult> synthesize_feed(long seconds, long interval, unsigned seed);
+
+/**
+ * @brief Writes snapshots as a recording that ReplayFeedSource can read.
+ * @return true on success.
+ */
+bool write_recording(const std::string& path, const std::vector<FetchResult>& snapshots);
+
+/**
+ * @brief Reads a whole recording into memory.
+ * @return false if the recording could not be opened.
+ */
+bool read_recording(const std::string& path, std::vector<FetchResult>& snapshots);
+
+} // namespace tools
+} // namespace alerts
+
+#endif // ALERTS_TOOLS_SYNTHETIC_FEED_H